@@ -0,0 +1,57 @@
+#ifndef ADC_CALIBRATION_H
+#define ADC_CALIBRATION_H
+
+#include <Arduino.h>
+#include <driver/adc.h>
+
+// ============================================================================
+// BOOT-TIME ADC CALIBRATION TABLES
+// Builds a raw -> mV lookup table for ADC1 once from the esp_adc_cal eFuse
+// characteristics, so the hot path translates averaged codes with a single
+// array read. Tables are cached in NVS and reused on later boots of the same
+// chip, skipping characterization entirely.
+// ============================================================================
+
+#define ADC_CAL_TABLE_SIZE          4096        // One entry per 12-bit code
+#define ADC_CAL_DEFAULT_VREF        1100        // mV, used if eFuse has no Vref
+#define ADC_CAL_ALL_ATTENUATIONS    0           // 1 = one table per attenuation (32KB RAM)
+#define ADC_CAL_NVS_NAMESPACE       "adccal"
+#define ADC_CAL_FORMAT_VERSION      1
+
+class AdcCalibration {
+public:
+    AdcCalibration();
+
+    // Load tables from NVS, or characterize and build them (then cache)
+    bool begin();
+
+    bool isReady() const;
+
+    // Table lookup; codes above 4095 are clamped
+    uint16_t toMilliVolts(uint16_t raw, adc_atten_t atten = ADC_ATTEN_DB_11) const;
+
+    // True if this boot reused the NVS cache
+    bool loadedFromCache() const;
+
+private:
+#if ADC_CAL_ALL_ATTENUATIONS
+    static const uint8_t kTableCount = 4;
+#else
+    static const uint8_t kTableCount = 1;       // ADC_ATTEN_DB_11 only
+#endif
+
+    uint16_t tables[kTableCount][ADC_CAL_TABLE_SIZE];
+    bool ready;
+    bool cached;
+
+    static adc_atten_t tableAtten(uint8_t index);
+    static int8_t tableIndex(adc_atten_t atten);
+
+    void buildTables();
+    bool loadFromNvs();
+    void saveToNvs();
+};
+
+extern AdcCalibration adcCalibration;
+
+#endif // ADC_CALIBRATION_H
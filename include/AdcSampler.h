@@ -0,0 +1,79 @@
+#ifndef ADC_SAMPLER_H
+#define ADC_SAMPLER_H
+
+#include <Arduino.h>
+#include "SampleRing.h"
+#include "IRArrayLayout.h"
+
+// ============================================================================
+// ADC1 CONTINUOUS (DMA) SAMPLING ENGINE
+// The ADC digital controller scans the IR channels and the MQ-2 in the
+// background. A drain task moves every DMA frame into one ring per slot, so
+// readers only average samples that are already in RAM (microseconds instead
+// of the old busy-wait loops).
+// ============================================================================
+
+// Slot layout: 0..N-1 = IR channels of IRActiveLayout, N = MQ2PIN
+#define ADC_NUM_SLOTS               (IRActiveLayout::channels + 1)
+#define ADC_SLOT_MQ2                IRActiveLayout::channels
+
+#define ADC_SAMPLE_FREQ_HZ          20000       // Total conversions/s (all slots)
+#define ADC_RING_CAPACITY           256         // Samples kept per slot (~77ms)
+#define ADC_AVERAGE_WINDOW          32          // ~10ms per slot, nulls 100Hz ripple
+#define ADC_DMA_FRAME_BYTES         256         // Bytes handed over per DMA interrupt
+#define ADC_DRAIN_TASK_STACK        3072
+#define ADC_DRAIN_TASK_PRIORITY     5
+
+// Optional per-sample hook, called from the drain task for every conversion
+typedef void (*AdcSampleSink)(uint8_t slot, uint16_t raw, void* ctx);
+
+class AdcSampler {
+public:
+    AdcSampler();
+
+    // Configure ADC1 continuous mode and start the drain task.
+    // Returns false if the driver refused the configuration; readers then
+    // fall back to blocking analogRead() so the firmware keeps working.
+    bool begin();
+
+    bool isRunning() const;
+
+    // Average of the newest `window` samples of a slot
+    uint16_t averageRaw(uint8_t slot, uint16_t window = ADC_AVERAGE_WINDOW) const;
+    uint16_t averageMilliVolts(uint8_t slot, uint16_t window = ADC_AVERAGE_WINDOW) const;
+
+    // Copy the newest `count` raw samples of a slot (for median/Hampel filters).
+    // Returns how many were copied (fewer right after start-up).
+    uint16_t readWindow(uint8_t slot, uint16_t* out, uint16_t count) const;
+
+    // Convert a (possibly averaged) raw ADC1 code to millivolts (AdcCalibration table)
+    uint16_t rawToMilliVolts(uint16_t raw) const;
+
+    // Route every drained sample to `sink` as well as the rings
+    void setSampleSink(AdcSampleSink sink, void* ctx);
+
+    // GPIO scanned by a slot
+    static int slotPin(uint8_t slot);
+
+    // Frames lost because the drain task fell behind
+    uint32_t getOverflowCount() const;
+
+private:
+    SampleRing<uint16_t, ADC_RING_CAPACITY> rings[ADC_NUM_SLOTS];
+
+    // ADC1 channel number -> slot (0xFF = not scanned)
+    uint8_t channelToSlot[8];
+
+    AdcSampleSink volatile sampleSink;
+    void* volatile sampleSinkCtx;
+
+    volatile bool running;
+    volatile uint32_t overflowCount;
+
+    uint16_t readBlocking(uint8_t slot, uint16_t window) const;
+    static void drainTask(void* arg);
+};
+
+extern AdcSampler adcSampler;
+
+#endif // ADC_SAMPLER_H
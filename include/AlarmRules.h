@@ -0,0 +1,58 @@
+#ifndef ALARM_RULES_H
+#define ALARM_RULES_H
+
+#include <Arduino.h>
+#include "RuleVM.h"
+
+// ============================================================================
+// SITE-SPECIFIC ALARM RULES
+// Optional replacement for the built-in Bahaya/Waspada expressions in
+// requestFireAlarm(). A rule image compiled by tools/rulec.py is kept in
+// LittleFS (ALARM_RULES_PATH) and loaded at boot. It can be swapped at run
+// time without reflashing:
+//   console  "rules begin", "rules add <hex>" (repeat), "rules commit"
+//   Blynk    whole image as a hex string on ALARM_RULES_PIN
+//   file     "make rules fs uploadfs", then "rules reload"
+// An image that fails verification is rejected and the running rules stay.
+// Rules can raise or lower the level, but never below Waspada while a flame
+// is confirmed or the fusion score holds Bahaya: requestFireAlarm() applies
+// that floor after them. Every swap or clear is reported to the change
+// handler (main.cpp sends it to Blynk as an event).
+// Everything runs in the loop() task (console and Blynk handlers included),
+// so a swap never races an evaluation.
+// ============================================================================
+
+#define ALARM_RULES_PATH            "/alarm.rules"
+#define ALARM_RULES_PIN             V7
+#define ALARM_RULES_BENCH_RUNS      10000       // Default "rules bench" iterations
+
+// Called after every swap (image length and checksum) or clear (length 0)
+typedef void (*AlarmRulesChangeFn)(size_t length, uint16_t checksum);
+void setAlarmRulesChangeHandler(AlarmRulesChangeFn handler);
+
+// Load ALARM_RULES_PATH (built-in expressions if missing or invalid)
+void initAlarmRules();
+bool reloadAlarmRules();
+
+// Verify, activate and persist a hex-encoded image
+bool loadAlarmRulesHex(const char* hex);
+
+// Chunked upload for the console line limit
+void beginAlarmRulesUpload();
+bool appendAlarmRulesHex(const char* hex);
+bool commitAlarmRulesUpload();
+
+// Back to the built-in expressions (removes the file)
+void clearAlarmRules();
+bool isAlarmRulesLoaded();
+
+// Run both rules over RULE_NUM_INPUTS values; false when none are loaded
+bool evaluateAlarmRules(const float* inputs, bool& danger, bool& warning);
+
+// Time both rules over the last inputs (microseconds per evaluation)
+void benchAlarmRules(Print& out, uint32_t runs);
+
+// Status and disassembly
+void printAlarmRules(Print& out);
+
+#endif // ALARM_RULES_H
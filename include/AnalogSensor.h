@@ -1,9 +1,26 @@
 #ifndef ANALOG_SENSOR_H
 #define ANALOG_SENSOR_H
 
+#include "SensorFrame.h"
+#include "MedianFilter.h"
+
+#define ANALOG_FILTER_WINDOW 31         // Sampel mentah per bacaan median/Hampel
+
 void initMQ2Sensor();
 float getMQ2PPM();
 bool isFlameDetected();
 int getIRAnalogValue();
 
+// Filter per slot ADC (0-4 = IR, 5 = MQ-2) untuk readAnalogDebounced()
+void setAnalogFilterMode(uint8_t slot, SampleFilterMode mode);
+SampleFilterMode getAnalogFilterMode(uint8_t slot);
+
+// Baca semua kanal sekali dan kembalikan snapshot lengkap
+SensorFrame captureSensorFrame();
+
+// Berapa kali seqlock kehabisan retry dan frame memakai snapshot sebelumnya
+uint32_t getSnapshotReadMisses();
+
+void printSensorFrame(const SensorFrame& frame);
+
 #endif
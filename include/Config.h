@@ -24,6 +24,11 @@ const int IR_PINS[] = {32, 33, 36, 39, 35};
 #define THRESHOLD_SMOKE 51
 #define THRESHOLD_FLAME 1000
 
+// PRE-ALARM (prediksi tren, lihat FireTrend.h)
+#define TREND_SAMPLE_MS 500             // Periode sampel histori tren
+#define TREND_HISTORY_SAMPLES 64        // 64 x 500ms = 32 detik histori
+#define PREALARM_HORIZON_S 60           // Waspada jika ambang diprediksi terlewati dalam 60 detik
+
 // BLYNK WATCHDOG
 #define CONNECT_TIMEOUT_MS 30000UL     // Timeout 30 detik (diperpanjang dari 15s untuk power adaptor)
 #define MAX_FAILURES 1                 // Max 5 kali gagal (diperbanyak dari 2 untuk stabilitas)
@@ -0,0 +1,89 @@
+#ifndef CUSUM_DETECTOR_H
+#define CUSUM_DETECTOR_H
+
+#include <stdint.h>
+
+// ============================================================================
+// TWO-SIDED CUSUM (PAGE-HINKLEY) CHANGE DETECTOR
+// Accumulates how far each sample sits beyond a reference level, minus an
+// allowed drift k:
+//   S+ = max(0, S+ + (x - ref - k))      S- = max(0, S- + (ref - x - k))
+// and flags a shift once S+ or S- exceeds the decision threshold h (signal
+// units x samples). A step of size d > k is flagged after about h / (d - k)
+// samples, so a small shift that persists is caught long before it reaches
+// a fixed margin. The reference follows the signal only very slowly (EMA
+// with referenceAlpha), far slower than the IR baseline, so a slow build-up
+// is not absorbed; the sums are capped at 2h so a flag clears soon after
+// the signal returns. O(1) per sample, no allocation.
+// Has no Arduino dependencies so it can be exercised on the host
+// (test/test_cusum_detector).
+// ============================================================================
+
+class CusumDetector {
+public:
+    explicit CusumDetector(float drift = 0.0f, float threshold = 1.0f, float referenceAlpha = 0.0f)
+        : drift(drift), threshold(threshold), referenceAlpha(referenceAlpha) {
+        reset();
+    }
+
+    // Negative (or NaN) drift becomes 0, a non-positive (or NaN) threshold 1
+    void configure(float newDrift, float newThreshold) {
+        drift = (newDrift >= 0.0f) ? newDrift : 0.0f;
+        threshold = (newThreshold > 0.0f) ? newThreshold : 1.0f;
+    }
+
+    void setReferenceAlpha(float alpha) {
+        referenceAlpha = alpha;
+    }
+
+    // Start over; the next sample becomes the reference
+    void reset() {
+        ref = 0.0f;
+        upperSum = 0.0f;
+        lowerSum = 0.0f;
+        primed = false;
+    }
+
+    // Returns the shift after this sample: +1 up, -1 down, 0 none
+    int8_t push(float x) {
+        if (!primed) {
+            ref = x;
+            primed = true;
+            return 0;
+        }
+
+        float cap = 2.0f * threshold;
+        upperSum += x - ref - drift;
+        lowerSum += ref - x - drift;
+        upperSum = (upperSum < 0.0f) ? 0.0f : (upperSum > cap ? cap : upperSum);
+        lowerSum = (lowerSum < 0.0f) ? 0.0f : (lowerSum > cap ? cap : lowerSum);
+
+        ref += referenceAlpha * (x - ref);
+        return shift();
+    }
+
+    int8_t shift() const {
+        if (upperSum > threshold) return 1;
+        if (lowerSum > threshold) return -1;
+        return 0;
+    }
+
+    // Progress towards an upward / downward flag (1 = at threshold, max 2)
+    float upperLevel() const { return upperSum / threshold; }
+    float lowerLevel() const { return lowerSum / threshold; }
+
+    float reference() const { return ref; }
+    float getDrift() const { return drift; }
+    float getThreshold() const { return threshold; }
+
+private:
+    float drift;
+    float threshold;
+    float referenceAlpha;
+    float ref;
+    float upperSum;
+    float lowerSum;
+    bool primed;
+};
+
+#endif // CUSUM_DETECTOR_H
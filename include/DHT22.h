@@ -1,5 +1,18 @@
 #ifndef DHT22_H
 #define DHT22_H
-void setupDHT();
-float readTemperatureSafe();
+
+// Driver DHT22 non-blocking: transaksi dimulai lewat GPIO + esp_timer,
+// pulsa respon ditangkap periferal RMT lalu didekode di pollDHT().
+// Dijadwalkan oleh SensorScheduler di task sensor (SensorTask.cpp).
+#define DHT22_RMT_CHANNEL           RMT_CHANNEL_4
+#define DHT22_START_LOW_US          1100        // Host menahan low >= 1ms
+#define DHT22_CAPTURE_TIMEOUT_MS    20          // Frame lengkap ~5ms
+#define DHT22_STALE_MS              10000       // Bacaan lebih tua = tidak valid
+
+bool setupDHT();                // false jika RMT/esp_timer gagal: DHT22 nonaktif, suhu -999
+bool isDHTAvailable();
+void startDHTReading();         // Mulai transaksi baru (diabaikan jika masih berjalan)
+bool pollDHT();                 // true jika transaksi selesai (atau tidak ada)
+float readTemperatureSafe();    // Hasil terakhir yang valid, -999 jika basi
+float readHumiditySafe();
 #endif
@@ -0,0 +1,80 @@
+#ifndef DHT22_DECODER_H
+#define DHT22_DECODER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+// ============================================================================
+// DHT22 PULSE DECODER
+// Pure function over captured (level, width) pulses, no hardware access, so
+// it can be fed recorded pulse arrays on the host.
+//
+// Frame after the host releases the line:
+//   [high 20-40us] low 80us, high 80us (response),
+//   40 x (low ~50us, high ~26us = 0 / ~70us = 1), low ~50us, idle
+// ============================================================================
+
+#define DHT22_BIT_COUNT             40
+#define DHT22_BIT_THRESHOLD_US      48          // High longer than this = 1
+#define DHT22_BIT_HIGH_MIN_US       10
+#define DHT22_BIT_HIGH_MAX_US       100
+#define DHT22_BIT_LOW_MIN_US        30
+#define DHT22_BIT_LOW_MAX_US        90
+
+struct DHT22Pulse {
+    uint8_t level;                  // 0 = low, 1 = high
+    uint16_t widthUs;
+};
+
+struct DHT22Reading {
+    float temperature;              // °C
+    float humidity;                 // %RH
+};
+
+enum DHT22DecodeResult {
+    DHT22_DECODE_OK,
+    DHT22_DECODE_TOO_SHORT,         // Fewer than 40 data bits captured
+    DHT22_DECODE_BAD_TIMING,        // A bit pulse is out of spec
+    DHT22_DECODE_BAD_CHECKSUM
+};
+
+// The data bits are the last 40 high pulses that are each preceded by a low
+// pulse, which skips the idle-high lead-in and the 80us response.
+static inline DHT22DecodeResult dht22DecodePulses(const DHT22Pulse* pulses, size_t count,
+                                                  DHT22Reading& reading) {
+    // Walk back from the end, collecting (low, high) pairs
+    uint8_t bytes[5] = {0, 0, 0, 0, 0};
+    int bit = DHT22_BIT_COUNT - 1;
+    size_t i = count;
+
+    while (bit >= 0) {
+        // Find the next high pulse walking backwards
+        while (i > 0 && pulses[i - 1].level != 1) i--;
+        if (i < 2) return DHT22_DECODE_TOO_SHORT;
+
+        const DHT22Pulse& high = pulses[i - 1];
+        const DHT22Pulse& low = pulses[i - 2];
+        if (low.level != 0) return DHT22_DECODE_BAD_TIMING;
+
+        if (high.widthUs < DHT22_BIT_HIGH_MIN_US || high.widthUs > DHT22_BIT_HIGH_MAX_US ||
+            low.widthUs < DHT22_BIT_LOW_MIN_US || low.widthUs > DHT22_BIT_LOW_MAX_US) {
+            return DHT22_DECODE_BAD_TIMING;
+        }
+
+        if (high.widthUs > DHT22_BIT_THRESHOLD_US) {
+            bytes[bit / 8] |= (uint8_t)(0x80 >> (bit % 8));
+        }
+        bit--;
+        i -= 2;
+    }
+
+    uint8_t sum = (uint8_t)(bytes[0] + bytes[1] + bytes[2] + bytes[3]);
+    if (sum != bytes[4]) return DHT22_DECODE_BAD_CHECKSUM;
+
+    reading.humidity = ((bytes[0] << 8) | bytes[1]) * 0.1f;
+    float temperature = (((bytes[2] & 0x7F) << 8) | bytes[3]) * 0.1f;
+    reading.temperature = (bytes[2] & 0x80) ? -temperature : temperature;
+    return DHT22_DECODE_OK;
+}
+
+#endif // DHT22_DECODER_H
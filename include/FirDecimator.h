@@ -0,0 +1,49 @@
+#ifndef FIR_DECIMATOR_H
+#define FIR_DECIMATOR_H
+
+#include <stdint.h>
+
+// ============================================================================
+// DECIMATING FIR LOW-PASS
+// One output per `decimation` inputs, computed as a single dot product over a
+// newest-first delay line that is stored twice, so the window is always
+// contiguous. On ESP32 the dot product is esp-dsp's dsps_dotprod_f32 (the
+// kernel behind the dsps_fir* routines, ae32 assembly). Elsewhere a portable
+// loop with the same single accumulator and fused multiply-add runs instead,
+// so host and target produce the same samples.
+// ============================================================================
+
+#define FIR_MAX_TAPS                48
+
+// Dot product used by the filter (esp-dsp on target, portable on host)
+float firDotProduct(const float* a, const float* b, uint16_t length);
+
+// Windowed-sinc (Hamming) low-pass, DC gain 1. cutoff = fc / sample rate.
+void firDesignLowPass(float* coeffs, uint16_t taps, float cutoff);
+
+class FirDecimator {
+public:
+    FirDecimator();
+
+    // `coeffs` must stay valid (filters of equal design can share one table)
+    bool init(const float* coeffs, uint16_t taps, uint8_t decimation);
+
+    // Fill the delay line with `value` to skip the start-up transient
+    void reset(float value = 0.0f);
+
+    // Feed one input; returns true and writes `output` every `decimation` inputs
+    bool push(float input, float& output);
+
+    // Group delay in input samples (linear-phase design)
+    uint16_t delaySamples() const { return taps ? (taps - 1) / 2 : 0; }
+
+private:
+    const float* coeffs;
+    float delay[2 * FIR_MAX_TAPS];
+    uint16_t taps;
+    uint16_t pos;
+    uint8_t decimation;
+    uint8_t phase;
+};
+
+#endif // FIR_DECIMATOR_H
@@ -0,0 +1,44 @@
+#ifndef FIRE_ALARM_H
+#define FIRE_ALARM_H
+
+#include <Arduino.h>
+#include "SensorFrame.h"
+#include "FireFusion.h"
+#include "AlarmStateMachine.h"
+
+// ============================================================================
+// FIRE ALARM
+// Builds the requested level from a frame and drives the shared FireAlarm
+// state machine (AlarmStateMachine.h) with it; transitions and acknowledges
+// are logged here so the state machine itself stays Arduino-free.
+// ============================================================================
+
+#define ALARM_SMOKE_HYST_PPM        5.0f        // Smoke clears this far below its threshold
+#define ALARM_TEMP_HYST_C           1.0f        // Temperature clears this far below THRESHOLD_TEMP
+#define ALARM_WASPADA_EXIT_SCORE    20.0f       // Fusion score that clears Waspada (enter 30)
+#define ALARM_BAHAYA_EXIT_SCORE     45.0f       // Fusion score that clears Bahaya (enter 60)
+
+// What the sensors ask for this tick, and why (for the event text)
+struct AlarmRequest {
+    FireLevel level;
+    bool smokeHigh;
+    bool tempHigh;
+    bool preAlarm;
+};
+
+extern FireAlarm fireAlarm;
+
+// fireAlarm.update() / acknowledge() with the [ALARM] log line
+bool updateFireAlarm(FireLevel requested, unsigned long now);
+void acknowledgeFireAlarm();
+
+// Requested level from a frame: the loaded site rules (AlarmRules.h), else
+// the fusion score (FUSION_DECISION) or the legacy rule, every threshold
+// with hysteresis, plus the trend pre-alarm. A confirmed flame or a Bahaya
+// score keeps the request at Waspada or above whatever the rules say.
+AlarmRequest requestFireAlarm(const SensorFrame& frame, bool preAlarm);
+
+// State, latch, time in state and transition counters
+void printFireAlarm(Print& out);
+
+#endif // FIRE_ALARM_H
@@ -0,0 +1,27 @@
+#ifndef FIRE_FUSION_H
+#define FIRE_FUSION_H
+
+#include <Arduino.h>
+#include "SensorFrame.h"
+#include "FusionScore.h"
+
+// ============================================================================
+// FIRE FUSION
+// Feeds the shared FireFusion (FusionScore.h) from each SensorFrame, logs
+// level changes and closed time-to-alarm episodes, and optionally prints an
+// [FTRACE] line per update for tools/fusionreplay.cpp.
+// ============================================================================
+
+#define FUSION_DECISION             1           // 1 = score drives the alarm, 0 = legacy rule
+#define FUSION_TRACE                0           // 1 = CSV line per update for replaying traces
+
+extern FireFusion fireFusion;
+
+// Build the input from a frame and the FireTrend slopes, update fireFusion
+// and record time-to-alarm against `legacy` (the old boolean rule)
+FireLevel evaluateFireFusion(const SensorFrame& frame, FireLevel legacy);
+
+// Score, evidence, weights and the last episode's time-to-alarm
+void printFireFusion(Print& out);
+
+#endif // FIRE_FUSION_H
@@ -0,0 +1,50 @@
+#ifndef FIRE_TREND_H
+#define FIRE_TREND_H
+
+#include <Arduino.h>
+#include "SensorFrame.h"
+#include "TrendHistory.h"
+
+// ============================================================================
+// RATE-OF-RISE PRE-ALARM
+// Smoke PPM is sampled every TREND_SAMPLE_MS and temperature once per new
+// DHT22 reading (repeating a held value would shrink the slope's standard
+// error) into TrendHistory rings. The fitted slope predicts when each
+// quantity reaches its threshold (THRESHOLD_TEMP, the adaptive smoke
+// threshold); a crossing still ahead and predicted within the horizon raises
+// a pre-alarm, so a fast-growing fire is flagged before the instantaneous
+// value gets there. A value already past its threshold is left to the
+// threshold alarms. IR is not trended: raw IR sits above THRESHOLD_FLAME in
+// sunlight, and the flame detector already tracks it against a baseline.
+// ============================================================================
+
+enum TrendQuantity {
+    TREND_TEMPERATURE,
+    TREND_SMOKE,
+    TREND_NUM_QUANTITIES
+};
+
+// Call with every frame; samples only once per TREND_SAMPLE_MS
+void updateFireTrend(const SensorFrame& frame);
+
+// Some quantity is predicted to cross its threshold within the horizon
+// (not one that is already past it)
+bool isPreAlarm();
+
+// Bit q set = quantity q raised the pre-alarm
+uint8_t getPreAlarmMask();
+
+// Shortest predicted time to threshold among the pre-alarming quantities (s)
+float getPreAlarmEta();
+
+// Fitted slope (units/s) and predicted time to threshold (s, < 0 = none)
+float getTrendSlope(TrendQuantity quantity);
+float getTimeToThreshold(TrendQuantity quantity);
+
+// Prediction horizon in seconds (default PREALARM_HORIZON_S)
+void setPreAlarmHorizon(float seconds);
+float getPreAlarmHorizon();
+
+void printFireTrend(Print& out);
+
+#endif // FIRE_TREND_H
@@ -0,0 +1,40 @@
+#ifndef FLAME_CLASSIFIER_H
+#define FLAME_CLASSIFIER_H
+
+#include <Arduino.h>
+#include "FlameModel.h"
+
+struct FlameSnapshot;
+struct EnvSnapshot;
+
+// ============================================================================
+// ON-DEVICE FLAME / NUISANCE CLASSIFIER
+// Runs FlameModel once per IR update in the sensing task, right after
+// IRFlameSensor::updateNow(), and stores the class, the probabilities and
+// the features in the FlameSnapshot. It does not change the detector: its
+// output reaches the alarm only as the rule inputs model_flame and
+// model_nuisance, and through FUSION_MODEL_VETO when that is enabled.
+//
+// Recording training data: "model trace on" makes loop() print one [MLTRACE]
+// line per update from the snapshot's features (no printing in the sensing
+// task); feed the logs to tools/train_flame_model.py.
+// ============================================================================
+
+#define FLAME_MODEL_PERSISTENCE_UPDATES PEAK_WINDOW_UPDATES  // Spike history judged for persistence
+
+// Normalized feature vector of one update (see FlameFeature)
+void extractFlameFeatures(const FlameSnapshot& flame, const EnvSnapshot& env, float* features);
+
+// Fill the model fields of the snapshot (called by the sensing task)
+void classifyFlameSnapshot(FlameSnapshot& flame, const EnvSnapshot& env);
+
+void setFlameModelTrace(bool enabled);
+bool isFlameModelTrace();
+
+// [MLTRACE] line for a snapshot not printed yet (called by loop())
+void printFlameModelTrace();
+
+// Class, probabilities, features and inference time of the last update
+void printFlameModel(Print& out);
+
+#endif // FLAME_CLASSIFIER_H
@@ -0,0 +1,101 @@
+#ifndef FLAME_MODEL_H
+#define FLAME_MODEL_H
+
+#include <stdint.h>
+#include <math.h>
+#include "FlameModelWeights.h"
+
+// ============================================================================
+// INT8 FLAME / NUISANCE CLASSIFIER
+// A 12-16-3 MLP over features the IR pipeline already computes. Features
+// are normalized to roughly -4..+4 and quantized to int8 (x 2^INPUT_SHIFT);
+// the hidden layer accumulates int8 x int8 into int32, is rescaled to int8
+// with a fixed-point multiplier and ReLU-clamped; the output layer gives
+// three int32 logits that are scaled to float for a softmax. About 250
+// multiply-adds per update, no allocation, no float until the last step.
+//
+// The weights are generated by tools/train_flame_model.py from recorded
+// [MLTRACE] logs; the tool runs the same integer arithmetic as infer(), so
+// the accuracy it reports is the device's; the golden vectors it writes
+// next to the weights pin that down (test/test_flame_model).
+// Has no Arduino dependencies so it can be exercised on the host.
+// ============================================================================
+
+// Keep in order: the trainer and the [MLTRACE] lines use the same columns
+enum FlameFeature {
+    FEATURE_DEV_BEST,           // Highest deviation / its spike margin
+    FEATURE_DEV_SECOND,         // Second highest deviation / its margin
+    FEATURE_DEV_MEAN,           // Mean deviation / mean margin
+    FEATURE_SPIKE_FRACTION,     // Spiking channels / channels
+    FEATURE_POINT,              // 1 = spike mask is a point source
+    FEATURE_WIDE,               // 1 = spike mask is ambient or scattered
+    FEATURE_PERSISTENCE,        // Spike duty of the best channel, last 20 updates
+    FEATURE_FLICKER_RATIO,      // Flicker-band share of the best channel
+    FEATURE_FLICKER_LEVEL,      // Flicker RMS of the best channel / FLICKER_MIN_RMS_MV
+    FEATURE_SWING,              // Peak - trough of the best channel / its margin
+    FEATURE_SMOKE,              // PPM / THRESHOLD_SMOKE
+    FEATURE_TEMP,               // (C - FUSION_TEMP_AMBIENT) / (THRESHOLD_TEMP - FUSION_TEMP_AMBIENT)
+    FLAME_NUM_FEATURES
+};
+
+enum FlameClass {
+    FLAME_CLASS_QUIET,
+    FLAME_CLASS_FLAME,
+    FLAME_CLASS_NUISANCE,       // Sunlight, curtains, halogen lamps
+    FLAME_NUM_CLASSES
+};
+
+static_assert(FLAME_MODEL_INPUTS == FLAME_NUM_FEATURES, "FlameModelWeights.h out of step with FlameFeature");
+static_assert(FLAME_MODEL_CLASSES == FLAME_NUM_CLASSES, "FlameModelWeights.h out of step with FlameClass");
+
+static inline const char* flameClassName(uint8_t cls) {
+    static const char* const names[] = {"quiet", "flame", "nuisance"};
+    static_assert(sizeof(names) / sizeof(names[0]) == FLAME_NUM_CLASSES, "flameClassName out of step with FlameClass");
+    return (cls < FLAME_NUM_CLASSES) ? names[cls] : "?";
+}
+
+class FlameModel {
+public:
+    static int8_t quantize(float feature) {
+        float scaled = feature * (1 << FLAME_MODEL_INPUT_SHIFT);
+        if (!(scaled > -128.0f)) return -128;           // Also NaN
+        if (scaled > 127.0f) return 127;
+        return (int8_t)lroundf(scaled);
+    }
+
+    // Classify one feature vector; probabilities (optional) get 0..1 per class
+    static FlameClass infer(const float* features, float* probabilities) {
+        int8_t x[FLAME_MODEL_INPUTS];
+        for (int i = 0; i < FLAME_MODEL_INPUTS; i++) x[i] = quantize(features[i]);
+
+        int8_t hidden[FLAME_MODEL_HIDDEN];
+        for (int j = 0; j < FLAME_MODEL_HIDDEN; j++) {
+            int32_t acc = flameModelB1[j];
+            for (int i = 0; i < FLAME_MODEL_INPUTS; i++) acc += flameModelW1[j][i] * x[i];
+            int32_t h = (int32_t)(((int64_t)acc * flameModelMultiplier1 + (1LL << (flameModelShift1 - 1)))
+                                  >> flameModelShift1);
+            hidden[j] = (int8_t)(h < 0 ? 0 : (h > 127 ? 127 : h));
+        }
+
+        float logits[FLAME_MODEL_CLASSES];
+        int best = 0;
+        for (int k = 0; k < FLAME_MODEL_CLASSES; k++) {
+            int32_t acc = flameModelB2[k];
+            for (int j = 0; j < FLAME_MODEL_HIDDEN; j++) acc += flameModelW2[k][j] * hidden[j];
+            logits[k] = acc * flameModelOutputScale;
+            if (logits[k] > logits[best]) best = k;
+        }
+
+        if (probabilities) {
+            float sum = 0.0f;
+            for (int k = 0; k < FLAME_MODEL_CLASSES; k++) {
+                probabilities[k] = expf(logits[k] - logits[best]);
+                sum += probabilities[k];
+            }
+            for (int k = 0; k < FLAME_MODEL_CLASSES; k++) probabilities[k] /= sum;
+        }
+        return (FlameClass)best;
+    }
+};
+
+#endif // FLAME_MODEL_H
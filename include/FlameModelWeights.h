@@ -0,0 +1,75 @@
+#ifndef FLAME_MODEL_WEIGHTS_H
+#define FLAME_MODEL_WEIGHTS_H
+
+#include <stdint.h>
+
+// ============================================================================
+// GENERATED by tools/train_flame_model.py - do not edit, retrain instead
+// Source: synthetic 800 per class, seed 1
+// 1920 training / 480 validation vectors, 12-16-3 MLP, 25 epochs
+// Validation accuracy: float 99.6%, int8 99.6%
+// int8 confusion (rows true quiet/flame/nuisance):
+//   quiet      162     0     0
+//   flame        0   172     0
+//   nuisance     0     2   144
+// ============================================================================
+
+#define FLAME_MODEL_INPUTS          12
+#define FLAME_MODEL_HIDDEN          16
+#define FLAME_MODEL_CLASSES         3
+#define FLAME_MODEL_INPUT_SHIFT     5           // Feature x 2^shift -> int8
+#define FLAME_MODEL_FROM_TRACES     0           // 0 = synthetic data only, advisory
+
+constexpr int8_t flameModelW1[FLAME_MODEL_HIDDEN][FLAME_MODEL_INPUTS] = {
+    {-10, 4, -29, -44, -45, 18, -24, 9, 1, -17, 8, -10},
+    {41, -27, -22, -51, -57, -90, -10, 51, 40, 15, 9, 33},
+    {28, -18, -61, 8, 44, 126, 43, -82, -33, -68, 15, -14},
+    {-24, 2, 57, 31, 13, 47, -15, -55, -11, 11, -9, -5},
+    {-12, -9, 21, 26, 22, 61, 19, -59, -26, -3, -14, -14},
+    {-10, -21, 9, 3, -24, -6, -24, -18, 12, -6, -17, 12},
+    {-19, -6, 1, -3, -22, 17, -27, 7, -21, 2, -1, -9},
+    {-4, -25, 31, 15, 28, 11, 18, -69, -30, -4, -3, -11},
+    {18, 2, -65, -84, -26, -96, -17, 124, 28, 24, 61, -47},
+    {12, -8, -54, -61, -37, -89, -11, 51, 38, 32, 61, 13},
+    {-6, -1, -31, -48, -35, 8, -28, 17, -3, -1, -2, 1},
+    {-8, -24, 6, 13, 2, 48, 34, -28, -7, -12, 9, -10},
+    {-13, 17, 1, -1, -17, 5, -21, -18, 4, -11, -4, 7},
+    {-44, 12, 78, 57, 15, 49, -31, -30, -7, 18, -10, -7},
+    {-29, -1, 41, 53, 32, 83, 14, -56, -29, 2, -9, -12},
+    {24, -4, -33, -72, -32, -127, -35, 89, 47, 11, 32, 21},
+};
+constexpr int32_t flameModelB1[FLAME_MODEL_HIDDEN] = {2154, -1361, 1547, 122, 74, -185, 1124, -483, 349, -997, 1956, -487, -64, -139, 762, -360};
+constexpr int32_t flameModelMultiplier1 = 1608647539;
+constexpr int flameModelShift1 = 37;
+
+constexpr int8_t flameModelW2[FLAME_MODEL_CLASSES][FLAME_MODEL_HIDDEN] = {
+    {116, -36, -83, -27, -45, 2, 34, -31, -29, 19, 127, -37, 1, -62, -85, -55},
+    {-41, 11, -65, -21, -11, -4, -17, -11, 11, 12, -99, 0, 2, -33, -5, 7},
+    {-28, -3, 60, 16, 14, 3, -14, 19, -19, -7, -64, 5, -4, 37, 3, 0},
+};
+constexpr int32_t flameModelB2[FLAME_MODEL_CLASSES] = {-963, 41, -120};
+constexpr float flameModelOutputScale = 0.00481232693f;
+
+// Golden vectors (features on the int8 grid) with the class and
+// probabilities the trainer computes for them; see test/test_flame_model
+#define FLAME_MODEL_GOLDEN          6
+
+constexpr float flameModelGoldenFeatures[FLAME_MODEL_GOLDEN][FLAME_MODEL_INPUTS] = {
+    {0.5625f, 0.125f, 0.21875f, 0.0f, 0.0f, 0.0f, 0.0625f, 0.09375f, 0.40625f, 0.0f, 0.25f, -0.75f},
+    {0.59375f, 0.21875f, 0.1875f, 0.0f, 0.0f, 0.0f, 0.0625f, 0.46875f, 0.3125f, 0.53125f, 0.75f, -0.28125f},
+    {2.40625f, 1.78125f, 0.90625f, 0.59375f, 0.0f, 0.0f, 0.4375f, 0.59375f, 0.53125f, 0.6875f, 0.0f, 0.78125f},
+    {0.71875f, 0.59375f, 0.28125f, 0.40625f, 1.0f, 0.0f, 0.46875f, 0.71875f, 0.78125f, 0.625f, 0.15625f, 2.5f},
+    {1.6875f, 1.40625f, 0.9375f, 0.40625f, 1.0f, 0.0f, 0.40625f, 0.5625f, 0.90625f, 3.0625f, 0.59375f, -0.40625f},
+    {1.09375f, 0.6875f, 0.84375f, 0.40625f, 1.0f, 0.0f, 0.71875f, 0.5625f, 1.0625f, 0.875f, 0.40625f, 0.4375f},
+};
+constexpr uint8_t flameModelGoldenClass[FLAME_MODEL_GOLDEN] = {0, 0, 1, 1, 1, 2};
+constexpr float flameModelGoldenProbabilities[FLAME_MODEL_GOLDEN][FLAME_MODEL_CLASSES] = {
+    {0.999999757f, 1.46423507e-11f, 2.42803108e-07f},
+    {0.999999905f, 9.45411254e-08f, 7.44765802e-11f},
+    {3.03341314e-07f, 0.954199234f, 0.0458004629f},
+    {2.52960427e-08f, 0.971724027f, 0.0282759479f},
+    {1.44303587e-12f, 0.533635413f, 0.466364587f},
+    {2.05466732e-07f, 0.389944208f, 0.610055586f},
+};
+
+#endif // FLAME_MODEL_WEIGHTS_H
@@ -0,0 +1,145 @@
+#ifndef FLICKER_BANK_H
+#define FLICKER_BANK_H
+
+#include <stdint.h>
+#include <math.h>
+
+// ============================================================================
+// FLAME FLICKER GOERTZEL BANK
+// One bank per IR channel, fed at FLICKER_SAMPLE_RATE_HZ. Every block of
+// FLICKER_BLOCK_SAMPLES it evaluates the Goertzel bins covering the flame
+// flicker band and reports:
+//   bandRms - RMS of the in-band component in mV (a sinusoid of amplitude A
+//             in one bin reads A/sqrt(2))
+//   ratio   - fraction of the block's AC energy inside the band (Parseval);
+//             white noise sits near bins/(N/2), a flickering flame near 1
+// A steady heat lamp raises the level but not the band energy.
+//
+// Cost: 1 multiply + 2 adds per bin per sample, plus one sqrt per block.
+// With N = 25 the bins sit at 4, 8, 12, 16 and 20 Hz; resolving 1 Hz would
+// need a 1 s block, which is longer than the temporal verification window.
+// Synthetic checks (60 s at 100 Hz): a noise-free in-bin sinusoid reads
+// exactly A/sqrt(2); off-bin 6-12 Hz flicker under 5 mV noise keeps ratio > 0.8.
+// White noise alone swings ratio between 0.1 and 0.8 on 25-sample blocks but
+// its bandRms stays near sigma, so a detector must test both features.
+// Host cost (tools/flickerbench.cpp): ~5 ns per sample per channel, against
+// ~36 ns for a direct DFT of the same bins once per block.
+//
+// classifyFlickerBlock() and flickerConfirmMs() hold the detector's decision rule.
+// Has no Arduino dependencies so it can be exercised on the host
+// (test/test_flicker_bank).
+// ============================================================================
+
+#define FLICKER_SAMPLE_RATE_HZ      100
+#define FLICKER_BLOCK_SAMPLES       25          // 250ms block, 4Hz bin spacing
+#define FLICKER_FIRST_BIN           1           // 4 Hz
+#define FLICKER_LAST_BIN            5           // 20 Hz
+#define FLICKER_NUM_BINS            (FLICKER_LAST_BIN - FLICKER_FIRST_BIN + 1)
+
+struct FlickerResult {
+    float bandRms;                  // mV
+    float ratio;                    // 0..1
+};
+
+// Verdict of the last block that was a spike from start to end
+enum FlickerVerdict {
+    FLICKER_UNKNOWN,
+    FLICKER_STEADY,
+    FLICKER_PRESENT
+};
+
+static inline FlickerVerdict classifyFlickerBlock(const FlickerResult& result, float minRms, float minRatio) {
+    bool flickering = result.bandRms >= minRms && result.ratio >= minRatio;
+    return flickering ? FLICKER_PRESENT : FLICKER_STEADY;
+}
+
+// Persistence a potential flame needs before it is confirmed, given the
+// verdicts of its spiking channels: flicker confirms at once, a steady
+// verdict only delays confirmation to steadyMs (a weak or distant flame can
+// flicker below the RMS threshold), no verdict keeps the plain rule
+static inline uint32_t flickerConfirmMs(bool flickering, bool steady, uint32_t plainMs, uint32_t steadyMs) {
+    if (flickering) return 0;
+    return steady ? steadyMs : plainMs;
+}
+
+class GoertzelBank {
+public:
+    GoertzelBank() {
+        for (uint8_t b = 0; b < FLICKER_NUM_BINS; b++) {
+            float omega = 2.0f * (float)M_PI * (FLICKER_FIRST_BIN + b) / FLICKER_BLOCK_SAMPLES;
+            coeff[b] = 2.0f * cosf(omega);
+        }
+        last.bandRms = 0.0f;
+        last.ratio = 0.0f;
+        blocks = 0;
+        reset();
+    }
+
+    // Discard the block in progress
+    void reset() {
+        for (uint8_t b = 0; b < FLICKER_NUM_BINS; b++) {
+            s1[b] = 0.0f;
+            s2[b] = 0.0f;
+        }
+        count = 0;
+        sum = 0.0f;
+        sumSq = 0.0f;
+    }
+
+    // Feed one sample; returns true when it completed a block
+    bool push(float milliVolts) {
+        // Work relative to the block's first sample to keep float precision
+        if (count == 0) offset = milliVolts;
+        float x = milliVolts - offset;
+
+        for (uint8_t b = 0; b < FLICKER_NUM_BINS; b++) {
+            float s0 = x + coeff[b] * s1[b] - s2[b];
+            s2[b] = s1[b];
+            s1[b] = s0;
+        }
+        sum += x;
+        sumSq += x * x;
+
+        if (++count < FLICKER_BLOCK_SAMPLES) return false;
+        finishBlock();
+        return true;
+    }
+
+    const FlickerResult& result() const { return last; }
+
+    // Completed blocks since construction (wraps)
+    uint32_t blockCount() const { return blocks; }
+
+private:
+    float coeff[FLICKER_NUM_BINS];
+    float s1[FLICKER_NUM_BINS];
+    float s2[FLICKER_NUM_BINS];
+    float offset;
+    float sum;
+    float sumSq;
+    uint16_t count;
+    uint32_t blocks;
+    FlickerResult last;
+
+    void finishBlock() {
+        const float n = (float)FLICKER_BLOCK_SAMPLES;
+
+        // |X_k|^2 per bin; one-sided, so double it for the mirrored bin
+        float bandPower = 0.0f;
+        for (uint8_t b = 0; b < FLICKER_NUM_BINS; b++) {
+            bandPower += s1[b] * s1[b] + s2[b] * s2[b] - coeff[b] * s1[b] * s2[b];
+        }
+        bandPower *= 2.0f;
+
+        // Parseval: sum over all non-DC bins of |X_k|^2 = N * sum (x - mean)^2
+        float acEnergy = n * (sumSq - sum * sum / n);
+
+        last.bandRms = sqrtf(bandPower) / n;
+        last.ratio = (acEnergy > 0.0f) ? bandPower / acEnergy : 0.0f;
+        if (last.ratio > 1.0f) last.ratio = 1.0f;
+        blocks++;
+        reset();
+    }
+};
+
+#endif // FLICKER_BANK_H
@@ -0,0 +1,155 @@
+#ifndef FUSION_SCORE_H
+#define FUSION_SCORE_H
+
+#include <stdint.h>
+#include "Config.h"
+#include "IRFlameSensor.h"
+#include "AlarmStateMachine.h"
+
+// ============================================================================
+// WEIGHTED MULTI-SENSOR FUSION
+// Each sensor contributes normalized evidence:
+//   flame       1 for FLAME_DETECTED, 0.5 x confidence for FLAME_POTENTIAL
+//   smoke/temp  level from background / room (0) to its threshold (1), capped
+//               at FUSION_LEVEL_CAP
+//   slopes      rate of rise relative to FUSION_*_SLOPE_FULL (0..1)
+//   shifts      CUSUM progress of IR (highest channel) and MQ-2 (0..1)
+// With FUSION_MODEL_VETO the flame evidence is dropped while the int8
+// classifier (FlameModel.h) is sure the IR comes from a nuisance source;
+// off by default until the model is retrained on site traces.
+// The weighted sum (0-100 points) drives a decaying score: it follows rising
+// evidence with FUSION_ATTACK_S and falls back with FUSION_RELEASE_S, so a
+// single noisy reading barely moves it while sustained evidence (a
+// smouldering fire with climbing smoke) keeps accumulating into Bahaya.
+// FusionEpisodeTracker times the first Waspada/Bahaya of the score against
+// the legacy boolean rule. Logging and the frame plumbing live in
+// FireFusion.h; tools/fusionreplay.cpp runs recorded [FTRACE] logs through
+// the same code.
+// Has no Arduino dependencies so it can be exercised on the host
+// (test/test_fire_fusion).
+// ============================================================================
+
+#define FUSION_WEIGHT_FLAME         80.0f       // Points for a confirmed flame
+#define FUSION_WEIGHT_SMOKE         35.0f       // ... for smoke at its threshold
+#define FUSION_WEIGHT_SMOKE_SLOPE   15.0f       // ... for smoke rising FUSION_SMOKE_SLOPE_FULL
+#define FUSION_WEIGHT_TEMP          35.0f       // ... for temperature at THRESHOLD_TEMP
+#define FUSION_WEIGHT_TEMP_SLOPE    15.0f       // ... for temperature rising FUSION_TEMP_SLOPE_FULL
+#define FUSION_WEIGHT_IR_SHIFT      20.0f       // ... for a sustained IR rise (CUSUM)
+#define FUSION_WEIGHT_SMOKE_SHIFT   30.0f       // ... for a sustained smoke rise (CUSUM)
+#define FUSION_LEVEL_CAP            2.0f        // Level evidence saturates at 2x threshold
+#define FUSION_TEMP_AMBIENT         30.0f       // Temperature with zero evidence (C, warm room)
+#define FUSION_SMOKE_SLOPE_FULL     2.0f        // PPM/s for full slope evidence
+#define FUSION_TEMP_SLOPE_FULL      0.1f        // C/s for full slope evidence
+#define FUSION_ATTACK_S             0.5f        // Time constant while evidence rises
+#define FUSION_RELEASE_S            10.0f       // Time constant while evidence falls
+#define FUSION_WASPADA_SCORE        30.0f       // Score for Waspada
+#define FUSION_BAHAYA_SCORE         60.0f       // Score for Bahaya
+#define FUSION_EPISODE_GAP_MS       30000       // Quiet time that closes a comparison episode
+#define FUSION_MODEL_VETO           0           // 1 = drop flame evidence the classifier calls a nuisance
+#define FUSION_MODEL_VETO_PERCENT   80          // Nuisance probability for the veto
+
+enum FusionEvidence {
+    FUSION_FLAME,
+    FUSION_SMOKE_LEVEL,
+    FUSION_SMOKE_SLOPE,
+    FUSION_TEMP_LEVEL,
+    FUSION_TEMP_SLOPE,
+    FUSION_IR_SHIFT,
+    FUSION_SMOKE_SHIFT,
+    FUSION_NUM_EVIDENCE
+};
+
+struct FusionInput {
+    FlameDetectionState flameState;
+    uint8_t flameConfidence;        // 0-100
+    float smokePPM;
+    float smokeBackground;          // Learned background = zero evidence (PPM)
+    float smokeThreshold;           // Adaptive threshold = full evidence (PPM)
+    float smokeSlope;               // PPM/s
+    float temperature;              // C, -999 when the DHT22 failed
+    float temperatureSlope;         // C/s
+    float irShiftLevel;             // CUSUM progress, >= 1 = shift flagged
+    float smokeShiftLevel;
+    uint8_t modelNuisance;          // Classifier nuisance probability 0-100
+};
+
+class FireFusion {
+public:
+    FireFusion();
+
+    // Fold one set of readings taken `dtSeconds` after the previous one
+    FireLevel update(const FusionInput& input, float dtSeconds);
+
+    float getScore() const;                     // Decaying score 0-100
+    float getInstantScore() const;              // Weighted evidence of the last update
+    float getEvidence(FusionEvidence which) const;
+    FireLevel getLevel() const;
+
+    void setWeight(FusionEvidence which, float points);
+    float getWeight(FusionEvidence which) const;
+
+    void reset();
+
+    static const char* levelName(FireLevel level);
+    static const char* evidenceName(FusionEvidence which);
+
+private:
+    float weights[FUSION_NUM_EVIDENCE];
+    float evidence[FUSION_NUM_EVIDENCE];
+    float score;
+    float instantScore;
+    FireLevel level;
+};
+
+// The rule before fusion: a confirmed flame, or smoke and heat together, is
+// Bahaya; smoke or heat alone is Waspada
+static inline FireLevel legacyFireLevel(bool flameDetected, bool smokeHigh, bool tempHigh) {
+    if (flameDetected || (smokeHigh && tempHigh)) return FIRE_BAHAYA;
+    return (smokeHigh || tempHigh) ? FIRE_WASPADA : FIRE_AMAN;
+}
+
+// ============================================================================
+// TIME-TO-ALARM COMPARISON
+// An episode opens when either rule leaves Aman and closes after both stayed
+// Aman for FUSION_EPISODE_GAP_MS. For each rule the first Waspada and Bahaya
+// are timed from the episode start.
+// ============================================================================
+enum FusionRule {
+    FUSION_RULE_SCORE,
+    FUSION_RULE_LEGACY
+};
+
+enum FusionEpisodeEvent {
+    FUSION_EPISODE_NONE,
+    FUSION_EPISODE_STARTED,
+    FUSION_EPISODE_CLOSED
+};
+
+struct FusionEpisode {
+    bool open;
+    unsigned long startMs;
+    unsigned long quietSinceMs;
+    long firstMs[2][2];             // [FusionRule][waspada, bahaya], -1 = never
+
+    unsigned long durationMs() const { return quietSinceMs - startMs; }
+};
+
+class FusionEpisodeTracker {
+public:
+    FusionEpisodeTracker();
+
+    FusionEpisodeEvent update(FireLevel fused, FireLevel legacy, unsigned long now);
+
+    const FusionEpisode& current() const;     // Valid while current().open
+    const FusionEpisode& last() const;        // Last closed episode (startMs 0 = none yet)
+    uint32_t getClosedCount() const;
+
+private:
+    FusionEpisode episode;
+    FusionEpisode lastEpisode;
+    uint32_t closed;
+
+    void noteLevel(FusionRule rule, FireLevel level, unsigned long now);
+};
+
+#endif // FUSION_SCORE_H
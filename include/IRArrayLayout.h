@@ -0,0 +1,129 @@
+#ifndef IR_ARRAY_LAYOUT_H
+#define IR_ARRAY_LAYOUT_H
+
+#include <stdint.h>
+#include "Config.h"
+
+// ============================================================================
+// IR SENSOR ARRAY LAYOUTS
+// A layout is a traits struct describing the physical array:
+//   channels    number of IR sensors (1..IR_MAX_LAYOUT_CHANNELS)
+//   topology    LINEAR strip (ends are not neighbours) or RING (they are)
+//   ambientMin  simultaneous spikes that mean room-wide IR, not a flame
+//   pin(ch)     GPIO of a channel
+// IRFlameSensorT<Layout> and the spatial table below are generated from it,
+// so a ring of 8 or 12 sensors only needs a new layout struct.
+// ============================================================================
+
+#define IR_MAX_LAYOUT_CHANNELS      12          // 2^12 = 4 KB classification table
+
+enum IRArrayTopology {
+    IR_TOPOLOGY_LINEAR,
+    IR_TOPOLOGY_RING
+};
+
+// The board as built: 5 sensors in a line on IR_PINS
+struct IRStrip5Layout {
+    static const uint8_t channels = 5;
+    static const IRArrayTopology topology = IR_TOPOLOGY_LINEAR;
+    static const uint8_t ambientMin = 4;        // >3 sensors trigger = ambient
+    static int pin(uint8_t channel) { return IR_PINS[channel]; }
+};
+
+// Layout the firmware is built for; also sizes the ADC scan and oversampler
+typedef IRStrip5Layout IRActiveLayout;
+
+// ============================================================================
+// SPATIAL CLASSIFICATION
+// Spike flags are packed into a bitmask (bit i = channel i) and classified
+// with one lookup in a 2^N table generated at compile time:
+//   IDLE       no spikes
+//   POINT      one sensor, or two neighbouring sensors (localized source)
+//   AMBIENT    ambientMin or more sensors (sunlight, room-wide IR)
+//   SCATTERED  anything else (non-adjacent pairs, 3 sensors on a strip of 5)
+// ============================================================================
+
+enum IRSpatialClass {
+    IR_SPATIAL_IDLE,
+    IR_SPATIAL_POINT,
+    IR_SPATIAL_AMBIENT,
+    IR_SPATIAL_SCATTERED
+};
+
+constexpr uint8_t irMaskPopcount(uint32_t mask) {
+    return mask ? (uint8_t)((mask & 1) + irMaskPopcount(mask >> 1)) : 0;
+}
+
+constexpr uint8_t irMaskLowestBit(uint32_t mask) {
+    return (mask & 1) ? 0 : (uint8_t)(1 + irMaskLowestBit(mask >> 1));
+}
+
+constexpr uint8_t irMaskHighestBit(uint32_t mask) {
+    return (mask >> 1) ? (uint8_t)(1 + irMaskHighestBit(mask >> 1)) : 0;
+}
+
+// Two set bits that are neighbours on the array
+constexpr bool irMaskIsAdjacentPair(uint32_t mask, uint8_t channels, IRArrayTopology topology) {
+    return irMaskHighestBit(mask) - irMaskLowestBit(mask) == 1 ||
+           (topology == IR_TOPOLOGY_RING && irMaskLowestBit(mask) == 0 &&
+            irMaskHighestBit(mask) == channels - 1);
+}
+
+constexpr uint8_t irClassifyMask(uint32_t mask, uint8_t channels, IRArrayTopology topology, uint8_t ambientMin) {
+    return irMaskPopcount(mask) == 0 ? IR_SPATIAL_IDLE :
+           irMaskPopcount(mask) >= ambientMin ? IR_SPATIAL_AMBIENT :
+           irMaskPopcount(mask) == 1 ? IR_SPATIAL_POINT :
+           (irMaskPopcount(mask) == 2 && irMaskIsAdjacentPair(mask, channels, topology)) ? IR_SPATIAL_POINT :
+           IR_SPATIAL_SCATTERED;
+}
+
+// C++11 index sequence, built by halving so 4096 entries stay well inside
+// the template depth limit
+template <unsigned... Is>
+struct IRIndexSeq {};
+
+template <typename A, typename B>
+struct IRIndexConcat;
+
+template <unsigned... As, unsigned... Bs>
+struct IRIndexConcat<IRIndexSeq<As...>, IRIndexSeq<Bs...> > {
+    typedef IRIndexSeq<As..., (unsigned)(sizeof...(As) + Bs)...> type;
+};
+
+template <unsigned N>
+struct IRMakeIndexSeq {
+    typedef typename IRIndexConcat<typename IRMakeIndexSeq<N / 2>::type,
+                                   typename IRMakeIndexSeq<N - N / 2>::type>::type type;
+};
+
+template <>
+struct IRMakeIndexSeq<0> {
+    typedef IRIndexSeq<> type;
+};
+
+template <>
+struct IRMakeIndexSeq<1> {
+    typedef IRIndexSeq<0> type;
+};
+
+template <typename Layout, typename Seq = typename IRMakeIndexSeq<1u << Layout::channels>::type>
+struct IRSpatialTable;
+
+template <typename Layout, unsigned... Masks>
+struct IRSpatialTable<Layout, IRIndexSeq<Masks...> > {
+    static_assert(Layout::channels >= 1 && Layout::channels <= IR_MAX_LAYOUT_CHANNELS,
+                  "IR layout must have 1..IR_MAX_LAYOUT_CHANNELS channels");
+
+    static const uint8_t table[sizeof...(Masks)];
+
+    static IRSpatialClass classify(uint32_t spikeMask) {
+        return (IRSpatialClass)table[spikeMask & ((1u << Layout::channels) - 1)];
+    }
+};
+
+template <typename Layout, unsigned... Masks>
+const uint8_t IRSpatialTable<Layout, IRIndexSeq<Masks...> >::table[sizeof...(Masks)] = {
+    irClassifyMask(Masks, Layout::channels, Layout::topology, Layout::ambientMin)...
+};
+
+#endif // IR_ARRAY_LAYOUT_H
@@ -0,0 +1,64 @@
+#ifndef IR_FIXED_POINT_H
+#define IR_FIXED_POINT_H
+
+#include <stdint.h>
+
+// ============================================================================
+// FIXED-POINT BASELINE / DEVIATION PIPELINE
+// Integer-only twin of IRFlameSensor::updateBaselines(), safe to call from an
+// ISR or DMA-completion callback (no FPU state is touched).
+//
+// Baseline and deviation are Q16.16 millivolts. Alpha is held in Q8.24 so the
+// fixed-point time constant matches EMA_ALPHA to within 1e-6 relative; the
+// floor shift adds at most 1/(alpha * 2^16) mV of bias. The warm-up alpha
+// 1/(n+1) is an integer division and the margins arrive already in Q16.16
+// (IRFlameSensor converts them when they are learned), so an update needs
+// no float at all. test/test_ir_fixed_point replays 10^6 updates (0-3300 mV
+// steps, ramps and noise) through both paths: baseline and deviation stay
+// within the 0.05 mV tolerance, so spike decisions only differ when the
+// deviation sits within that of the margin. tools/irfixedbench.cpp times
+// both.
+// ============================================================================
+
+#define IR_Q16_ONE                  (1L << 16)
+#define IR_ALPHA_Q24(alpha)         ((int32_t)((alpha) * 16777216.0 + 0.5))   // Constants only
+
+// Convert whole millivolts to/from Q16.16
+static inline int32_t irMilliVoltsToQ16(int32_t milliVolts) {
+    return milliVolts * IR_Q16_ONE;
+}
+
+static inline float irQ16ToMilliVolts(int32_t q16) {
+    return q16 * (1.0f / IR_Q16_ONE);
+}
+
+// Warm-up alpha max(1/(updates+1), floor) in Q8.24, by integer division
+static inline int32_t irWarmupAlphaQ24(uint32_t updates, int32_t floorQ24) {
+    int32_t alphaQ24 = (int32_t)((1UL << 24) / (updates + 1));
+    return (alphaQ24 > floorQ24) ? alphaQ24 : floorQ24;
+}
+
+// Baseline += alpha * (raw - baseline), all integer
+static inline int32_t irEmaStepQ16(int32_t baselineQ16, uint16_t rawMilliVolts, int32_t alphaQ24) {
+    int32_t errorQ16 = irMilliVoltsToQ16(rawMilliVolts) - baselineQ16;
+    return baselineQ16 + (int32_t)(((int64_t)errorQ16 * alphaQ24) >> 24);
+}
+
+// Run the EMA, deviation and spike test (per-channel margin) over `count`
+// channels. Returns the spike flags packed as a bitmask (bit i = channel i).
+static inline uint32_t irFixedUpdateChannels(const uint16_t* rawMilliVolts,
+                                             int32_t* baselineQ16,
+                                             int32_t* deviationQ16,
+                                             uint8_t count,
+                                             int32_t alphaQ24,
+                                             const int32_t* marginQ16) {
+    uint32_t spikeMask = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        baselineQ16[i] = irEmaStepQ16(baselineQ16[i], rawMilliVolts[i], alphaQ24);
+        deviationQ16[i] = irMilliVoltsToQ16(rawMilliVolts[i]) - baselineQ16[i];
+        if (deviationQ16[i] > marginQ16[i]) spikeMask |= (1UL << i);
+    }
+    return spikeMask;
+}
+
+#endif // IR_FIXED_POINT_H
@@ -1,25 +1,69 @@
 #ifndef IR_FLAME_SENSOR_H
 #define IR_FLAME_SENSOR_H
 
-#include <Arduino.h>
+#include <stdint.h>
+#include <stddef.h>
+#include "FlickerBank.h"
+#include "FirDecimator.h"
+#include "MedianFilter.h"
+#include "SlidingExtrema.h"
+#include "CusumDetector.h"
+#include "IRArrayLayout.h"
 
 // ============================================================================
 // ADVANCED FLAME DETECTION ALGORITHM
-// 5-Channel IR Flame Sensor with:
+// N-Channel IR Flame Sensor (layout in IRArrayLayout.h) with:
 // - Oversampling (64 samples)
-// - Dynamic Baseline (EMA)
+// - Dynamic Baseline (EMA), seeded from the first read and warm-started
+//   from an RTC snapshot after a reset
 // - Spatial Voting Filter
 // - Peak Detection & Scoring
+// - Flicker-band (4-20 Hz) energy per channel
+// - CUSUM change detection for slow build-up below the margin
 // ============================================================================
 
 // Configuration Constants
-#define IR_NUM_CHANNELS             5
-#define OVERSAMPLING_SAMPLES        64          // 64 samples per measurement
+#define IR_NUM_CHANNELS             IRActiveLayout::channels   // Sensors on the board
+#define OVERSAMPLING_SAMPLES        64          // 64 samples per measurement (maximum)
+#define OVERSAMPLING_MIN_SAMPLES    8           // Floor for adaptive oversampling
+#define ADAPTIVE_OVERSAMPLING       1           // 1 = pick samples per channel from noise
+#define ADAPTIVE_CONFIDENCE_Z       3.0f        // Averaged noise kept below distance/Z
+#define NOISE_VARIANCE_ALPHA        0.1f        // Smoothing of per-block Welford variance
 #define EMA_ALPHA                   0.01f       // EMA coefficient (1%)
-#define SENSITIVITY_MARGIN          300         // mV above baseline to detect
-#define AMBIENT_INTERFERENCE_MIN    4           // >3 sensors trigger = ambient
+#define IR_WARMUP_UPDATES           ((uint16_t)(1.0f / EMA_ALPHA))  // alpha = 1/(n+1) until it reaches EMA_ALPHA
+#define IR_BASELINE_SNAPSHOT        1           // 1 = keep baselines in RTC memory across resets
+#define IR_BASELINE_SNAPSHOT_MS     10000       // Snapshot interval while idle
+#define SENSITIVITY_MARGIN          300         // mV above baseline to detect (until learned)
+#define IR_AUTO_MARGIN              1           // 1 = per-channel margin = K x residual sigma
+#define IR_AUTO_MARGIN_K            6.0f        // Margin in residual sigmas
+#define IR_AUTO_MARGIN_MIN_MV       100.0f      // Clamp for very quiet channels
+#define IR_AUTO_MARGIN_MAX_MV       600.0f      // Clamp for very noisy channels
+#define IR_AUTO_MARGIN_ALPHA        0.002f      // Residual variance EMA (~25s at 50ms)
+#define IR_AUTO_MARGIN_WARMUP       400         // Quiet updates before the margin is used (20s)
 #define TEMPORAL_VERIFICATION_MS    500         // 500ms persistence required
+#define SPIKE_HISTORY_WINDOW        10          // Updates judged for duty (<= 64)
+#define SPIKE_DUTY_PERCENT          70          // Spike duty that keeps a detection alive
+#define PEAK_WINDOW_UPDATES         20          // Peak/trough horizon (1s at 50ms)
+#define PEAK_WINDOW_CAPACITY        32          // Fixed deque storage (>= window, power of two)
+#define CONFIDENCE_WEIGHT_LEVEL     50          // Score points for deviation = 2x margin
+#define CONFIDENCE_WEIGHT_PEAK      25          // ... for window peak = 2x margin
+#define CONFIDENCE_WEIGHT_RANGE     25          // ... for peak-to-trough swing = margin
 #define FLAME_DETECTION_UPDATE_MS   50          // Update baseline every 50ms
+#define IR_FIXED_POINT_BASELINE     0           // 1 = integer EMA (IRFixedPoint.h)
+#define FLICKER_DETECTION           1           // 1 = flicker confirms early / delays steady IR
+#define FLICKER_MIN_RMS_MV          20.0f       // In-band RMS for a flickering channel
+#define FLICKER_MIN_RATIO           0.6f        // Share of AC energy inside the flicker band
+#define FLICKER_STEADY_CONFIRM_MS   3000        // Persistence required when the spike is steady
+#define FLICKER_ADC_WINDOW          32          // ADC samples per 100 Hz flicker sample (~10ms)
+#define IR_FIR_PREFILTER            0           // 1 = baseline input from the FIR low-pass stage
+#define IR_FIR_TAPS                 41          // 200ms group delay at 100 Hz
+#define IR_FIR_CUTOFF_HZ            5.0f        // -6dB point; >= 50dB down from 10 Hz
+#define IR_OUTLIER_WINDOW           5           // Updates per median/Hampel window
+#define IR_OUTLIER_FILTER           SAMPLE_FILTER_MEAN  // Default mode of every channel
+#define IR_CUSUM_DRIFT_MV           25.0f       // Rise tolerated without evidence (mV)
+#define IR_CUSUM_THRESHOLD          500.0f      // Decision level (mV x updates): +100 mV in ~7 updates
+#define IR_CUSUM_REFERENCE_TAU_S    600.0f      // CUSUM reference time constant (vs ~5s for the EMA)
+#define IR_FIR_DECIMATION           (FLICKER_SAMPLE_RATE_HZ * FLAME_DETECTION_UPDATE_MS / 1000)
 
 // Flame Detection States
 enum FlameDetectionState {
@@ -29,20 +73,69 @@ enum FlameDetectionState {
     FLAME_AMBIENT_INTERFERENCE
 };
 
-// Structure to hold per-channel sensor data
+// State after an update whose spikes form a point source: a new source (or
+// one showing up while ambient) becomes a potential flame, a potential or
+// confirmed flame keeps its state (only FLAME_POTENTIAL is re-verified)
+static inline FlameDetectionState pointSourceState(FlameDetectionState state) {
+    return (state == FLAME_IDLE || state == FLAME_AMBIENT_INTERFERENCE) ? FLAME_POTENTIAL : state;
+}
+
+// Per-channel view of the sensor state (assembled by getChannelData())
 struct IRChannelData {
     uint16_t rawMilliVolts;         // Current raw reading in mV
     float baseline;                  // Dynamic baseline (EMA)
     float deviation;                 // Current - Baseline
     bool isSpike;                    // True if exceeds threshold
-    unsigned long lastSpikeTime;     // Timestamp of last spike
+    unsigned long lastSpikeTime;     // Timestamp of last spike (from spikeHistory)
+    uint64_t spikeHistory;           // Spike flags, bit 0 = latest update
+    float noiseMilliVolts;           // Per-sample noise sigma (Welford, smoothed)
+    uint16_t samplesPerUpdate;       // Oversampling count used for this update
+    float flickerMilliVolts;         // In-band RMS of the last flicker block
+    float flickerRatio;              // Share of AC energy in the flicker band
+    float peakDeviation;             // Max deviation over PEAK_WINDOW_UPDATES
+    float troughDeviation;           // Min deviation over PEAK_WINDOW_UPDATES
+    uint8_t confidence;              // 0-100 flame confidence of this channel
+    int8_t shift;                    // CUSUM: +1 sustained rise, -1 fall, 0 none
+    float shiftLevel;                // CUSUM rise progress (>= 1 = shift flagged)
+    float marginMilliVolts;          // Spike margin in use (learned or SENSITIVITY_MARGIN)
+    float residualSigma;             // Learned per-update noise sigma (0 = not yet)
+};
+
+// Baseline snapshot record of one layout, kept in RTC memory across resets
+// (see IRFlameSensor.cpp)
+template <uint8_t Channels>
+struct IRBaselineSnapshotT {
+    uint32_t magic;
+    uint32_t channels;
+    float baseline[Channels];
+    float residualVariance[Channels];
+    uint16_t quietUpdates[Channels];
+    uint32_t checksum;
+
+    // FNV-1a over everything before the checksum
+    uint32_t computeChecksum() const {
+        const uint8_t* bytes = (const uint8_t*)this;
+        uint32_t hash = 2166136261UL;
+        for (size_t i = 0; i < offsetof(IRBaselineSnapshotT, checksum); i++) {
+            hash = (hash ^ bytes[i]) * 16777619UL;
+        }
+        return hash;
+    }
 };
 
-// Main Flame Sensor Class
-class IRFlameSensor {
+// Main Flame Sensor Class, generated for one array layout. Channel state is
+// kept as one array per field so the per-update loops run over contiguous
+// data, and the spike flags live in a single bitmask for the spatial table.
+// Only the hardware reads (readOversampledChannels(), updateHighRate())
+// need the layout to fit the ADC scan of IRActiveLayout.
+template <typename Layout>
+class IRFlameSensorT {
+    static_assert(Layout::channels >= 1 && Layout::channels <= IR_MAX_LAYOUT_CHANNELS,
+                  "IR layout must have 1..IR_MAX_LAYOUT_CHANNELS channels");
+
 public:
     // Constructor
-    IRFlameSensor();
+    IRFlameSensorT();
 
     // Initialization
     void init();
@@ -50,14 +143,34 @@ public:
     // Non-blocking update - call this regularly (every 50ms or more frequent)
     void update();
 
+    // Run one full update immediately (for callers that own the timing,
+    // e.g. the pinned sensing task in SensorTask.cpp)
+    void updateNow();
+
+    // Take one 100 Hz sample per channel for the flicker banks (and the FIR
+    // prefilter); call every 1000 / FLICKER_SAMPLE_RATE_HZ ms from the same
+    // task as updateNow()
+    void updateHighRate();
+
     // Get current flame detection state
     FlameDetectionState getFlameState() const;
 
     // Get flame detection boolean
     bool isFlameDetected() const;
 
-    // Get data for a specific channel (0-4)
-    const IRChannelData* getChannelData(uint8_t channel) const;
+    // Flame confidence 0-100: overall (best channel, 0 under ambient
+    // interference) and per channel
+    uint8_t getConfidence() const;
+    uint8_t getChannelConfidence(uint8_t channel) const;
+
+    // Peak/trough horizon in updates (1..PEAK_WINDOW_CAPACITY)
+    void setPeakWindow(uint16_t updates);
+
+    // Get data for a specific channel (all zero for an invalid channel)
+    IRChannelData getChannelData(uint8_t channel) const;
+
+    // Spike flags of the last update, bit i = channel i
+    uint32_t getSpikeMask() const;
 
     // Get all channel raw values as array
     void getAllRawValues(uint16_t* values) const;
@@ -68,36 +181,152 @@ public:
     // Print debug info to Serial (for Serial Plotter compatibility)
     void printDebugInfo();
 
-    // Adjust sensitivity globally
+    // Adjust sensitivity globally. With automatic margins this is the margin
+    // of channels that have not learned their noise yet.
     void setSensitivityMargin(uint16_t margin);
     uint16_t getSensitivityMargin() const;
 
-    // Reset all baselines
+    // Per-channel margins of K x sigma, sigma learned from the residual
+    // (raw - baseline) while the detector is idle and the channel quiet
+    void setAutoMargin(bool enabled);
+    bool isAutoMargin() const;
+
+    // Reset all baselines (the next reading seeds them again)
     void resetBaselines();
 
+    // Armed = baselines valid and no channel spiking since init/reset
+    bool isArmed() const;
+    unsigned long getTimeToArmed() const;   // ms from init/reset, 0 until armed
+    bool isBaselineRestored() const;        // Baselines came from the RTC snapshot
+
+    // Outlier rejection applied to each channel's readings before the EMA.
+    // MEAN = off, MEDIAN = median of the last IR_OUTLIER_WINDOW readings,
+    // HAMPEL = replace only readings that are outliers against that window
+    void setChannelFilter(uint8_t channel, SampleFilterMode mode);
+    SampleFilterMode getChannelFilter(uint8_t channel) const;
+
+    // ADC samples consumed per second, all channels (adaptive oversampling)
+    uint32_t getSamplesPerSecond() const;
+
+    // IR conversions the ADC actually made per second. Equal to the above
+    // with the esp_timer fallback; fixed by ADC_SAMPLE_FREQ_HZ with the DMA
+    // scan, where adaptive oversampling only shortens the blocks.
+    uint32_t getConversionsPerSecond() const;
+
+    // CUSUM change detection on each channel's readings: drift in mV,
+    // decision threshold in mV x updates (see CusumDetector.h)
+    void setChangeDetector(float driftMilliVolts, float threshold);
+    float getChangeDrift() const;
+    float getChangeThreshold() const;
+
+    // Channels with a sustained upward shift, bit i = channel i
+    uint32_t getShiftMask() const;
+
 private:
-    // Channel data storage
-    IRChannelData channels[IR_NUM_CHANNELS];
+    // Channel data storage (structure of arrays)
+    uint16_t rawMilliVolts[Layout::channels];
+    float baseline[Layout::channels];
+    float deviation[Layout::channels];
+    uint32_t spikeMask;                         // Bit i = channel i above the margin
+    uint64_t spikeHistory[Layout::channels];
+    unsigned long lastSpikeTime[Layout::channels];
+    float noiseMilliVolts[Layout::channels];
+    uint16_t samplesPerUpdate[Layout::channels];
+    float flickerMilliVolts[Layout::channels];
+    float flickerRatio[Layout::channels];
+    float peakDeviation[Layout::channels];
+    float troughDeviation[Layout::channels];
+    uint8_t confidence[Layout::channels];
+    uint32_t shiftMask;                         // Bit i = channel i shifted up (CUSUM)
 
     // Detection state tracking
     FlameDetectionState currentState;
     unsigned long potentialFlameStartTime;
+    uint8_t updatesSincePotential;  // Saturates at 64
+    uint8_t overallConfidence;
+
+    // Peak detection: sliding max/min of each channel's deviation
+    SlidingExtrema<float, PEAK_WINDOW_CAPACITY> deviationExtrema[Layout::channels];
 
     // Configuration
     uint16_t sensitivityMargin;
+    bool autoMargin;
+
+    // Automatic margins: EMA of squared residual increments (half of it is
+    // the residual variance; increments ignore the slow baseline lag)
+    float marginMilliVolts[Layout::channels];
+    float residualVariance[Layout::channels];
+    float lastResidual[Layout::channels];
+    uint16_t quietUpdates[Layout::channels];
+
+    // Fixed-point baseline state (Q16.16 mV), used when IR_FIXED_POINT_BASELINE;
+    // marginQ16 mirrors marginMilliVolts, converted when a margin changes
+    int32_t baselineQ16[Layout::channels];
+    int32_t deviationQ16[Layout::channels];
+    int32_t marginQ16[Layout::channels];
+
+    // Baseline warm-up: 0 = not seeded, saturates at IR_WARMUP_UPDATES
+    uint16_t warmupUpdates;
+    bool snapshotPending;           // RTC snapshot waiting for the first reading
+    bool baselineRestored;
+    unsigned long armStartTime;
+    unsigned long timeToArmed;      // 0 = not armed yet
+    unsigned long lastSnapshotTime;
 
     // Timing
     unsigned long lastUpdateTime;
 
+    // Adaptive oversampling bookkeeping
+    float noiseVarianceRaw[Layout::channels];   // < 0 until the first block
+    uint32_t samplesThisSecond;
+    uint32_t samplesPerSecond;
+    uint32_t conversionsAtWindowStart;
+    uint32_t conversionsPerSecond;
+    unsigned long sampleWindowStart;
+
+    // FlickerVerdict of the last block that was a spike from start to end
+    GoertzelBank flickerBanks[Layout::channels];
+    bool flickerSpikeBlock[Layout::channels];
+    uint8_t flickerVerdict[Layout::channels];
+
+    // Slow build-up detection on the cleaned readings
+    CusumDetector shiftDetectors[Layout::channels];
+
+    // Per-channel median / Hampel stage (SAMPLE_FILTER_MEAN = pass-through)
+    MedianFilter<uint16_t, IR_OUTLIER_WINDOW> outlierFilters[Layout::channels];
+
+#if IR_FIR_PREFILTER
+    // Decimating low-pass from the 100 Hz stream to the update rate
+    float firCoeffs[IR_FIR_TAPS];
+    FirDecimator firFilters[Layout::channels];
+    float firOutput[Layout::channels];
+    bool firPrimed;
+    uint32_t firFresh;              // Bit i = new output for channel i
+#endif
+
     // Private methods
-    uint16_t readChannelMilliVolts(uint8_t channel);
+    bool readOversampledChannels();
+    bool readFilteredChannels();
+    void chooseSampleCounts(uint16_t* targets) const;
+    void rejectOutliers();
+    void detectShifts();
+    float baselineAlpha() const;
+    void restoreSnapshot();
+    void saveSnapshot();
+    void checkArmed();
     void updateBaselines();
+    void learnMargins();
+    void refreshMargin(uint8_t channel);
+    void setMargin(uint8_t channel, float milliVolts);
+    void recordSpikeHistory();
+    bool spikeDutyMet() const;
+    bool recentSpikes() const;
+    void scorePeaks();
     void evaluateSpatialPattern();
     void evaluateTemporal();
-    uint8_t countActiveSpikes() const;
-    bool areChannelsAdjacent(uint8_t ch1, uint8_t ch2) const;
-    bool isPointSource() const;
-    bool isAmbientInterference() const;
 };
 
+// The sensor as built (IRActiveLayout), instantiated in IRFlameSensor.cpp
+typedef IRFlameSensorT<IRActiveLayout> IRFlameSensor;
+
 #endif // IR_FLAME_SENSOR_H
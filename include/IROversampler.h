@@ -0,0 +1,80 @@
+#ifndef IR_OVERSAMPLER_H
+#define IR_OVERSAMPLER_H
+
+#include <Arduino.h>
+#include <atomic>
+#include <esp_timer.h>
+#include "IRFlameSensor.h"
+
+// ============================================================================
+// INTERLEAVED OVERSAMPLER
+// Accumulates up to OVERSAMPLING_SAMPLES readings per IR channel with the
+// channels interleaved round-robin, so all accumulations cover the same
+// window. Samples come from the ADC DMA scan (hardware-timed pattern table)
+// when it runs, otherwise from an esp_timer that converts one channel per
+// tick. IRFlameSensor::updateNow() only picks up finished blocks.
+//
+// Each channel keeps a Welford mean/variance over its block, and the number
+// of samples per channel can be changed at every collect() (see
+// IRFlameSensor::chooseSampleCounts()).
+// ============================================================================
+
+#define OVERSAMPLER_TIMER_PERIOD_US 100         // Fallback: 320 samples in ~32ms
+
+// One finished block
+struct IROversampleBlock {
+    uint16_t meanRaw[IR_NUM_CHANNELS];          // Block average (raw code)
+    float varianceRaw[IR_NUM_CHANNELS];         // Per-sample variance (raw code^2)
+    uint16_t samples[IR_NUM_CHANNELS];          // Samples that went into the block
+};
+
+class IROversampler {
+public:
+    IROversampler();
+
+    // Attach to the ADC DMA stream, or start the esp_timer fallback
+    bool begin();
+
+    // Producer side (DMA drain task or timer callback)
+    void feed(uint8_t channel, uint16_t raw);
+
+    // Consumer side: copies the finished block, sets the per-channel sample
+    // counts for the next block (NULL = keep) and re-arms the accumulators.
+    // Returns false if no block is finished.
+    bool collect(IROversampleBlock& block, const uint16_t* nextTargets = NULL);
+
+    // IR conversions delivered so far, used or not. The DMA scan converts
+    // every channel at a fixed rate, so only the timer fallback converts
+    // less when the per-channel targets drop.
+    uint32_t getConversionCount() const;
+    bool isTimerDriven() const;
+
+private:
+    enum Phase : uint8_t {
+        PHASE_ACCUMULATING,     // Producer owns the accumulators
+        PHASE_FINISHED          // Consumer owns finished and targets
+    };
+
+    // Welford accumulators (producer-owned while accumulating)
+    float means[IR_NUM_CHANNELS];
+    float m2[IR_NUM_CHANNELS];
+    uint16_t counts[IR_NUM_CHANNELS];
+    uint16_t targets[IR_NUM_CHANNELS];
+    uint8_t channelsDone;
+
+    IROversampleBlock finished;
+    std::atomic<uint8_t> phase;
+    volatile uint32_t conversionCount;
+
+    // Fallback timer state
+    esp_timer_handle_t timer;
+    uint8_t nextChannel;
+
+    void resetAccumulators();
+    static void onAdcSample(uint8_t slot, uint16_t raw, void* ctx);
+    static void onTimer(void* arg);
+};
+
+extern IROversampler irOversampler;
+
+#endif // IR_OVERSAMPLER_H
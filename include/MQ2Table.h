@@ -0,0 +1,38 @@
+#ifndef MQ2_TABLE_H
+#define MQ2_TABLE_H
+
+#include <stdint.h>
+#include "Config.h"
+
+// ============================================================================
+// MQ-2 ADC -> PPM LOOKUP TABLE
+// Precomputes the MQUnifiedsensor regression chain
+//   ADC -> volt -> Rs -> ratio -> PPM = MQ2_A * ratio^MQ2_B
+// once at init, so getMQ2PPM() costs one interpolation instead of pow().
+// Knots every MQ2_TABLE_STEP codes with linear interpolation keep the error
+// within 0.7% of the library result over 1-10000 PPM (step 16 gives ~3%).
+// ============================================================================
+
+#define MQ2_LOAD_RESISTANCE         10          // kOhm, MQUnifiedsensor default RL
+#define MQ2_TABLE_STEP              8           // ADC codes between knots
+#define MQ2_TABLE_KNOTS             ((1 << MQ2_ADC_BIT_RESOLUTION) / MQ2_TABLE_STEP + 1)
+#define MQ2_PPM_CEILING             1000000.0f  // Rs -> 0 near full scale diverges
+
+class MQ2PPMTable {
+public:
+    MQ2PPMTable();
+
+    // Fill the knots from MQ2_A, MQ2_B, MQ2_R0 and the ADC resolution
+    void build();
+
+    // PPM for a (possibly fractional, averaged) ADC code
+    float lookup(float adcCode) const;
+
+    // Exact library formula, used to build the knots
+    static float computePPM(float adcCode);
+
+private:
+    float knots[MQ2_TABLE_KNOTS];
+};
+
+#endif // MQ2_TABLE_H
@@ -0,0 +1,228 @@
+#ifndef P2_QUANTILE_H
+#define P2_QUANTILE_H
+
+#include <stdint.h>
+
+// ============================================================================
+// P² STREAMING QUANTILE (Jain & Chlamtac, 1985)
+// Estimates one quantile p of a stream with five markers: the minimum, the
+// p/2, p and (1+p)/2 quantiles and the maximum. Each sample moves the
+// marker positions; a marker that falls a whole position behind its desired
+// position is shifted and its height corrected with a piecewise-parabolic
+// (or, if that breaks ordering, linear) prediction. O(1) time, 5 floats of
+// state per marker set, no sample storage.
+//
+// P2WindowQuantile below turns it into a jumping-window estimate for a
+// background that drifts over hours.
+// Has no Arduino dependencies so it can be exercised on the host
+// (test/test_p2_quantile).
+// ============================================================================
+
+class P2Quantile {
+public:
+    // Everything needed to resume (persisted to NVS by SmokeBaseline)
+    struct State {
+        float heights[5];
+        float positions[5];
+        float desired[5];
+        uint32_t count;
+    };
+
+    explicit P2Quantile(float p = 0.5f) : p(p) {
+        reset();
+    }
+
+    void reset() {
+        state.count = 0;
+        for (int i = 0; i < 5; i++) {
+            state.heights[i] = 0.0f;
+            state.positions[i] = i + 1;
+        }
+        state.desired[0] = 1.0f;
+        state.desired[1] = 1.0f + 2.0f * p;
+        state.desired[2] = 1.0f + 4.0f * p;
+        state.desired[3] = 3.0f + 2.0f * p;
+        state.desired[4] = 5.0f;
+    }
+
+    void push(float x) {
+        float* q = state.heights;
+        float* n = state.positions;
+
+        // Start-up: keep the first five samples sorted
+        if (state.count < 5) {
+            int i = state.count++;
+            while (i > 0 && q[i - 1] > x) {
+                q[i] = q[i - 1];
+                i--;
+            }
+            q[i] = x;
+            return;
+        }
+        state.count++;
+
+        // Cell k holding x, extending the extremes if needed
+        int k;
+        if (x < q[0]) {
+            q[0] = x;
+            k = 0;
+        } else if (x >= q[4]) {
+            q[4] = x;
+            k = 3;
+        } else {
+            k = 0;
+            while (k < 3 && x >= q[k + 1]) k++;
+        }
+
+        for (int i = k + 1; i < 5; i++) n[i] += 1.0f;
+        const float increments[5] = {0.0f, p / 2.0f, p, (1.0f + p) / 2.0f, 1.0f};
+        for (int i = 0; i < 5; i++) state.desired[i] += increments[i];
+
+        // Adjust the three middle markers
+        for (int i = 1; i < 4; i++) {
+            float d = state.desired[i] - n[i];
+            if ((d >= 1.0f && n[i + 1] - n[i] > 1.0f) || (d <= -1.0f && n[i - 1] - n[i] < -1.0f)) {
+                int s = (d > 0.0f) ? 1 : -1;
+                float candidate = parabolic(i, s);
+                if (q[i - 1] < candidate && candidate < q[i + 1]) {
+                    q[i] = candidate;
+                } else {
+                    q[i] += s * (q[i + s] - q[i]) / (n[i + s] - n[i]);
+                }
+                n[i] += s;
+            }
+        }
+    }
+
+    // Current estimate (0 before the first sample)
+    float value() const {
+        if (state.count == 0) return 0.0f;
+        if (state.count < 5) return state.heights[(int)((state.count - 1) * p + 0.5f)];
+        return state.heights[2];
+    }
+
+    float quantile() const { return p; }
+    uint32_t count() const { return state.count; }
+
+    const State& getState() const { return state; }
+
+    // Resume from a saved state; false (and no change) if it is inconsistent.
+    // The comparisons are written so that a NaN anywhere fails them.
+    bool setState(const State& saved) {
+        if (saved.count < 5) {
+            for (uint32_t i = 0; i + 1 < saved.count; i++) {
+                if (!(saved.heights[i] <= saved.heights[i + 1])) return false;
+            }
+        } else {
+            // Outer markers sit at 1 and count (count may outrun a float)
+            if (!(saved.positions[0] == 1.0f) || !(saved.positions[4] <= (float)saved.count)) return false;
+            for (int i = 0; i < 4; i++) {
+                if (!(saved.heights[i] <= saved.heights[i + 1]) ||
+                    !(saved.positions[i] < saved.positions[i + 1]) ||
+                    !(saved.desired[i] <= saved.desired[i + 1])) {
+                    return false;
+                }
+            }
+        }
+        state = saved;
+        return true;
+    }
+
+private:
+    float p;
+    State state;
+
+    float parabolic(int i, int s) const {
+        const float* q = state.heights;
+        const float* n = state.positions;
+        return q[i] + s / (n[i + 1] - n[i - 1]) *
+                      ((n[i] - n[i - 1] + s) * (q[i + 1] - q[i]) / (n[i + 1] - n[i]) +
+                       (n[i + 1] - n[i] - s) * (q[i] - q[i - 1]) / (n[i] - n[i - 1]));
+    }
+};
+
+// ============================================================================
+// JUMPING-WINDOW QUANTILE
+// Two P2Quantile estimators started `window` samples apart; each one is
+// restarted after 2 x window samples, and the answer comes from the older
+// one. The estimate therefore always covers the last window..2 x window
+// samples and nothing older. (Exponential forgetting was tried first: a
+// high quantile keeps remembering old peaks through their residual weight.)
+// ============================================================================
+
+class P2WindowQuantile {
+public:
+    struct State {
+        P2Quantile::State halves[2];
+        uint32_t pushes;
+    };
+
+    P2WindowQuantile(float p, uint32_t window) : window(window < 5 ? 5 : window), pushes(0) {
+        halves[0] = P2Quantile(p);
+        halves[1] = P2Quantile(p);
+    }
+
+    void reset() {
+        halves[0].reset();
+        halves[1].reset();
+        pushes = 0;
+    }
+
+    void push(float x) {
+        // Half h restarts every 2 x window samples, the two offset by window
+        for (int h = 0; h < 2; h++) {
+            if (pushes >= (uint32_t)h * window && (pushes - h * window) % (2 * window) == 0) {
+                halves[h].reset();
+            }
+            if (pushes >= (uint32_t)h * window) halves[h].push(x);
+        }
+        pushes++;
+    }
+
+    float value() const { return older().value(); }
+
+    // Samples behind value() (window..2 x window once warmed up)
+    uint32_t count() const { return older().count(); }
+
+    float quantile() const { return halves[0].quantile(); }
+
+    State getState() const {
+        State s;
+        s.halves[0] = halves[0].getState();
+        s.halves[1] = halves[1].getState();
+        s.pushes = pushes;
+        return s;
+    }
+
+    // Also false if the halves' sample counts do not match `pushes`
+    bool setState(const State& saved) {
+        if (saved.halves[0].count != halfCount(0, saved.pushes) ||
+            saved.halves[1].count != halfCount(1, saved.pushes)) {
+            return false;
+        }
+        P2Quantile a = halves[0];
+        P2Quantile b = halves[1];
+        if (!a.setState(saved.halves[0]) || !b.setState(saved.halves[1])) return false;
+        halves[0] = a;
+        halves[1] = b;
+        pushes = saved.pushes;
+        return true;
+    }
+
+private:
+    P2Quantile halves[2];
+    uint32_t window;
+    uint32_t pushes;
+
+    // Samples half h has taken since its last restart, after `n` pushes
+    uint32_t halfCount(int h, uint32_t n) const {
+        uint32_t offset = h * window;
+        return (n > offset) ? (n - offset - 1) % (2 * window) + 1 : 0;
+    }
+
+    const P2Quantile& older() const {
+        return (halves[0].count() >= halves[1].count()) ? halves[0] : halves[1];
+    }
+};
+
+#endif // P2_QUANTILE_H
@@ -0,0 +1,257 @@
+#ifndef RULE_VM_H
+#define RULE_VM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+
+// ============================================================================
+// ALARM RULE BYTECODE VM
+// Straight-line stack programs over a fixed table of sensor inputs, one
+// program per output (Bahaya, Waspada). Rules are compiled on the host by
+// tools/rulec.py, which reads the opcode and input enums below, so this
+// header is the single definition of the format.
+//
+// There are no jumps, so a program runs at most once per byte. load()
+// checks every opcode, operand and the stack depth of every instruction
+// up front. evaluate() then needs no checks: a fixed float stack, no
+// allocation, a few microseconds per rule.
+//
+// Image (little endian):
+//   'A' 'R' version outputs len[outputs] code[len0] code[len1] ... fletcher16
+// Has no Arduino dependencies so it can be exercised on the host
+// (test/test_rule_vm).
+// ============================================================================
+
+#define RULE_IMAGE_VERSION          1
+#define RULE_MAX_IMAGE              256         // Bytes, header and checksum included
+#define RULE_STACK_DEPTH            16          // Float slots
+
+// Keep in order: the compiler numbers them by position
+enum RuleOp {
+    RULE_OP_CONST,          // + float32: push constant
+    RULE_OP_INPUT,          // + uint8: push input
+    RULE_OP_ADD,
+    RULE_OP_SUB,
+    RULE_OP_MUL,
+    RULE_OP_DIV,            // x / 0 = 0
+    RULE_OP_NEG,
+    RULE_OP_LT,             // Comparisons and logic push 1 or 0
+    RULE_OP_LE,
+    RULE_OP_GT,
+    RULE_OP_GE,
+    RULE_OP_EQ,
+    RULE_OP_NE,
+    RULE_OP_AND,
+    RULE_OP_OR,
+    RULE_OP_NOT,
+    RULE_OP_MIN,
+    RULE_OP_MAX,
+    RULE_OP_ABS,
+    RULE_OP_SELECT,         // c a b -> c ? a : b
+    RULE_NUM_OPS
+};
+
+// Keep in order: the compiler takes each name as the lower-case suffix.
+// Append only, so images compiled earlier keep their input numbers.
+enum RuleInput {
+    RULE_IN_FLAME,              // 1 = FLAME_DETECTED
+    RULE_IN_FLAME_STATE,        // FlameDetectionState
+    RULE_IN_FLAME_CONFIDENCE,   // 0-100
+    RULE_IN_IR_MAX,             // Highest IR channel (ADC)
+    RULE_IN_IR_SHIFT,           // IR CUSUM level (>= 1 = shift)
+    RULE_IN_SMOKE,              // PPM
+    RULE_IN_SMOKE_THRESHOLD,    // Adaptive threshold (PPM)
+    RULE_IN_SMOKE_BACKGROUND,   // Learned background (PPM)
+    RULE_IN_SMOKE_SLOPE,        // PPM/s
+    RULE_IN_SMOKE_SHIFT,        // Smoke CUSUM level
+    RULE_IN_SMOKE_HIGH,         // Smoke over its threshold, with hysteresis
+    RULE_IN_TEMP,               // C (-999 = DHT22 failed)
+    RULE_IN_TEMP_SLOPE,         // C/s
+    RULE_IN_TEMP_HIGH,          // Temperature over THRESHOLD_TEMP, with hysteresis
+    RULE_IN_SCORE,              // Fusion score 0-100
+    RULE_IN_SCORE_WASPADA,      // Score over the Waspada level, with hysteresis
+    RULE_IN_SCORE_BAHAYA,       // Score over the Bahaya level, with hysteresis
+    RULE_IN_PREALARM,           // Trend pre-alarm
+    RULE_IN_PREALARM_ETA,       // Seconds to the predicted crossing
+    RULE_IN_MODEL_FLAME,        // Flame probability of the int8 classifier (0-100)
+    RULE_IN_MODEL_NUISANCE,     // Nuisance (sunlight, curtain, halogen) probability (0-100)
+    RULE_NUM_INPUTS
+};
+
+enum RuleOutput {
+    RULE_OUT_BAHAYA,
+    RULE_OUT_WASPADA,
+    RULE_NUM_OUTPUTS
+};
+
+static inline const char* ruleOpName(uint8_t op) {
+    static const char* const names[] = {
+        "CONST", "INPUT", "ADD", "SUB", "MUL", "DIV", "NEG",
+        "LT", "LE", "GT", "GE", "EQ", "NE", "AND", "OR", "NOT",
+        "MIN", "MAX", "ABS", "SELECT"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == RULE_NUM_OPS, "ruleOpName out of step with RuleOp");
+    return (op < RULE_NUM_OPS) ? names[op] : "?";
+}
+
+static inline const char* ruleInputName(uint8_t input) {
+    static const char* const names[] = {
+        "flame", "flame_state", "flame_confidence", "ir_max", "ir_shift",
+        "smoke", "smoke_threshold", "smoke_background", "smoke_slope", "smoke_shift", "smoke_high",
+        "temp", "temp_slope", "temp_high",
+        "score", "score_waspada", "score_bahaya",
+        "prealarm", "prealarm_eta",
+        "model_flame", "model_nuisance"
+    };
+    static_assert(sizeof(names) / sizeof(names[0]) == RULE_NUM_INPUTS, "ruleInputName out of step with RuleInput");
+    return (input < RULE_NUM_INPUTS) ? names[input] : "?";
+}
+
+static inline uint16_t ruleFletcher16(const uint8_t* data, size_t length) {
+    uint16_t a = 0, b = 0;
+    for (size_t i = 0; i < length; i++) {
+        a = (a + data[i]) % 255;
+        b = (b + a) % 255;
+    }
+    return (uint16_t)((b << 8) | a);
+}
+
+class RuleProgram {
+public:
+    RuleProgram() : imageLength(0) {}
+
+    // Verify an image and take a copy. On failure the current program is
+    // kept and `error` says why.
+    bool load(const uint8_t* data, size_t length, const char** error) {
+        const char* reason = check(data, length);
+        if (error) *error = reason;
+        if (reason) return false;
+
+        memcpy(image, data, length);
+        imageLength = (uint16_t)length;
+        uint16_t offset = 4 + RULE_NUM_OUTPUTS;
+        for (int i = 0; i < RULE_NUM_OUTPUTS; i++) {
+            offsets[i] = offset;
+            offset += image[4 + i];
+        }
+        return true;
+    }
+
+    void clear() { imageLength = 0; }
+    bool isLoaded() const { return imageLength != 0; }
+    size_t size() const { return imageLength; }
+    const uint8_t* data() const { return image; }
+
+    // Code of one output (for the disassembler)
+    const uint8_t* code(uint8_t output, uint8_t& length) const {
+        length = isLoaded() ? image[4 + output] : 0;
+        return image + (isLoaded() ? offsets[output] : 0);
+    }
+
+    // Run one output over RULE_NUM_INPUTS values (0 when nothing is loaded)
+    float evaluate(uint8_t output, const float* inputs) const {
+        if (!isLoaded() || output >= RULE_NUM_OUTPUTS) return 0.0f;
+
+        float stack[RULE_STACK_DEPTH];
+        int sp = 0;
+        const uint8_t* pc = image + offsets[output];
+        const uint8_t* end = pc + image[4 + output];
+
+        while (pc < end) {
+            float b;
+            switch (*pc++) {
+                case RULE_OP_CONST:  memcpy(&stack[sp++], pc, sizeof(float)); pc += sizeof(float); break;
+                case RULE_OP_INPUT:  stack[sp++] = inputs[*pc++]; break;
+                case RULE_OP_ADD:    b = stack[--sp]; stack[sp - 1] += b; break;
+                case RULE_OP_SUB:    b = stack[--sp]; stack[sp - 1] -= b; break;
+                case RULE_OP_MUL:    b = stack[--sp]; stack[sp - 1] *= b; break;
+                case RULE_OP_DIV:    b = stack[--sp]; stack[sp - 1] = (b != 0.0f) ? stack[sp - 1] / b : 0.0f; break;
+                case RULE_OP_NEG:    stack[sp - 1] = -stack[sp - 1]; break;
+                case RULE_OP_LT:     b = stack[--sp]; stack[sp - 1] = stack[sp - 1] < b; break;
+                case RULE_OP_LE:     b = stack[--sp]; stack[sp - 1] = stack[sp - 1] <= b; break;
+                case RULE_OP_GT:     b = stack[--sp]; stack[sp - 1] = stack[sp - 1] > b; break;
+                case RULE_OP_GE:     b = stack[--sp]; stack[sp - 1] = stack[sp - 1] >= b; break;
+                case RULE_OP_EQ:     b = stack[--sp]; stack[sp - 1] = stack[sp - 1] == b; break;
+                case RULE_OP_NE:     b = stack[--sp]; stack[sp - 1] = stack[sp - 1] != b; break;
+                case RULE_OP_AND:    b = stack[--sp]; stack[sp - 1] = (stack[sp - 1] != 0.0f) && (b != 0.0f); break;
+                case RULE_OP_OR:     b = stack[--sp]; stack[sp - 1] = (stack[sp - 1] != 0.0f) || (b != 0.0f); break;
+                case RULE_OP_NOT:    stack[sp - 1] = (stack[sp - 1] == 0.0f); break;
+                case RULE_OP_MIN:    b = stack[--sp]; if (b < stack[sp - 1]) stack[sp - 1] = b; break;
+                case RULE_OP_MAX:    b = stack[--sp]; if (b > stack[sp - 1]) stack[sp - 1] = b; break;
+                case RULE_OP_ABS:    if (stack[sp - 1] < 0.0f) stack[sp - 1] = -stack[sp - 1]; break;
+                case RULE_OP_SELECT:
+                    sp -= 2;
+                    stack[sp - 1] = (stack[sp - 1] != 0.0f) ? stack[sp] : stack[sp + 1];
+                    break;
+            }
+        }
+        return stack[0];
+    }
+
+    bool isTrue(uint8_t output, const float* inputs) const {
+        return evaluate(output, inputs) != 0.0f;
+    }
+
+    // Stack effect of an opcode: values popped and pushed, operand bytes
+    static bool opShape(uint8_t op, uint8_t& pops, uint8_t& pushes, uint8_t& operand) {
+        pushes = 1;
+        operand = 0;
+        switch (op) {
+            case RULE_OP_CONST:  pops = 0; operand = sizeof(float); return true;
+            case RULE_OP_INPUT:  pops = 0; operand = 1; return true;
+            case RULE_OP_NEG:
+            case RULE_OP_NOT:
+            case RULE_OP_ABS:    pops = 1; return true;
+            case RULE_OP_SELECT: pops = 3; return true;
+            default:             pops = 2; return op < RULE_NUM_OPS;
+        }
+    }
+
+private:
+    uint8_t image[RULE_MAX_IMAGE];
+    uint16_t imageLength;
+    uint16_t offsets[RULE_NUM_OUTPUTS];
+
+    // NULL if the image is safe to run, else the reason it is not
+    static const char* check(const uint8_t* data, size_t length) {
+        const size_t header = 4 + RULE_NUM_OUTPUTS;
+        if (length < header + 2 || length > RULE_MAX_IMAGE) return "bad size";
+        if (data[0] != 'A' || data[1] != 'R') return "bad magic";
+        if (data[2] != RULE_IMAGE_VERSION) return "unsupported version";
+        if (data[3] != RULE_NUM_OUTPUTS) return "wrong number of outputs";
+
+        uint16_t stored = data[length - 2] | (data[length - 1] << 8);
+        if (ruleFletcher16(data, length - 2) != stored) return "checksum mismatch";
+
+        size_t offset = header;
+        for (int i = 0; i < RULE_NUM_OUTPUTS; i++) offset += data[4 + i];
+        if (offset != length - 2) return "section lengths do not match the size";
+
+        offset = header;
+        for (int i = 0; i < RULE_NUM_OUTPUTS; i++) {
+            const char* reason = checkCode(data + offset, data[4 + i]);
+            if (reason) return reason;
+            offset += data[4 + i];
+        }
+        return NULL;
+    }
+
+    static const char* checkCode(const uint8_t* code, uint8_t length) {
+        int depth = 0;
+        for (uint8_t pc = 0; pc < length;) {
+            uint8_t pops, pushes, operand;
+            uint8_t op = code[pc++];
+            if (!opShape(op, pops, pushes, operand)) return "unknown opcode";
+            if (pc + operand > length) return "truncated operand";
+            if (op == RULE_OP_INPUT && code[pc] >= RULE_NUM_INPUTS) return "unknown input";
+            if (depth < pops) return "stack underflow";
+            depth += pushes - pops;
+            if (depth > RULE_STACK_DEPTH) return "stack overflow";
+            pc += operand;
+        }
+        return (depth == 1) ? NULL : "rule must leave exactly one value";
+    }
+};
+
+#endif // RULE_VM_H
@@ -0,0 +1,84 @@
+#ifndef SAMPLE_RING_H
+#define SAMPLE_RING_H
+
+#include <stdint.h>
+#include <atomic>
+
+// ============================================================================
+// SINGLE-PRODUCER SAMPLE RING
+// Fixed-capacity ring of ADC samples. One writer (the DMA drain task) pushes,
+// any number of readers average the newest N samples without locking.
+// Has no Arduino dependencies so it can be exercised on the host.
+// ============================================================================
+
+template <typename T, uint16_t Capacity>
+class SampleRing {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SampleRing capacity must be a power of two");
+
+public:
+    SampleRing() : head(0) {
+        for (uint16_t i = 0; i < Capacity; i++) buffer[i] = 0;
+    }
+
+    // Writer side - called from exactly one task
+    void push(T value) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        buffer[h & (Capacity - 1)] = value;
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Total number of samples ever pushed (wraps at 2^32)
+    uint32_t written() const {
+        return head.load(std::memory_order_acquire);
+    }
+
+    // Number of valid samples currently held
+    uint16_t size() const {
+        uint32_t h = written();
+        return (h < Capacity) ? (uint16_t)h : Capacity;
+    }
+
+    T newest() const {
+        uint32_t h = written();
+        return (h == 0) ? 0 : buffer[(h - 1) & (Capacity - 1)];
+    }
+
+    // Sum the newest `count` samples. Returns how many were actually summed
+    // (fewer than requested right after start-up). Reading while the writer
+    // laps the window may mix in a newer sample, which is harmless for an
+    // average, so keep `count` well below Capacity.
+    uint16_t sumNewest(uint16_t count, uint32_t& sum) const {
+        uint32_t h = written();
+        uint16_t available = (h < Capacity) ? (uint16_t)h : Capacity;
+        if (count > available) count = available;
+
+        sum = 0;
+        for (uint16_t i = 1; i <= count; i++) {
+            sum += buffer[(h - i) & (Capacity - 1)];
+        }
+        return count;
+    }
+
+    // Copy the newest `count` samples (oldest first). Returns how many were copied.
+    uint16_t copyNewest(uint16_t count, T* out) const {
+        uint32_t h = written();
+        uint16_t available = (h < Capacity) ? (uint16_t)h : Capacity;
+        if (count > available) count = available;
+
+        for (uint16_t i = 0; i < count; i++) {
+            out[i] = buffer[(h - count + i) & (Capacity - 1)];
+        }
+        return count;
+    }
+
+    void clear() {
+        head.store(0, std::memory_order_release);
+    }
+
+private:
+    T buffer[Capacity];
+    std::atomic<uint32_t> head;
+};
+
+#endif // SAMPLE_RING_H
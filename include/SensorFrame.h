@@ -0,0 +1,29 @@
+#ifndef SENSOR_FRAME_H
+#define SENSOR_FRAME_H
+
+#include <stdint.h>
+#include "IRFlameSensor.h"
+
+#define SENSOR_FRAME_IR_CHANNELS IR_NUM_CHANNELS
+
+// Satu snapshot semua sensor per tick. Setiap kanal dibaca tepat satu kali;
+// deteksi, publikasi Blynk dan output debug memakai frame yang sama.
+struct SensorFrame {
+    uint16_t ir[SENSOR_FRAME_IR_CHANNELS];  // Rata-rata ADC mentah per kanal IR
+    uint16_t irMax;                         // Nilai IR tertinggi
+    uint8_t irArgMax;                       // Kanal dengan nilai tertinggi
+    FlameDetectionState flameState;         // Snapshot terbaru dari task IRFlameSensor
+    bool flameDetected;                     // flameState == FLAME_DETECTED
+    uint8_t flameConfidence;                // Skor keyakinan api 0-100
+    uint8_t modelClass;                     // FlameClass dari classifier int8
+    uint8_t modelFlame;                     // Probabilitas api menurut model (0-100)
+    uint8_t modelNuisance;                  // Probabilitas gangguan: matahari, tirai, halogen (0-100)
+    float irShiftLevel;                     // CUSUM kenaikan IR, kanal tertinggi (>= 1 = bergeser)
+    float smokePPM;                         // MQ-2
+    float smokeShiftLevel;                  // CUSUM kenaikan asap (>= 1 = bergeser)
+    float temperature;                      // DHT22 (°C, -999 jika gagal)
+    uint32_t temperatureReads;              // Jumlah bacaan DHT22 selesai; berubah = sampel suhu baru
+    int64_t timestampUs;                    // esp_timer_get_time() saat capture
+};
+
+#endif
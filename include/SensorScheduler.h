@@ -0,0 +1,84 @@
+#ifndef SENSOR_SCHEDULER_H
+#define SENSOR_SCHEDULER_H
+
+#include <Arduino.h>
+
+// ============================================================================
+// MULTI-RATE SENSOR SCHEDULER
+// Each driver registers a period, a relative deadline and a poll callback.
+// Released jobs run earliest-deadline-first (non-preemptive); a poll that
+// returns false stays pending and is polled again SCHED_ASYNC_POLL_US later,
+// which lets asynchronous drivers (DHT22 over RMT) start a transaction and
+// finish it later while the other jobs keep running. Per task the scheduler
+// records release jitter, execution time and missed deadlines.
+// ============================================================================
+
+#define SCHED_MAX_TASKS             8
+#define SCHED_ASYNC_POLL_US         1000        // Re-poll interval for pending async jobs
+
+// Returns true when the job is finished
+typedef bool (*SchedPollFn)(void* ctx);
+// Called once when a job finishes
+typedef void (*SchedCompleteFn)(void* ctx);
+
+struct SchedTaskStats {
+    uint32_t jobs;                  // Finished jobs
+    uint32_t missedDeadlines;       // Finished late, or releases skipped by overrun
+    uint32_t maxReleaseJitterUs;    // First poll - ideal release
+    uint64_t totalReleaseJitterUs;
+    uint32_t maxExecUs;             // Sum of poll durations for one job
+    uint64_t totalExecUs;
+};
+
+class SensorScheduler {
+public:
+    SensorScheduler();
+
+    // Returns the task index, or -1 if the table is full
+    int8_t addTask(const char* name, uint32_t periodMs, uint32_t deadlineMs,
+                   SchedPollFn poll, SchedCompleteFn complete = NULL, void* ctx = NULL);
+
+    // Release every task now
+    void start();
+
+    // Release due jobs and run the earliest-deadline one.
+    // Returns microseconds until the scheduler needs to run again (0 = now).
+    uint32_t runOnce();
+
+    uint8_t getTaskCount() const;
+    const char* getTaskName(uint8_t index) const;
+    bool getStats(uint8_t index, SchedTaskStats& stats) const;
+    void resetStats();
+
+    // Table of the statistics above (used by the "sched" console command)
+    void printStats(Print& out) const;
+
+private:
+    struct Task {
+        const char* name;
+        uint32_t periodUs;
+        uint32_t deadlineUs;
+        SchedPollFn poll;
+        SchedCompleteFn complete;
+        void* ctx;
+
+        uint32_t nextReleaseUs;
+        uint32_t releaseUs;         // Ideal release of the pending job
+        uint32_t absDeadlineUs;
+        uint32_t jobExecUs;
+        uint32_t nextPollUs;        // Earliest re-poll of a waiting async job
+        bool pending;
+        bool started;
+
+        SchedTaskStats stats;
+    };
+
+    Task tasks[SCHED_MAX_TASKS];
+    uint8_t taskCount;
+
+    void releaseDueJobs(uint32_t now);
+    bool isRunnable(const Task& task, uint32_t now) const;
+    void finishJob(Task& task);
+};
+
+#endif // SENSOR_SCHEDULER_H
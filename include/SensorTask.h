@@ -0,0 +1,74 @@
+#ifndef SENSOR_TASK_H
+#define SENSOR_TASK_H
+
+#include <Arduino.h>
+#include "IRFlameSensor.h"
+#include "SensorScheduler.h"
+#include "CusumDetector.h"
+#include "FlameClassifier.h"
+
+// ============================================================================
+// REAL-TIME SENSING TASK
+// One task pinned to the app core owns every sensor driver. The drivers are
+// registered with a SensorScheduler (period, deadline, poll callback) and
+// run deadline-first, independent of how long BlynkEdgent.run() takes.
+// Results are published through sequence locks, so loop() never waits.
+// ============================================================================
+
+#define SENSOR_TASK_STACK           4096
+#define SENSOR_TASK_PRIORITY        3           // Above loopTask (1)
+#define SENSOR_TASK_CORE            APP_CPU_NUM
+
+// Driver rates (period / relative deadline, ms)
+#define SENSOR_IR_PERIOD_MS         FLAME_DETECTION_UPDATE_MS
+#define SENSOR_IR_DEADLINE_MS       FLAME_DETECTION_UPDATE_MS
+#define SENSOR_FLICKER_PERIOD_MS    (1000 / FLICKER_SAMPLE_RATE_HZ)
+#define SENSOR_FLICKER_DEADLINE_MS  SENSOR_FLICKER_PERIOD_MS
+#define SENSOR_MQ2_PERIOD_MS        100
+#define SENSOR_MQ2_DEADLINE_MS      100
+#define SENSOR_DHT_PERIOD_MS        2000        // DHT22 needs >= 2s between reads
+#define SENSOR_DHT_DEADLINE_MS      40          // Start pulse + ~5ms frame + timeout margin
+
+// Slow smoke build-up (CUSUM on every MQ-2 reading, see CusumDetector.h)
+#define MQ2_CUSUM_DRIFT_PPM         3.0f        // Rise tolerated without evidence
+#define MQ2_CUSUM_THRESHOLD         150.0f      // Decision level (PPM x readings): +10 PPM in ~2s
+#define MQ2_CUSUM_REFERENCE_TAU_S   600.0f      // Reference time constant
+
+// Immutable copy of the detector output for one update
+struct FlameSnapshot {
+    FlameDetectionState state;
+    uint8_t confidence;             // 0-100, IRFlameSensor::getConfidence()
+    IRChannelData channels[IR_NUM_CHANNELS];
+    uint32_t samplesPerSecond;      // ADC samples consumed (adaptive oversampling)
+    uint32_t conversionsPerSecond;  // IR conversions made (fixed in DMA mode)
+    uint8_t modelClass;             // FlameClass of the int8 classifier
+    uint8_t modelProbability[FLAME_NUM_CLASSES];  // 0-100 per class
+    float modelFeatures[FLAME_NUM_FEATURES];
+    uint16_t modelMicros;           // Feature extraction + inference time
+    uint32_t updateCount;           // Increments once per published update
+    int64_t timestampUs;            // esp_timer_get_time() after the update
+};
+
+// Latest MQ-2 and DHT22 values
+struct EnvSnapshot {
+    float smokePPM;
+    float smokeShiftLevel;          // MQ-2 CUSUM rise progress (>= 1 = shift flagged)
+    float temperature;              // -999 while the DHT22 has no fresh reading
+    float humidity;
+    uint32_t temperatureReads;      // Finished DHT22 reads (one per new temperature)
+    uint32_t updateCount;
+    int64_t timestampUs;
+};
+
+extern IRFlameSensor flameSensor;
+extern SensorScheduler sensorScheduler;
+extern CusumDetector smokeChangeDetector;
+
+// Initialize the detector, register the drivers and start the pinned task
+bool startSensorTask();
+
+// Latest published snapshots; false until the first update completes
+bool readFlameSnapshot(FlameSnapshot& snapshot);
+bool readEnvSnapshot(EnvSnapshot& snapshot);
+
+#endif // SENSOR_TASK_H
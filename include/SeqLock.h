@@ -0,0 +1,57 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+
+// ============================================================================
+// SEQUENCE LOCK
+// Lock-free single-writer publication of a plain struct. The writer bumps the
+// sequence to odd, copies, then bumps it to even; readers retry if they saw an
+// odd value or the sequence changed under them. The writer must never block
+// behind a reader, so run it at a higher priority than any reader sharing its
+// core.
+// ============================================================================
+
+template <typename T>
+class SeqLock {
+public:
+    SeqLock() : sequence(0) {
+        memset(&value, 0, sizeof(value));
+    }
+
+    void write(const T& data) {
+        uint32_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(&value, &data, sizeof(T));
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Returns false if nothing was published yet or the writer kept
+    // interfering for `maxRetries` attempts; `out` is untouched then.
+    bool read(T& out, uint8_t maxRetries = 8) const {
+        T copy;
+        for (uint8_t attempt = 0; attempt < maxRetries; attempt++) {
+            uint32_t before = sequence.load(std::memory_order_acquire);
+            if (before == 0) return false;
+            if (before & 1) continue;
+
+            memcpy(&copy, &value, sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (sequence.load(std::memory_order_relaxed) == before) {
+                out = copy;
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    std::atomic<uint32_t> sequence;
+    T value;
+};
+
+#endif // SEQ_LOCK_H
@@ -0,0 +1,76 @@
+#ifndef SLIDING_EXTREMA_H
+#define SLIDING_EXTREMA_H
+
+#include <stdint.h>
+
+// ============================================================================
+// SLIDING-WINDOW MAX / MIN
+// Two monotonic deques over the last `window` pushes: the max deque keeps
+// values in decreasing order, the min deque in increasing order, each with
+// the push index so expired entries fall off the front. Every value enters
+// and leaves each deque once, so a push is O(1) amortized. Storage is a fixed
+// ring of Capacity entries (no allocation); window <= Capacity.
+// ============================================================================
+
+template <typename T, uint16_t Capacity>
+class SlidingExtrema {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0,
+                  "SlidingExtrema capacity must be a power of two");
+
+public:
+    explicit SlidingExtrema(uint16_t window = Capacity) {
+        setWindow(window);
+    }
+
+    void setWindow(uint16_t newWindow) {
+        window = (newWindow == 0) ? 1 : (newWindow > Capacity ? Capacity : newWindow);
+        reset();
+    }
+
+    uint16_t getWindow() const { return window; }
+
+    void reset() {
+        pushes = 0;
+        maxHead = maxTail = 0;
+        minHead = minTail = 0;
+    }
+
+    void push(T value) {
+        uint32_t index = pushes++;
+
+        // Drop entries that left the window
+        while (maxHead != maxTail && index - maxIndex[maxHead & MASK] >= window) maxHead++;
+        while (minHead != minTail && index - minIndex[minHead & MASK] >= window) minHead++;
+
+        // Entries dominated by the new value can never be the extreme again
+        while (maxHead != maxTail && maxValue[(uint16_t)(maxTail - 1) & MASK] <= value) maxTail--;
+        while (minHead != minTail && minValue[(uint16_t)(minTail - 1) & MASK] >= value) minTail--;
+
+        maxValue[maxTail & MASK] = value;
+        maxIndex[maxTail & MASK] = index;
+        maxTail++;
+        minValue[minTail & MASK] = value;
+        minIndex[minTail & MASK] = index;
+        minTail++;
+    }
+
+    bool empty() const { return pushes == 0; }
+
+    // Extremes of the window; T() before the first push
+    T max() const { return empty() ? T() : maxValue[maxHead & MASK]; }
+    T min() const { return empty() ? T() : minValue[minHead & MASK]; }
+
+private:
+    static const uint16_t MASK = Capacity - 1;
+
+    T maxValue[Capacity];
+    uint32_t maxIndex[Capacity];
+    T minValue[Capacity];
+    uint32_t minIndex[Capacity];
+    uint16_t maxHead, maxTail;
+    uint16_t minHead, minTail;
+    uint32_t pushes;
+    uint16_t window;
+};
+
+#endif // SLIDING_EXTREMA_H
@@ -0,0 +1,49 @@
+#ifndef SMOKE_BASELINE_H
+#define SMOKE_BASELINE_H
+
+#include <Arduino.h>
+#include "P2Quantile.h"
+
+// ============================================================================
+// ADAPTIVE SMOKE THRESHOLD
+// The MQ-2 background (cooking, workshop dust, humidity) drifts by several
+// times over a day. Quiet-time readings are averaged over
+// SMOKE_BASELINE_SAMPLE_MS and fed to streaming p50 / p95 estimators
+// (P2Quantile.h, last 30-60 minutes, constant memory). The smoke threshold
+// then sits above the learned background:
+//   threshold = p95 + max(SMOKE_THRESHOLD_MARGIN_PPM, K x (p95 - p50))
+// clamped to [SMOKE_THRESHOLD_MIN_PPM, SMOKE_THRESHOLD_MAX_PPM]. Until
+// SMOKE_BASELINE_MIN_SAMPLES have been learned THRESHOLD_SMOKE applies. The
+// estimator state is saved to NVS so a reboot resumes without relearning.
+// ============================================================================
+
+#define SMOKE_ADAPTIVE_THRESHOLD        1           // 0 = fixed THRESHOLD_SMOKE
+#define SMOKE_BASELINE_SAMPLE_MS        10000       // One learning sample per 10s (averaged)
+#define SMOKE_BASELINE_WINDOW           180         // Samples per half window (30 min)
+#define SMOKE_BASELINE_MIN_SAMPLES      60          // 10 min of learning before adapting
+#define SMOKE_THRESHOLD_MARGIN_PPM      30.0f       // Minimum distance above p95
+#define SMOKE_THRESHOLD_SPREAD_K        1.0f        // ... or K x the p50-p95 spread if larger
+#define SMOKE_THRESHOLD_MIN_PPM         30.0f
+#define SMOKE_THRESHOLD_MAX_PPM         300.0f
+#define SMOKE_BACKGROUND_DEFAULT_PPM    20.0f       // Background assumed before learning
+#define SMOKE_BASELINE_SAVE_MS          900000UL    // NVS write at most every 15 min
+#define SMOKE_BASELINE_NVS_NAMESPACE    "smokebl"
+#define SMOKE_BASELINE_FORMAT_VERSION   1
+
+// Restore the estimators from NVS (call once in setup)
+void initSmokeBaseline();
+
+// Feed every reading; `quiet` = no alarm in progress (otherwise not learned)
+void updateSmokeBaseline(float smokePPM, bool quiet);
+
+// Effective smoke threshold and learned background (p50), in PPM
+float getSmokeThreshold();
+float getSmokeBackground();
+float getSmokeP95();
+bool isSmokeBaselineLearned();
+
+void resetSmokeBaseline();
+void saveSmokeBaseline();
+void printSmokeBaseline(Print& out);
+
+#endif // SMOKE_BASELINE_H
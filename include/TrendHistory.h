@@ -0,0 +1,133 @@
+#ifndef TREND_HISTORY_H
+#define TREND_HISTORY_H
+
+#include <stdint.h>
+#include <math.h>
+
+// ============================================================================
+// RING HISTORY WITH INCREMENTAL LEAST-SQUARES TREND
+// Keeps the last Capacity samples of a uniformly sampled signal and the sums
+// Sy, Sxy, Syy of a line fit over them, with x = 0 for the oldest sample.
+// When the ring is full, dropping the oldest sample shifts every x down by
+// one, so the sums are updated in O(1) per push:
+//   Sxy' = Sxy - (Sy - y_old) + (n - 1) * y_new
+//   Sy'  = Sy - y_old + y_new
+// Sx and Sxx only depend on n. The sums are doubles so that weeks of
+// add/subtract do not drift (a few soft-float ops per push): after 2M
+// pushes slope() still matches a fresh fit to within its float rounding.
+// Has no Arduino dependencies so it can be exercised on the host
+// (test/test_trend_history).
+// ============================================================================
+
+#define TREND_MIN_SAMPLES           8           // Fit needs this many samples
+#define TREND_MIN_T                 3.0f        // Slope must exceed T x its standard error
+
+template <uint16_t Capacity>
+class TrendHistory {
+    static_assert(Capacity >= TREND_MIN_SAMPLES, "TrendHistory capacity below TREND_MIN_SAMPLES");
+
+public:
+    explicit TrendHistory(float samplePeriodSeconds) : period(samplePeriodSeconds) {
+        reset();
+    }
+
+    void reset() {
+        head = 0;
+        count = 0;
+        sumY = sumXY = sumYY = 0.0;
+    }
+
+    void push(float value) {
+        double y = value;
+        if (count < Capacity) {
+            sumXY += (double)count * y;
+            sumY += y;
+            sumYY += y * y;
+            values[(head + count) % Capacity] = value;
+            count++;
+            return;
+        }
+
+        double old = values[head];
+        sumXY += -(sumY - old) + (double)(Capacity - 1) * y;
+        sumY += y - old;
+        sumYY += y * y - old * old;
+        values[head] = value;
+        head = (head + 1) % Capacity;
+    }
+
+    uint16_t size() const { return count; }
+    bool ready() const { return count >= TREND_MIN_SAMPLES; }
+
+    // Newest sample (0 when empty)
+    float newest() const {
+        return (count == 0) ? 0.0f : values[(head + count - 1) % Capacity];
+    }
+
+    // Fitted slope in units per second (0 until ready)
+    float slope() const {
+        return ready() ? (float)(slopePerSample() / period) : 0.0f;
+    }
+
+    // Standard error of slope() from the fit residuals
+    float slopeStdError() const {
+        if (!ready()) return 0.0f;
+        double n = count;
+        double b = slopePerSample();
+        double a = (sumY - b * sumX()) / n;
+        double sse = sumYY - a * sumY - b * sumXY;
+        if (sse < 0.0) sse = 0.0;           // Rounding on a perfect line
+        return (float)(sqrt(sse / (n - 2.0) / centredSxx()) / period);
+    }
+
+    // Value of the fitted line at the newest sample (less noisy than newest())
+    float fittedNow() const {
+        if (count == 0) return 0.0f;
+        if (!ready()) return newest();
+        double b = slopePerSample();
+        double a = (sumY - b * sumX()) / count;
+        return (float)(a + b * (count - 1));
+    }
+
+    // Rising faster than noise can explain
+    bool rising() const {
+        float s = slope();
+        return s > 0.0f && s > TREND_MIN_T * slopeStdError();
+    }
+
+    // Seconds until the fitted line reaches `threshold`: 0 if already there,
+    // negative if no crossing is predicted (not rising significantly)
+    float secondsToReach(float threshold) const {
+        if (!ready()) return -1.0f;
+        float now = fittedNow();
+        if (now >= threshold) return 0.0f;
+        if (!rising()) return -1.0f;
+        return (threshold - now) / slope();
+    }
+
+private:
+    float values[Capacity];
+    uint16_t head;
+    uint16_t count;
+    float period;
+    double sumY;
+    double sumXY;
+    double sumYY;
+
+    double sumX() const {
+        return (double)count * (count - 1) / 2.0;
+    }
+
+    // n * Sxx - Sx^2, divided by n
+    double centredSxx() const {
+        double n = count;
+        return n * (n * n - 1.0) / 12.0;
+    }
+
+    double slopePerSample() const {
+        double n = count;
+        return (sumXY - sumX() * sumY / n) / centredSxx();
+    }
+};
+
+#endif // TREND_HISTORY_H
@@ -0,0 +1,151 @@
+#include "AdcCalibration.h"
+#include <esp_adc_cal.h>
+#include <Preferences.h>
+
+AdcCalibration adcCalibration;
+
+// Cache header stored next to the tables; the eFuse MAC ties the cache to
+// this chip so a flash image moved to another board is rebuilt
+struct AdcCalCacheHeader {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t tableCount;
+    uint8_t reserved;
+    uint64_t efuseMac;
+} __attribute__((packed));
+
+static const uint32_t ADC_CAL_MAGIC = 0x4C414341;   // "ACAL"
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+AdcCalibration::AdcCalibration()
+    : ready(false),
+      cached(false) {
+}
+
+adc_atten_t AdcCalibration::tableAtten(uint8_t index) {
+#if ADC_CAL_ALL_ATTENUATIONS
+    return (adc_atten_t)index;
+#else
+    return ADC_ATTEN_DB_11;
+#endif
+}
+
+int8_t AdcCalibration::tableIndex(adc_atten_t atten) {
+#if ADC_CAL_ALL_ATTENUATIONS
+    return (atten < ADC_ATTEN_MAX) ? (int8_t)atten : -1;
+#else
+    return (atten == ADC_ATTEN_DB_11) ? 0 : -1;
+#endif
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+bool AdcCalibration::begin() {
+    unsigned long start = micros();
+
+    cached = loadFromNvs();
+    if (!cached) {
+        buildTables();
+        saveToNvs();
+    }
+    ready = true;
+
+    Serial.printf("[ADC] Calibration table %s in %lu us\n",
+                  cached ? "loaded from NVS" : "built from eFuse", micros() - start);
+    return true;
+}
+
+void AdcCalibration::buildTables() {
+    for (uint8_t t = 0; t < kTableCount; t++) {
+        esp_adc_cal_characteristics_t chars;
+        esp_adc_cal_characterize(ADC_UNIT_1, tableAtten(t), ADC_WIDTH_BIT_12, ADC_CAL_DEFAULT_VREF, &chars);
+
+        for (uint16_t raw = 0; raw < ADC_CAL_TABLE_SIZE; raw++) {
+            tables[t][raw] = (uint16_t)esp_adc_cal_raw_to_voltage(raw, &chars);
+        }
+    }
+}
+
+// ============================================================================
+// NVS CACHE
+// ============================================================================
+bool AdcCalibration::loadFromNvs() {
+    Preferences prefs;
+    if (!prefs.begin(ADC_CAL_NVS_NAMESPACE, true)) {   // read-only
+        return false;
+    }
+
+    AdcCalCacheHeader header;
+    bool valid = prefs.getBytes("hdr", &header, sizeof(header)) == sizeof(header) &&
+                 header.magic == ADC_CAL_MAGIC &&
+                 header.version == ADC_CAL_FORMAT_VERSION &&
+                 header.tableCount == kTableCount &&
+                 header.efuseMac == ESP.getEfuseMac();
+
+    for (uint8_t t = 0; valid && t < kTableCount; t++) {
+        char key[8];
+        snprintf(key, sizeof(key), "lut%d", t);
+        valid = prefs.getBytes(key, tables[t], sizeof(tables[t])) == sizeof(tables[t]);
+    }
+
+    prefs.end();
+    return valid;
+}
+
+void AdcCalibration::saveToNvs() {
+    Preferences prefs;
+    if (!prefs.begin(ADC_CAL_NVS_NAMESPACE, false)) {  // writeable
+        Serial.println("[ADC] Calibration cache write failed");
+        return;
+    }
+
+    // Invalidate first, so a partial write is never taken as valid
+    prefs.remove("hdr");
+
+    bool ok = true;
+    for (uint8_t t = 0; ok && t < kTableCount; t++) {
+        char key[8];
+        snprintf(key, sizeof(key), "lut%d", t);
+        ok = prefs.putBytes(key, tables[t], sizeof(tables[t])) == sizeof(tables[t]);
+    }
+
+    AdcCalCacheHeader header;
+    header.magic = ADC_CAL_MAGIC;
+    header.version = ADC_CAL_FORMAT_VERSION;
+    header.tableCount = kTableCount;
+    header.reserved = 0;
+    header.efuseMac = ESP.getEfuseMac();
+    if (ok) {
+        ok = prefs.putBytes("hdr", &header, sizeof(header)) == sizeof(header);
+    }
+
+    if (!ok) {
+        Serial.println("[ADC] Calibration cache does not fit in NVS, rebuilding every boot");
+    }
+    prefs.end();
+}
+
+// ============================================================================
+// LOOKUP
+// ============================================================================
+bool AdcCalibration::isReady() const {
+    return ready;
+}
+
+bool AdcCalibration::loadedFromCache() const {
+    return cached;
+}
+
+uint16_t AdcCalibration::toMilliVolts(uint16_t raw, adc_atten_t atten) const {
+    if (raw >= ADC_CAL_TABLE_SIZE) raw = ADC_CAL_TABLE_SIZE - 1;
+
+    int8_t index = tableIndex(atten);
+    if (!ready || index < 0) {
+        // No table for this attenuation - nominal 0-3300 mV linear estimate
+        return (uint16_t)(((uint32_t)raw * 3300UL) / (ADC_CAL_TABLE_SIZE - 1));
+    }
+    return tables[index][raw];
+}
@@ -0,0 +1,180 @@
+#include "AdcSampler.h"
+#include "AdcCalibration.h"
+#include "Config.h"
+#include <driver/adc.h>
+
+AdcSampler adcSampler;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+AdcSampler::AdcSampler()
+    : sampleSink(NULL),
+      sampleSinkCtx(NULL),
+      running(false),
+      overflowCount(0) {
+    for (int i = 0; i < 8; i++) {
+        channelToSlot[i] = 0xFF;
+    }
+}
+
+int AdcSampler::slotPin(uint8_t slot) {
+    if (slot < ADC_SLOT_MQ2) return IRActiveLayout::pin(slot);
+    if (slot == ADC_SLOT_MQ2) return MQ2PIN;
+    return -1;
+}
+
+// ============================================================================
+// INITIALIZATION
+// Every pin must live on ADC1 (continuous mode on ESP32 cannot scan ADC2)
+// ============================================================================
+bool AdcSampler::begin() {
+    adc_digi_pattern_config_t pattern[ADC_NUM_SLOTS] = {};
+    uint32_t channelMask = 0;
+
+    for (uint8_t slot = 0; slot < ADC_NUM_SLOTS; slot++) {
+        int8_t channel = digitalPinToAnalogChannel(slotPin(slot));
+        if (channel < 0 || channel >= 8) {
+            Serial.printf("[ADC] GPIO%d is not an ADC1 pin, DMA sampling disabled\n", slotPin(slot));
+            return false;
+        }
+        channelToSlot[channel] = slot;
+        channelMask |= (1UL << channel);
+
+        pattern[slot].atten = ADC_ATTEN_DB_11;
+        pattern[slot].channel = channel;
+        pattern[slot].unit = 0;                 // ADC1
+        pattern[slot].bit_width = SOC_ADC_DIGI_MAX_BITWIDTH;
+    }
+
+    adc_digi_init_config_t initConfig = {};
+    initConfig.max_store_buf_size = ADC_DMA_FRAME_BYTES * 4;
+    initConfig.conv_num_each_intr = ADC_DMA_FRAME_BYTES;
+    initConfig.adc1_chan_mask = channelMask;
+    initConfig.adc2_chan_mask = 0;
+    if (adc_digi_initialize(&initConfig) != ESP_OK) {
+        Serial.println("[ADC] adc_digi_initialize failed, falling back to analogRead()");
+        return false;
+    }
+
+    adc_digi_configuration_t digiConfig = {};
+    digiConfig.conv_limit_en = true;            // Required on the original ESP32
+    digiConfig.conv_limit_num = 250;
+    digiConfig.pattern_num = ADC_NUM_SLOTS;
+    digiConfig.adc_pattern = pattern;
+    digiConfig.sample_freq_hz = ADC_SAMPLE_FREQ_HZ;
+    digiConfig.conv_mode = ADC_CONV_SINGLE_UNIT_1;
+    digiConfig.format = ADC_DIGI_OUTPUT_FORMAT_TYPE1;
+    if (adc_digi_controller_configure(&digiConfig) != ESP_OK) {
+        Serial.println("[ADC] adc_digi_controller_configure failed, falling back to analogRead()");
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    if (xTaskCreate(drainTask, "adc_drain", ADC_DRAIN_TASK_STACK, this,
+                    ADC_DRAIN_TASK_PRIORITY, NULL) != pdPASS) {
+        Serial.println("[ADC] Cannot create drain task, falling back to analogRead()");
+        adc_digi_deinitialize();
+        return false;
+    }
+
+    adc_digi_start();
+    running = true;
+
+    Serial.printf("[ADC] Continuous mode: %d slots @ %d Hz total, ring %d samples/slot\n",
+                  ADC_NUM_SLOTS, ADC_SAMPLE_FREQ_HZ, ADC_RING_CAPACITY);
+    return true;
+}
+
+// ============================================================================
+// DRAIN TASK
+// Blocks on the DMA pool and sorts each conversion into its slot ring
+// ============================================================================
+void AdcSampler::drainTask(void* arg) {
+    AdcSampler* self = static_cast<AdcSampler*>(arg);
+    uint8_t frame[ADC_DMA_FRAME_BYTES];
+
+    for (;;) {
+        uint32_t length = 0;
+        esp_err_t err = adc_digi_read_bytes(frame, sizeof(frame), &length, ADC_MAX_DELAY);
+
+        if (err == ESP_ERR_INVALID_STATE) {
+            // Driver pool was full and old data was dropped; what we got is still valid
+            self->overflowCount++;
+        } else if (err != ESP_OK) {
+            continue;
+        }
+
+        for (uint32_t i = 0; i + SOC_ADC_DIGI_RESULT_BYTES <= length; i += SOC_ADC_DIGI_RESULT_BYTES) {
+            const adc_digi_output_data_t* out = (const adc_digi_output_data_t*)&frame[i];
+            uint8_t channel = out->type1.channel;
+            if (channel >= 8) continue;
+
+            uint8_t slot = self->channelToSlot[channel];
+            if (slot < ADC_NUM_SLOTS) {
+                self->rings[slot].push(out->type1.data);
+
+                AdcSampleSink sink = self->sampleSink;
+                if (sink) sink(slot, out->type1.data, self->sampleSinkCtx);
+            }
+        }
+    }
+}
+
+// ============================================================================
+// READERS
+// ============================================================================
+bool AdcSampler::isRunning() const {
+    return running;
+}
+
+uint16_t AdcSampler::averageRaw(uint8_t slot, uint16_t window) const {
+    if (slot >= ADC_NUM_SLOTS || window == 0) return 0;
+    if (!running) return readBlocking(slot, window);
+
+    uint32_t sum = 0;
+    uint16_t count = rings[slot].sumNewest(window, sum);
+    return (count == 0) ? 0 : (uint16_t)(sum / count);
+}
+
+uint16_t AdcSampler::readWindow(uint8_t slot, uint16_t* out, uint16_t count) const {
+    if (slot >= ADC_NUM_SLOTS) return 0;
+    if (running) return rings[slot].copyNewest(count, out);
+
+    int pin = slotPin(slot);
+    for (uint16_t i = 0; i < count; i++) {
+        out[i] = analogRead(pin);
+    }
+    return count;
+}
+
+uint16_t AdcSampler::averageMilliVolts(uint8_t slot, uint16_t window) const {
+    // Translate only the averaged code, not every sample
+    return rawToMilliVolts(averageRaw(slot, window));
+}
+
+uint16_t AdcSampler::rawToMilliVolts(uint16_t raw) const {
+    return adcCalibration.toMilliVolts(raw);
+}
+
+void AdcSampler::setSampleSink(AdcSampleSink sink, void* ctx) {
+    sampleSinkCtx = ctx;
+    sampleSink = sink;
+}
+
+uint32_t AdcSampler::getOverflowCount() const {
+    return overflowCount;
+}
+
+// ============================================================================
+// FALLBACK when continuous mode is not available (old busy-wait behaviour)
+// ============================================================================
+uint16_t AdcSampler::readBlocking(uint8_t slot, uint16_t window) const {
+    int pin = slotPin(slot);
+    uint32_t total = 0;
+    for (uint16_t i = 0; i < window; i++) {
+        total += analogRead(pin);
+    }
+    return (uint16_t)(total / window);
+}
+
@@ -0,0 +1,225 @@
+#include "AlarmRules.h"
+
+#if defined(BLYNK_USE_LITTLEFS)
+#include <LittleFS.h>
+#define RULES_FS LittleFS
+#endif
+
+static RuleProgram activeRules;
+static float lastInputs[RULE_NUM_INPUTS];
+
+static uint8_t uploadBuffer[RULE_MAX_IMAGE];
+static size_t uploadLength = 0;
+static bool uploadOverflow = false;
+static AlarmRulesChangeFn changeHandler = NULL;
+
+// ============================================================================
+// HEX DECODING (whitespace ignored)
+// ============================================================================
+static int hexNibble(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// Append decoded bytes to buf; false on a bad digit, odd length or overflow
+static bool decodeHex(const char* hex, uint8_t* buf, size_t& length, size_t capacity) {
+    int high = -1;
+    for (; *hex; hex++) {
+        if (*hex == ' ' || *hex == '\t' || *hex == '\r' || *hex == '\n') continue;
+        int nibble = hexNibble(*hex);
+        if (nibble < 0) return false;
+        if (high < 0) {
+            high = nibble;
+            continue;
+        }
+        if (length >= capacity) return false;
+        buf[length++] = (uint8_t)((high << 4) | nibble);
+        high = -1;
+    }
+    return high < 0;
+}
+
+// ============================================================================
+// ACTIVATION AND STORAGE
+// ============================================================================
+static bool saveRulesFile(const uint8_t* image, size_t length) {
+#ifdef RULES_FS
+    File f = RULES_FS.open(ALARM_RULES_PATH, "w");
+    if (!f) return false;
+    bool ok = f.write(image, length) == length;
+    f.close();
+    return ok;
+#else
+    return false;
+#endif
+}
+
+static bool activate(const uint8_t* image, size_t length, bool persist) {
+    const char* error = NULL;
+    if (!activeRules.load(image, length, &error)) {
+        Serial.printf("[RULES] Rejected %u byte image: %s\n", (unsigned)length, error);
+        return false;
+    }
+    uint16_t checksum = ruleFletcher16(image, length - 2);
+    Serial.printf("[RULES] Active: %u byte image (checksum %04x), Bahaya/Waspada from rules\n",
+                  (unsigned)length, checksum);
+    if (changeHandler) changeHandler(length, checksum);
+
+    if (persist && !saveRulesFile(image, length)) {
+        Serial.println("[RULES] Could not save " ALARM_RULES_PATH ", rules last until reboot");
+    }
+    return true;
+}
+
+void setAlarmRulesChangeHandler(AlarmRulesChangeFn handler) {
+    changeHandler = handler;
+}
+
+bool reloadAlarmRules() {
+#ifdef RULES_FS
+    if (!RULES_FS.exists(ALARM_RULES_PATH)) {
+        Serial.println("[RULES] No " ALARM_RULES_PATH ", using built-in rules");
+        return false;
+    }
+    File f = RULES_FS.open(ALARM_RULES_PATH, "r");
+    if (!f) return false;
+
+    uint8_t image[RULE_MAX_IMAGE];
+    size_t length = f.read(image, sizeof(image));
+    bool tooLong = f.available() > 0;
+    f.close();
+    if (tooLong) {
+        Serial.println("[RULES] " ALARM_RULES_PATH " larger than RULE_MAX_IMAGE, using built-in rules");
+        return false;
+    }
+    return activate(image, length, false);
+#else
+    Serial.println("[RULES] No filesystem, using built-in rules");
+    return false;
+#endif
+}
+
+void initAlarmRules() {
+    reloadAlarmRules();
+}
+
+bool loadAlarmRulesHex(const char* hex) {
+    uint8_t image[RULE_MAX_IMAGE];
+    size_t length = 0;
+    if (!decodeHex(hex, image, length, sizeof(image))) {
+        Serial.println("[RULES] Bad hex or image larger than RULE_MAX_IMAGE");
+        return false;
+    }
+    return activate(image, length, true);
+}
+
+void beginAlarmRulesUpload() {
+    uploadLength = 0;
+    uploadOverflow = false;
+}
+
+bool appendAlarmRulesHex(const char* hex) {
+    if (!decodeHex(hex, uploadBuffer, uploadLength, sizeof(uploadBuffer))) {
+        uploadOverflow = true;
+        return false;
+    }
+    return true;
+}
+
+bool commitAlarmRulesUpload() {
+    bool ok = !uploadOverflow && activate(uploadBuffer, uploadLength, true);
+    if (uploadOverflow) Serial.println("[RULES] Upload had a bad chunk, start again with \"rules begin\"");
+    beginAlarmRulesUpload();
+    return ok;
+}
+
+void clearAlarmRules() {
+    activeRules.clear();
+#ifdef RULES_FS
+    RULES_FS.remove(ALARM_RULES_PATH);
+#endif
+    Serial.println("[RULES] Cleared, using built-in rules");
+    if (changeHandler) changeHandler(0, 0);
+}
+
+bool isAlarmRulesLoaded() {
+    return activeRules.isLoaded();
+}
+
+// ============================================================================
+// EVALUATION
+// ============================================================================
+bool evaluateAlarmRules(const float* inputs, bool& danger, bool& warning) {
+    if (!activeRules.isLoaded()) return false;
+    memcpy(lastInputs, inputs, sizeof(lastInputs));
+    danger = activeRules.isTrue(RULE_OUT_BAHAYA, inputs);
+    warning = activeRules.isTrue(RULE_OUT_WASPADA, inputs);
+    return true;
+}
+
+void benchAlarmRules(Print& out, uint32_t runs) {
+    if (!activeRules.isLoaded()) {
+        out.printf(" no rules loaded\n");
+        return;
+    }
+    if (runs == 0) runs = ALARM_RULES_BENCH_RUNS;
+
+    volatile float sink = 0.0f;
+    unsigned long start = micros();
+    for (uint32_t i = 0; i < runs; i++) {
+        sink = sink + activeRules.evaluate(RULE_OUT_BAHAYA, lastInputs) + activeRules.evaluate(RULE_OUT_WASPADA, lastInputs);
+    }
+    unsigned long elapsed = micros() - start;
+
+    uint8_t bahayaLength, waspadaLength;
+    activeRules.code(RULE_OUT_BAHAYA, bahayaLength);
+    activeRules.code(RULE_OUT_WASPADA, waspadaLength);
+    out.printf(" %lu runs in %lu us: %.2f us per tick (both rules, %d + %d bytes)\n",
+               (unsigned long)runs, elapsed, (float)elapsed / runs, bahayaLength, waspadaLength);
+}
+
+// ============================================================================
+// DISASSEMBLY
+// ============================================================================
+static void printCode(Print& out, const char* name, const uint8_t* code, uint8_t length) {
+    out.printf(" %s (%d bytes):\n", name, length);
+    for (uint8_t pc = 0; pc < length;) {
+        uint8_t op = code[pc];
+        uint8_t pops, pushes, operand;
+        RuleProgram::opShape(op, pops, pushes, operand);
+
+        if (op == RULE_OP_CONST) {
+            float value;
+            memcpy(&value, &code[pc + 1], sizeof(value));
+            out.printf("  %3d  CONST %g\n", pc, value);
+        } else if (op == RULE_OP_INPUT) {
+            out.printf("  %3d  INPUT %s\n", pc, ruleInputName(code[pc + 1]));
+        } else {
+            out.printf("  %3d  %s\n", pc, ruleOpName(op));
+        }
+        pc += 1 + operand;
+    }
+}
+
+void printAlarmRules(Print& out) {
+    if (!activeRules.isLoaded()) {
+        out.printf(" built-in rules (no image loaded)\n");
+        return;
+    }
+    out.printf(" rule image %u bytes, checksum %04x\n", (unsigned)activeRules.size(),
+               ruleFletcher16(activeRules.data(), activeRules.size() - 2));
+
+    uint8_t length;
+    const uint8_t* code = activeRules.code(RULE_OUT_BAHAYA, length);
+    printCode(out, "bahaya", code, length);
+    code = activeRules.code(RULE_OUT_WASPADA, length);
+    printCode(out, "waspada", code, length);
+
+    out.printf(" last inputs:");
+    for (int i = 0; i < RULE_NUM_INPUTS; i++) {
+        out.printf("%s %s=%g", (i % 6 == 0) ? "\n  " : "", ruleInputName(i), lastInputs[i]);
+    }
+    out.printf("\n");
+}
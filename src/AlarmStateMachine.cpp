@@ -0,0 +1,122 @@
+#include "AlarmStateMachine.h"
+
+// ============================================================================
+// HYSTERESIS
+// ============================================================================
+HysteresisSwitch::HysteresisSwitch(float enter, float exit)
+    : enter(enter),
+      exit(exit),
+      on(false) {
+}
+
+bool HysteresisSwitch::update(float value) {
+    if (!on && value > enter) {
+        on = true;
+    } else if (on && value < exit) {
+        on = false;
+    }
+    return on;
+}
+
+bool HysteresisSwitch::isOn() const {
+    return on;
+}
+
+void HysteresisSwitch::reset() {
+    on = false;
+}
+
+// ============================================================================
+// STATE MACHINE
+// ============================================================================
+FireAlarm::FireAlarm()
+    : state(FIRE_AMAN),
+      lastRequest(FIRE_AMAN),
+      stateSince(0),
+      requestSince(0),
+      lastDemand(0),
+      acknowledged(false) {
+    resetCounters();
+}
+
+bool FireAlarm::update(FireLevel requested, unsigned long now) {
+    if (requested != lastRequest) {
+        lastRequest = requested;
+        requestSince = now;
+        requestChanges++;
+    }
+    if (requested >= state) lastDemand = now;
+
+    if (requested > state) {
+        unsigned long confirm = (requested == FIRE_BAHAYA) ? ALARM_BAHAYA_CONFIRM_MS : ALARM_WASPADA_CONFIRM_MS;
+        if (now - requestSince < confirm) return false;
+        enter(requested, now);
+        return true;
+    }
+
+    if (requested < state) {
+        if (isLatched()) return false;
+        unsigned long dwell = (state == FIRE_BAHAYA) ? ALARM_BAHAYA_DWELL_MS : ALARM_WASPADA_DWELL_MS;
+        if (now - lastDemand < dwell) return false;
+        enter(requested, now);
+        return true;
+    }
+    return false;
+}
+
+void FireAlarm::enter(FireLevel next, unsigned long now) {
+    transitions[state][next]++;
+    state = next;
+    stateSince = now;
+    lastDemand = now;
+    if (next == FIRE_BAHAYA) acknowledged = false;
+}
+
+FireLevel FireAlarm::getState() const {
+    return state;
+}
+
+FireLevel FireAlarm::getRequest() const {
+    return lastRequest;
+}
+
+unsigned long FireAlarm::getTimeInState(unsigned long now) const {
+    return now - stateSince;
+}
+
+bool FireAlarm::isLatched() const {
+    return ALARM_BAHAYA_LATCH && state == FIRE_BAHAYA && !acknowledged;
+}
+
+bool FireAlarm::acknowledge() {
+    if (state != FIRE_BAHAYA) return false;
+    acknowledged = true;
+    return true;
+}
+
+uint32_t FireAlarm::getTransitions() const {
+    uint32_t total = 0;
+    for (int from = 0; from < 3; from++) {
+        for (int to = 0; to < 3; to++) {
+            total += transitions[from][to];
+        }
+    }
+    return total;
+}
+
+uint32_t FireAlarm::getTransitionCount(FireLevel from, FireLevel to) const {
+    return (from <= FIRE_BAHAYA && to <= FIRE_BAHAYA) ? transitions[from][to] : 0;
+}
+
+uint32_t FireAlarm::getRequestChanges() const {
+    return requestChanges;
+}
+
+void FireAlarm::resetCounters() {
+    for (int from = 0; from < 3; from++) {
+        for (int to = 0; to < 3; to++) {
+            transitions[from][to] = 0;
+        }
+    }
+    requestChanges = 0;
+}
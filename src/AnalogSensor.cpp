@@ -1,60 +1,176 @@
 #include "AnalogSensor.h"
+#include "AdcSampler.h"
+#include "SensorTask.h"
 #include "Config.h"
+#include "MQ2Table.h"
 #include <Arduino.h>
-#include <MQUnifiedsensor.h>
+#include <esp_timer.h>
 
-// MQ2 Sensor Object Definition
-MQUnifiedsensor MQ2("ESP32", MQ2_VOLTAGE_RESOLUTION, MQ2_ADC_BIT_RESOLUTION, MQ2PIN, "MQ-2");
+// Tabel ADC -> PPM (rumus MQUnifiedsensor dihitung sekali saat init)
+MQ2PPMTable mq2Table;
 
-int readAnalogDebounced(int pin) {
-    long total = 0;
-    for (int i = 0; i < 10; i++) { // Dikurangi ke 10 samples agar lebih cepat
-        total += analogRead(pin);
-        delayMicroseconds(500);   // Dikurangi ke 500us
+// IR pakai Hampel: satu glitch ADC tidak lagi bisa melewati THRESHOLD_FLAME
+// (jumlah kanal IR mengikuti IRActiveLayout, MQ-2 tetap rata-rata)
+struct SlotFilterModes {
+    SampleFilterMode mode[ADC_NUM_SLOTS];
+
+    SlotFilterModes() {
+        for (int i = 0; i < ADC_NUM_SLOTS; i++) {
+            mode[i] = (i < IR_NUM_CHANNELS) ? SAMPLE_FILTER_HAMPEL : SAMPLE_FILTER_MEAN;
+        }
     }
-    return total / 10;
+};
+static SlotFilterModes slotFilter;
+
+void setAnalogFilterMode(uint8_t slot, SampleFilterMode mode) {
+    if (slot < ADC_NUM_SLOTS) slotFilter.mode[slot] = mode;
 }
 
-void initMQ2Sensor() {
-    // Konfigurasi metode regresi untuk deteksi asap
-    // Rumus: PPM = a * ratio^b
-    MQ2.setRegressionMethod(1);
-    MQ2.setA(MQ2_A);
-    MQ2.setB(MQ2_B);
+SampleFilterMode getAnalogFilterMode(uint8_t slot) {
+    return (slot < ADC_NUM_SLOTS) ? slotFilter.mode[slot] : SAMPLE_FILTER_MEAN;
+}
 
-    // Inisialisasi sensor
-    MQ2.init();
+int readAnalogDebounced(uint8_t slot) {
+    SampleFilterMode mode = getAnalogFilterMode(slot);
+    if (mode == SAMPLE_FILTER_MEAN) {
+        // Rata-rata jendela terbaru dari ring buffer DMA (tanpa busy-wait)
+        return adcSampler.averageRaw(slot);
+    }
 
-    // Set R0 dari hasil kalibrasi
-    MQ2.setR0(MQ2_R0);
+    uint16_t window[ANALOG_FILTER_WINDOW];
+    if (adcSampler.readWindow(slot, window, ANALOG_FILTER_WINDOW) < ANALOG_FILTER_WINDOW) {
+        return adcSampler.averageRaw(slot);    // Ring belum penuh sesaat setelah boot
+    }
 
-    Serial.println("[MQ2] Sensor initialized with MQUnifiedsensor library");
+    // Sorting network (tanpa std::sort), lihat MedianFilter.h
+    if (mode == SAMPLE_FILTER_MEDIAN) {
+        return medianOf<uint16_t, ANALOG_FILTER_WINDOW>(window);
+    }
+    return hampelMeanOf<uint16_t, ANALOG_FILTER_WINDOW>(window);
 }
 
-float getMQ2PPM() {
-    // Update sensor dan baca nilai PPM asap
-    MQ2.update();
-    float smokePPM = MQ2.readSensor();
+void initMQ2Sensor() {
+    pinMode(MQ2PIN, INPUT);
+
+    // Regresi PPM = a * ratio^b dengan R0 hasil kalibrasi, dihitung ke tabel
+    mq2Table.build();
 
-    // Validasi hasil (tidak boleh negatif)
-    return (smokePPM < 0) ? 0 : smokePPM;
+    Serial.printf("[MQ2] PPM table built (%d knots, step %d)\n", MQ2_TABLE_KNOTS, MQ2_TABLE_STEP);
+}
+
+float getMQ2PPM() {
+    // Satu lookup + interpolasi, tanpa pow() (hasil sudah dibatasi >= 0)
+    return mq2Table.lookup(readAnalogDebounced(ADC_SLOT_MQ2));
 }
 
 bool isFlameDetected() {
-    for (int i = 0; i < 5; i++) {
-        if (readAnalogDebounced(IR_PINS[i]) > THRESHOLD_FLAME) return true;
+    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+        if (readAnalogDebounced(i) > THRESHOLD_FLAME) return true;
     }
     return false;
 }
 
 int getIRAnalogValue() {
-    // Baca kelima sensor IR dan kembalikan nilai tertinggi
+    // Baca semua sensor IR dan kembalikan nilai tertinggi
     int maxValue = 0;
-    for (int i = 0; i < 5; i++) {
-        int value = readAnalogDebounced(IR_PINS[i]);
+    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+        int value = readAnalogDebounced(i);
         if (value > maxValue) {
             maxValue = value;
         }
     }
     return maxValue;
 }
+
+// Snapshot valid terakhir dari task sensor (hanya dipakai oleh loop())
+static FlameSnapshot lastFlame;
+static EnvSnapshot lastEnv;
+static bool haveFlame = false;
+static bool haveEnv = false;
+static uint32_t snapshotReadMisses = 0;
+
+uint32_t getSnapshotReadMisses() {
+    return snapshotReadMisses;
+}
+
+SensorFrame captureSensorFrame() {
+    SensorFrame frame;
+    frame.timestampUs = esp_timer_get_time();
+
+    // Satu kali baca per kanal, max & argmax dihitung di pass yang sama
+    frame.irMax = 0;
+    frame.irArgMax = 0;
+    for (int i = 0; i < SENSOR_FRAME_IR_CHANNELS; i++) {
+        frame.ir[i] = readAnalogDebounced(i);
+        if (frame.ir[i] > frame.irMax) {
+            frame.irMax = frame.ir[i];
+            frame.irArgMax = i;
+        }
+    }
+
+    // Keputusan api dari IRFlameSensor (baseline, voting spasial, verifikasi temporal).
+    // Jika seqlock kehabisan retry, pakai snapshot valid terakhir: api yang
+    // sedang aktif tidak boleh hilang hanya karena satu tick gagal baca.
+    FlameSnapshot flame;
+    if (readFlameSnapshot(flame)) {
+        lastFlame = flame;
+        haveFlame = true;
+    } else if (haveFlame) {
+        snapshotReadMisses++;
+    }
+
+    frame.irShiftLevel = 0;
+    if (haveFlame) {
+        frame.flameState = lastFlame.state;
+        frame.flameConfidence = lastFlame.confidence;
+        frame.modelClass = lastFlame.modelClass;
+        frame.modelFlame = lastFlame.modelProbability[FLAME_CLASS_FLAME];
+        frame.modelNuisance = lastFlame.modelProbability[FLAME_CLASS_NUISANCE];
+        for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+            if (lastFlame.channels[i].shiftLevel > frame.irShiftLevel) frame.irShiftLevel = lastFlame.channels[i].shiftLevel;
+        }
+    } else {
+        // Task sensor belum pernah publish
+        frame.flameState = FLAME_IDLE;
+        frame.flameConfidence = 0;
+        frame.modelClass = FLAME_CLASS_QUIET;
+        frame.modelFlame = 0;
+        frame.modelNuisance = 0;
+    }
+    frame.flameDetected = (frame.flameState == FLAME_DETECTED);
+
+    // Asap & suhu dari task sensor (MQ-2 tiap 100ms, DHT22 tiap 2s), sama: tahan nilai terakhir
+    EnvSnapshot env;
+    if (readEnvSnapshot(env)) {
+        lastEnv = env;
+        haveEnv = true;
+    } else if (haveEnv) {
+        snapshotReadMisses++;
+    }
+
+    if (haveEnv) {
+        frame.smokePPM = lastEnv.smokePPM;
+        frame.smokeShiftLevel = lastEnv.smokeShiftLevel;
+        frame.temperature = lastEnv.temperature;
+        frame.temperatureReads = lastEnv.temperatureReads;
+    } else {
+        frame.smokePPM = 0;
+        frame.smokeShiftLevel = 0;
+        frame.temperature = -999.0;
+        frame.temperatureReads = 0;
+    }
+    return frame;
+}
+
+void printSensorFrame(const SensorFrame& frame) {
+    static const char* const flameStateStr[] = {"IDLE", "POTENTIAL", "DETECTED", "AMBIENT"};
+
+    Serial.printf("[FRAME] t=%lldus IR:", (long long)frame.timestampUs);
+    for (int i = 0; i < SENSOR_FRAME_IR_CHANNELS; i++) {
+        Serial.printf(" %4d", frame.ir[i]);
+    }
+    Serial.printf(" | max=%d (ch%d) | Api: %s (%d%%) | Asap: %.1f PPM | Suhu: %.1f C\n",
+                  frame.irMax, frame.irArgMax,
+                  flameStateStr[frame.flameState], frame.flameConfidence,
+                  frame.smokePPM, frame.temperature);
+}
@@ -1,12 +1,156 @@
 #include "DHT22.h"
+#include "DHT22Decoder.h"
 #include "Config.h"
-#include <DHT.h>
+#include <Arduino.h>
+#include <driver/gpio.h>
+#include <driver/rmt.h>
+#include <esp_timer.h>
+#include <freertos/ringbuf.h>
 
-DHT dht(DHT22PIN, DHT22);
+enum DHTState {
+    DHT_IDLE,
+    DHT_START_LOW,      // Host menahan line low, esp_timer akan melepas
+    DHT_CAPTURING       // RMT merekam respon sensor
+};
 
-void setupDHT() { dht.begin(); }
+static volatile DHTState dhtState = DHT_IDLE;
+static bool dhtAvailable = false;
+static RingbufHandle_t dhtRingbuf = NULL;
+static esp_timer_handle_t dhtReleaseTimer = NULL;
+static unsigned long dhtCaptureStart = 0;
+
+static DHT22Reading dhtLast = {-999.0f, -999.0f};
+static unsigned long dhtLastValidTime = 0;
+static bool dhtHasReading = false;
+
+// Dipanggil esp_timer setelah DHT22_START_LOW_US: lepas line dan mulai rekam
+static void dhtReleaseLine(void* arg) {
+    gpio_set_level((gpio_num_t)DHT22PIN, 1);
+    rmt_rx_start(DHT22_RMT_CHANNEL, true);
+    dhtCaptureStart = millis();
+    dhtState = DHT_CAPTURING;
+}
+
+// Log kegagalan driver; DHT22 lalu dinonaktifkan (suhu tetap -999)
+static bool dhtCheck(esp_err_t err, const char* what) {
+    if (err == ESP_OK) return true;
+    Serial.printf("[DHT22] %s failed: %s, sensor disabled\n", what, esp_err_to_name(err));
+    return false;
+}
+
+bool setupDHT() {
+    // Open-drain input/output: kita bisa menarik low dan RMT tetap membaca pin
+    gpio_set_direction((gpio_num_t)DHT22PIN, GPIO_MODE_INPUT_OUTPUT_OD);
+    gpio_set_pull_mode((gpio_num_t)DHT22PIN, GPIO_PULLUP_ONLY);
+    gpio_set_level((gpio_num_t)DHT22PIN, 1);
+
+    rmt_config_t config = RMT_DEFAULT_CONFIG_RX((gpio_num_t)DHT22PIN, DHT22_RMT_CHANNEL);
+    config.clk_div = 80;                            // 1 tick = 1us
+    config.rx_config.filter_en = true;
+    config.rx_config.filter_ticks_thresh = 100;     // Abaikan glitch < 1.25us (APB ticks)
+    config.rx_config.idle_threshold = 200;          // 200us tanpa edge = frame selesai
+    if (!dhtCheck(rmt_config(&config), "rmt_config")) return false;
+    if (!dhtCheck(rmt_driver_install(DHT22_RMT_CHANNEL, 1024, 0), "rmt_driver_install")) return false;
+    if (!dhtCheck(rmt_get_ringbuf_handle(DHT22_RMT_CHANNEL, &dhtRingbuf), "rmt_get_ringbuf_handle") ||
+        dhtRingbuf == NULL) {
+        rmt_driver_uninstall(DHT22_RMT_CHANNEL);
+        dhtRingbuf = NULL;
+        return false;
+    }
+
+    // RMT_DEFAULT_CONFIG_RX mengatur ulang GPIO, pastikan tetap open-drain
+    gpio_set_direction((gpio_num_t)DHT22PIN, GPIO_MODE_INPUT_OUTPUT_OD);
+
+    esp_timer_create_args_t args = {};
+    args.callback = dhtReleaseLine;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "dht_release";
+    if (!dhtCheck(esp_timer_create(&args, &dhtReleaseTimer), "esp_timer_create")) {
+        rmt_driver_uninstall(DHT22_RMT_CHANNEL);
+        dhtRingbuf = NULL;
+        return false;
+    }
+
+    dhtAvailable = true;
+    Serial.println("[DHT22] RMT capture driver ready");
+    return true;
+}
+
+bool isDHTAvailable() {
+    return dhtAvailable;
+}
+
+void startDHTReading() {
+    if (dhtState != DHT_IDLE || !dhtAvailable) return;
+
+    // Buang sisa frame dari transaksi yang timeout
+    size_t size = 0;
+    while (void* stale = xRingbufferReceive(dhtRingbuf, &size, 0)) {
+        vRingbufferReturnItem(dhtRingbuf, stale);
+    }
+
+    dhtState = DHT_START_LOW;
+    gpio_set_level((gpio_num_t)DHT22PIN, 0);
+    if (esp_timer_start_once(dhtReleaseTimer, DHT22_START_LOW_US) != ESP_OK) {
+        gpio_set_level((gpio_num_t)DHT22PIN, 1);       // Coba lagi di periode berikutnya
+        dhtState = DHT_IDLE;
+    }
+}
+
+static void dhtFinishCapture(rmt_item32_t* items, size_t count) {
+    // Ubah item RMT (dua level per item) menjadi deret pulsa untuk decoder
+    DHT22Pulse pulses[2 * (DHT22_BIT_COUNT + 4)];
+    size_t pulseCount = 0;
+    for (size_t i = 0; i < count && pulseCount + 2 <= sizeof(pulses) / sizeof(pulses[0]); i++) {
+        if (items[i].duration0 == 0) break;
+        pulses[pulseCount].level = items[i].level0;
+        pulses[pulseCount].widthUs = items[i].duration0;
+        pulseCount++;
+        if (items[i].duration1 == 0) break;
+        pulses[pulseCount].level = items[i].level1;
+        pulses[pulseCount].widthUs = items[i].duration1;
+        pulseCount++;
+    }
+
+    DHT22Reading reading;
+    DHT22DecodeResult result = dht22DecodePulses(pulses, pulseCount, reading);
+    if (result == DHT22_DECODE_OK) {
+        dhtLast = reading;
+        dhtLastValidTime = millis();
+        dhtHasReading = true;
+    } else {
+        Serial.printf("[DHT22] Decode error %d (%u pulses)\n", result, (unsigned)pulseCount);
+    }
+}
+
+bool pollDHT() {
+    if (dhtState == DHT_IDLE) return true;
+    if (dhtState != DHT_CAPTURING) return false;
+
+    size_t size = 0;
+    rmt_item32_t* items = (rmt_item32_t*)xRingbufferReceive(dhtRingbuf, &size, 0);
+    if (items) {
+        dhtFinishCapture(items, size / sizeof(rmt_item32_t));
+        vRingbufferReturnItem(dhtRingbuf, items);
+    } else if (millis() - dhtCaptureStart < DHT22_CAPTURE_TIMEOUT_MS) {
+        return false;   // Frame belum selesai
+    } else {
+        Serial.println("[DHT22] No response from sensor");
+    }
+
+    rmt_rx_stop(DHT22_RMT_CHANNEL);
+    dhtState = DHT_IDLE;
+    return true;
+}
+
+static bool dhtReadingFresh() {
+    return dhtHasReading && (millis() - dhtLastValidTime) < DHT22_STALE_MS;
+}
 
 float readTemperatureSafe() {
-    float t = dht.readTemperature();
-    return isnan(t) ? -999.0 : t;
+    return dhtReadingFresh() ? dhtLast.temperature : -999.0;
+}
+
+float readHumiditySafe() {
+    return dhtReadingFresh() ? dhtLast.humidity : -999.0;
 }
@@ -0,0 +1,96 @@
+#include "FirDecimator.h"
+#include <math.h>
+#include <string.h>
+
+#if defined(ESP_PLATFORM) && defined(__has_include)
+#if __has_include(<dsps_dotprod.h>)
+#include <dsps_dotprod.h>
+#define FIR_USE_ESP_DSP 1
+#endif
+#endif
+
+// ============================================================================
+// DOT PRODUCT
+// The fallback mirrors dsps_dotprod_f32_ae32: one accumulator, inputs in
+// order, madd.s (a single rounding per tap) -> fmaf()
+// ============================================================================
+float firDotProduct(const float* a, const float* b, uint16_t length) {
+#ifdef FIR_USE_ESP_DSP
+    float result = 0.0f;
+    dsps_dotprod_f32(a, b, &result, length);
+    return result;
+#else
+    float acc = 0.0f;
+    for (uint16_t i = 0; i < length; i++) {
+        acc = fmaf(a[i], b[i], acc);
+    }
+    return acc;
+#endif
+}
+
+// ============================================================================
+// FILTER DESIGN
+// ============================================================================
+void firDesignLowPass(float* coeffs, uint16_t taps, float cutoff) {
+    if (taps == 0) return;
+
+    double middle = (taps - 1) / 2.0;
+    double sum = 0.0;
+    for (uint16_t i = 0; i < taps; i++) {
+        double t = i - middle;
+        double sinc = (t == 0.0) ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * t) / (M_PI * t);
+        double window = (taps > 1) ? 0.54 - 0.46 * cos(2.0 * M_PI * i / (taps - 1)) : 1.0;
+        coeffs[i] = (float)(sinc * window);
+        sum += coeffs[i];
+    }
+
+    // Unity DC gain so the baseline keeps its millivolt scale
+    for (uint16_t i = 0; i < taps; i++) {
+        coeffs[i] = (float)(coeffs[i] / sum);
+    }
+}
+
+// ============================================================================
+// DECIMATOR
+// ============================================================================
+FirDecimator::FirDecimator()
+    : coeffs(NULL),
+      taps(0),
+      pos(0),
+      decimation(1),
+      phase(0) {
+    memset(delay, 0, sizeof(delay));
+}
+
+bool FirDecimator::init(const float* coeffs, uint16_t taps, uint8_t decimation) {
+    if (coeffs == NULL || taps == 0 || taps > FIR_MAX_TAPS || decimation == 0) return false;
+
+    this->coeffs = coeffs;
+    this->taps = taps;
+    this->decimation = decimation;
+    reset();
+    return true;
+}
+
+void FirDecimator::reset(float value) {
+    for (uint16_t i = 0; i < 2 * FIR_MAX_TAPS; i++) {
+        delay[i] = value;
+    }
+    pos = 0;
+    phase = 0;
+}
+
+bool FirDecimator::push(float input, float& output) {
+    if (taps == 0) return false;
+
+    // Newest sample first: delay[pos .. pos + taps - 1] is x[n], x[n-1], ...
+    pos = (pos == 0) ? taps - 1 : pos - 1;
+    delay[pos] = input;
+    delay[pos + taps] = input;
+
+    if (++phase < decimation) return false;
+    phase = 0;
+
+    output = firDotProduct(coeffs, &delay[pos], taps);
+    return true;
+}
@@ -0,0 +1,117 @@
+#include "FireAlarm.h"
+#include "SmokeBaseline.h"
+#include "FireTrend.h"
+#include "AlarmRules.h"
+#include "Config.h"
+
+FireAlarm fireAlarm;
+
+// ============================================================================
+// LOGGED STATE CHANGES
+// ============================================================================
+bool updateFireAlarm(FireLevel requested, unsigned long now) {
+    FireLevel previous = fireAlarm.getState();
+    unsigned long held = fireAlarm.getTimeInState(now);
+    if (!fireAlarm.update(requested, now)) return false;
+
+    Serial.printf("[ALARM] %s -> %s after %lu ms (request changes %lu, transitions %lu)\n",
+                  FireFusion::levelName(previous), FireFusion::levelName(fireAlarm.getState()), held,
+                  (unsigned long)fireAlarm.getRequestChanges(), (unsigned long)fireAlarm.getTransitions());
+    return true;
+}
+
+void acknowledgeFireAlarm() {
+    if (fireAlarm.acknowledge()) {
+        Serial.println("[ALARM] Bahaya acknowledged, clears once the sensors do");
+    } else {
+        Serial.println("[ALARM] Nothing to acknowledge");
+    }
+}
+
+// ============================================================================
+// REQUEST FROM A FRAME
+// ============================================================================
+static HysteresisSwitch smokeSwitch(0.0f, -ALARM_SMOKE_HYST_PPM);      // PPM above the threshold
+static HysteresisSwitch tempSwitch(THRESHOLD_TEMP, THRESHOLD_TEMP - ALARM_TEMP_HYST_C);
+static HysteresisSwitch waspadaSwitch(FUSION_WASPADA_SCORE, ALARM_WASPADA_EXIT_SCORE);
+static HysteresisSwitch bahayaSwitch(FUSION_BAHAYA_SCORE, ALARM_BAHAYA_EXIT_SCORE);
+
+// Input table of the rule VM (AlarmRules.h), same order as RuleInput
+static void fillRuleInputs(float* inputs, const SensorFrame& frame, const AlarmRequest& request, float score) {
+    inputs[RULE_IN_FLAME] = frame.flameDetected;
+    inputs[RULE_IN_FLAME_STATE] = frame.flameState;
+    inputs[RULE_IN_FLAME_CONFIDENCE] = frame.flameConfidence;
+    inputs[RULE_IN_IR_MAX] = frame.irMax;
+    inputs[RULE_IN_IR_SHIFT] = frame.irShiftLevel;
+    inputs[RULE_IN_SMOKE] = frame.smokePPM;
+    inputs[RULE_IN_SMOKE_THRESHOLD] = getSmokeThreshold();
+    inputs[RULE_IN_SMOKE_BACKGROUND] = getSmokeBackground();
+    inputs[RULE_IN_SMOKE_SLOPE] = getTrendSlope(TREND_SMOKE);
+    inputs[RULE_IN_SMOKE_SHIFT] = frame.smokeShiftLevel;
+    inputs[RULE_IN_SMOKE_HIGH] = request.smokeHigh;
+    inputs[RULE_IN_TEMP] = frame.temperature;
+    inputs[RULE_IN_TEMP_SLOPE] = getTrendSlope(TREND_TEMPERATURE);
+    inputs[RULE_IN_TEMP_HIGH] = request.tempHigh;
+    inputs[RULE_IN_SCORE] = score;
+    inputs[RULE_IN_SCORE_WASPADA] = waspadaSwitch.isOn();
+    inputs[RULE_IN_SCORE_BAHAYA] = bahayaSwitch.isOn();
+    inputs[RULE_IN_PREALARM] = request.preAlarm;
+    inputs[RULE_IN_PREALARM_ETA] = request.preAlarm ? getPreAlarmEta() : -1.0f;
+    inputs[RULE_IN_MODEL_FLAME] = frame.modelFlame;
+    inputs[RULE_IN_MODEL_NUISANCE] = frame.modelNuisance;
+}
+
+AlarmRequest requestFireAlarm(const SensorFrame& frame, bool preAlarm) {
+    AlarmRequest request;
+    request.smokeHigh = smokeSwitch.update(frame.smokePPM - getSmokeThreshold());
+    request.tempHigh = tempSwitch.update(frame.temperature);
+    request.preAlarm = preAlarm;
+
+    // Every switch runs each tick so a rule swap finds them in step
+    float score = fireFusion.getScore();
+    bahayaSwitch.update(score);
+    waspadaSwitch.update(score);
+
+    // Site rules from LittleFS replace the built-in expressions when loaded
+    bool danger = false, warning = false, fromRules = false;
+    if (isAlarmRulesLoaded()) {
+        float inputs[RULE_NUM_INPUTS];
+        fillRuleInputs(inputs, frame, request, score);
+        fromRules = evaluateAlarmRules(inputs, danger, warning);
+    }
+    if (fromRules) {
+        // Floor the site rules cannot override
+        if (frame.flameDetected || bahayaSwitch.isOn()) warning = true;
+    } else {
+#if FUSION_DECISION
+        danger = bahayaSwitch.isOn();
+        warning = waspadaSwitch.isOn() || preAlarm;
+#else
+        danger = frame.flameDetected || (request.tempHigh && request.smokeHigh);
+        warning = request.smokeHigh || request.tempHigh || preAlarm;
+#endif
+    }
+
+    request.level = danger ? FIRE_BAHAYA : (warning ? FIRE_WASPADA : FIRE_AMAN);
+    return request;
+}
+
+void printFireAlarm(Print& out) {
+    unsigned long now = millis();
+    out.printf(" state %s for %lu ms%s, request %s\n",
+               FireFusion::levelName(fireAlarm.getState()), fireAlarm.getTimeInState(now),
+               fireAlarm.isLatched() ? " (latched, \"alarm ack\")" : "",
+               FireFusion::levelName(fireAlarm.getRequest()));
+    out.printf(" request changes %lu, transitions %lu\n",
+               (unsigned long)fireAlarm.getRequestChanges(), (unsigned long)fireAlarm.getTransitions());
+    out.printf(" %-8s | %7s | %7s | %7s\n", "from\\to", "Aman", "Waspada", "Bahaya");
+    for (int from = 0; from < 3; from++) {
+        out.printf(" %-8s | %7lu | %7lu | %7lu\n", FireFusion::levelName((FireLevel)from),
+                   (unsigned long)fireAlarm.getTransitionCount((FireLevel)from, FIRE_AMAN),
+                   (unsigned long)fireAlarm.getTransitionCount((FireLevel)from, FIRE_WASPADA),
+                   (unsigned long)fireAlarm.getTransitionCount((FireLevel)from, FIRE_BAHAYA));
+    }
+    out.printf(" enter/exit: smoke thr/-%.0f PPM, temp %d/%.0f C, score %.0f/%.0f and %.0f/%.0f\n",
+               ALARM_SMOKE_HYST_PPM, THRESHOLD_TEMP, THRESHOLD_TEMP - ALARM_TEMP_HYST_C,
+               FUSION_WASPADA_SCORE, ALARM_WASPADA_EXIT_SCORE, FUSION_BAHAYA_SCORE, ALARM_BAHAYA_EXIT_SCORE);
+}
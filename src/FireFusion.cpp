@@ -0,0 +1,97 @@
+#include "FireFusion.h"
+#include "FireTrend.h"
+#include "SmokeBaseline.h"
+
+FireFusion fireFusion;
+static FusionEpisodeTracker episodes;
+static unsigned long lastFusionUpdate = 0;
+
+// ============================================================================
+// TIME-TO-ALARM COMPARISON
+// Episodes are timed by FusionEpisodeTracker (FusionScore.h) and logged
+// when they open and close
+// ============================================================================
+static void printEpisodeTimes(Print& out, const FusionEpisode& e) {
+    static const char* const ruleNames[] = {"fusion", "legacy"};
+    for (int rule = 0; rule < 2; rule++) {
+        out.printf("  %-6s  Waspada ", ruleNames[rule]);
+        if (e.firstMs[rule][0] < 0) out.printf("   never"); else out.printf("%+6ld ms", e.firstMs[rule][0]);
+        out.printf("  Bahaya ");
+        if (e.firstMs[rule][1] < 0) out.printf("   never\n"); else out.printf("%+6ld ms\n", e.firstMs[rule][1]);
+    }
+}
+
+static void compareWithLegacy(FireLevel fused, FireLevel legacy, unsigned long now) {
+    switch (episodes.update(fused, legacy, now)) {
+        case FUSION_EPISODE_STARTED:
+            Serial.printf("[FUSION] Episode start: fusion %s, legacy %s\n",
+                          FireFusion::levelName(fused), FireFusion::levelName(legacy));
+            break;
+        case FUSION_EPISODE_CLOSED:
+            Serial.printf("[FUSION] Episode over after %lu ms, time to alarm:\n", episodes.last().durationMs());
+            printEpisodeTimes(Serial, episodes.last());
+            break;
+        case FUSION_EPISODE_NONE:
+            break;
+    }
+}
+
+FireLevel evaluateFireFusion(const SensorFrame& frame, FireLevel legacy) {
+    unsigned long now = millis();
+    float dt = (lastFusionUpdate == 0) ? 0.0f : (now - lastFusionUpdate) / 1000.0f;
+    lastFusionUpdate = now;
+
+    FusionInput input;
+    input.flameState = frame.flameState;
+    input.flameConfidence = frame.flameConfidence;
+    input.smokePPM = frame.smokePPM;
+    input.smokeBackground = getSmokeBackground();
+    input.smokeThreshold = getSmokeThreshold();
+    input.smokeSlope = getTrendSlope(TREND_SMOKE);
+    input.temperature = frame.temperature;
+    input.temperatureSlope = getTrendSlope(TREND_TEMPERATURE);
+    input.irShiftLevel = frame.irShiftLevel;
+    input.smokeShiftLevel = frame.smokeShiftLevel;
+    input.modelNuisance = frame.modelNuisance;
+
+    FireLevel previous = fireFusion.getLevel();
+    FireLevel fused = fireFusion.update(input, dt);
+    if (fused != previous) {
+        Serial.printf("[FUSION] %s -> %s (score %.1f, legacy %s)\n",
+                      FireFusion::levelName(previous), FireFusion::levelName(fused),
+                      fireFusion.getScore(), FireFusion::levelName(legacy));
+    }
+
+#if FUSION_TRACE
+    // ms,flameState,confidence,smoke,smokeBg,smokeThr,smoke/s,temp,temp/s,irShift,smokeShift,nuisance,
+    // instant,score,fusion,legacy (read by tools/fusionreplay.cpp)
+    Serial.printf("[FTRACE] %lu,%d,%d,%.1f,%.1f,%.1f,%.3f,%.1f,%.3f,%.2f,%.2f,%d,%.1f,%.1f,%d,%d\n",
+                  now, frame.flameState, frame.flameConfidence,
+                  input.smokePPM, input.smokeBackground, input.smokeThreshold, input.smokeSlope,
+                  input.temperature, input.temperatureSlope, input.irShiftLevel, input.smokeShiftLevel,
+                  input.modelNuisance, fireFusion.getInstantScore(), fireFusion.getScore(), fused, legacy);
+#endif
+
+    compareWithLegacy(fused, legacy, now);
+    return fused;
+}
+
+void printFireFusion(Print& out) {
+    out.printf(" score %.1f (instant %.1f) -> %s, Waspada >= %.0f, Bahaya >= %.0f\n",
+               fireFusion.getScore(), fireFusion.getInstantScore(),
+               FireFusion::levelName(fireFusion.getLevel()), FUSION_WASPADA_SCORE, FUSION_BAHAYA_SCORE);
+    out.printf(" %-9s | weight | evidence | points\n", "input");
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) {
+        FusionEvidence which = (FusionEvidence)i;
+        out.printf(" %-9s | %6.1f | %8.2f | %6.1f\n", FireFusion::evidenceName(which),
+                   fireFusion.getWeight(which), fireFusion.getEvidence(which),
+                   fireFusion.getWeight(which) * fireFusion.getEvidence(which));
+    }
+    if (episodes.current().open) {
+        out.printf(" episode open for %lu ms:\n", (unsigned long)(millis() - episodes.current().startMs));
+        printEpisodeTimes(out, episodes.current());
+    } else if (episodes.getClosedCount() > 0) {
+        out.printf(" last episode:\n");
+        printEpisodeTimes(out, episodes.last());
+    }
+}
@@ -0,0 +1,123 @@
+#include "FireTrend.h"
+#include "Config.h"
+#include "SmokeBaseline.h"
+#include "SensorTask.h"
+
+// Temperature is sampled at the DHT22 rate, smoke every TREND_SAMPLE_MS
+static TrendHistory<TREND_HISTORY_SAMPLES> histories[TREND_NUM_QUANTITIES] = {
+    TrendHistory<TREND_HISTORY_SAMPLES>(SENSOR_DHT_PERIOD_MS / 1000.0f),
+    TrendHistory<TREND_HISTORY_SAMPLES>(TREND_SAMPLE_MS / 1000.0f)
+};
+
+// Smoke follows the adaptive threshold (SmokeBaseline.h), refreshed per sample
+static float thresholds[TREND_NUM_QUANTITIES] = {
+    THRESHOLD_TEMP, THRESHOLD_SMOKE
+};
+
+static const char* const quantityNames[TREND_NUM_QUANTITIES] = {
+    "temp", "smoke"
+};
+
+static const char* const quantityUnits[TREND_NUM_QUANTITIES] = {
+    "C", "PPM"
+};
+
+static float timeToThreshold[TREND_NUM_QUANTITIES] = {-1.0f, -1.0f};
+static float preAlarmHorizon = PREALARM_HORIZON_S;
+static uint8_t preAlarmMask = 0;
+static unsigned long lastTrendSample = 0;
+static uint32_t lastTemperatureReads = 0;
+
+// ============================================================================
+// SAMPLING & PREDICTION
+// ============================================================================
+void updateFireTrend(const SensorFrame& frame) {
+    unsigned long now = millis();
+    if (now - lastTrendSample < TREND_SAMPLE_MS) return;
+    lastTrendSample = now;
+
+    // Only a new DHT22 reading is a temperature sample; a failed one (-999)
+    // is skipped rather than fitted
+    if (frame.temperatureReads != lastTemperatureReads) {
+        lastTemperatureReads = frame.temperatureReads;
+        if (frame.temperature > -100.0f) histories[TREND_TEMPERATURE].push(frame.temperature);
+    }
+    histories[TREND_SMOKE].push(frame.smokePPM);
+    thresholds[TREND_SMOKE] = getSmokeThreshold();
+
+    // secondsToReach() is 0 once the fit is past the threshold: that is no
+    // longer a prediction
+    uint8_t mask = 0;
+    for (int q = 0; q < TREND_NUM_QUANTITIES; q++) {
+        timeToThreshold[q] = histories[q].secondsToReach(thresholds[q]);
+        if (timeToThreshold[q] > 0.0f && timeToThreshold[q] <= preAlarmHorizon) {
+            mask |= (1 << q);
+        }
+    }
+
+    // Log only quantities that just started predicting a crossing
+    uint8_t raised = mask & ~preAlarmMask;
+    for (int q = 0; q < TREND_NUM_QUANTITIES; q++) {
+        if (!(raised & (1 << q))) continue;
+        Serial.printf("[TREND] Pre-alarm: %s %.1f -> %.0f %s in %.0f s (%+.2f %s/s)\n",
+                      quantityNames[q], histories[q].fittedNow(), thresholds[q], quantityUnits[q],
+                      timeToThreshold[q], histories[q].slope(), quantityUnits[q]);
+    }
+    if (preAlarmMask && !mask) {
+        Serial.println("[TREND] Pre-alarm cleared");
+    }
+    preAlarmMask = mask;
+}
+
+// ============================================================================
+// GETTERS / CONFIGURATION
+// ============================================================================
+bool isPreAlarm() {
+    return preAlarmMask != 0;
+}
+
+uint8_t getPreAlarmMask() {
+    return preAlarmMask;
+}
+
+float getPreAlarmEta() {
+    float eta = -1.0f;
+    for (int q = 0; q < TREND_NUM_QUANTITIES; q++) {
+        if (!(preAlarmMask & (1 << q))) continue;
+        if (eta < 0.0f || timeToThreshold[q] < eta) eta = timeToThreshold[q];
+    }
+    return eta;
+}
+
+float getTrendSlope(TrendQuantity quantity) {
+    return (quantity < TREND_NUM_QUANTITIES) ? histories[quantity].slope() : 0.0f;
+}
+
+float getTimeToThreshold(TrendQuantity quantity) {
+    return (quantity < TREND_NUM_QUANTITIES) ? timeToThreshold[quantity] : -1.0f;
+}
+
+void setPreAlarmHorizon(float seconds) {
+    preAlarmHorizon = (seconds < 0.0f) ? 0.0f : seconds;
+    Serial.printf("[TREND] Pre-alarm horizon set to %.0f s\n", preAlarmHorizon);
+}
+
+float getPreAlarmHorizon() {
+    return preAlarmHorizon;
+}
+
+void printFireTrend(Print& out) {
+    out.printf(" %-5s | samples |    now   | slope (/s) | +/- (/s)  | threshold | eta (s)\n", "trend");
+    for (int q = 0; q < TREND_NUM_QUANTITIES; q++) {
+        const TrendHistory<TREND_HISTORY_SAMPLES>& h = histories[q];
+        out.printf(" %-5s | %7u | %8.1f | %10.3f | %9.3f | %9.0f | ",
+                   quantityNames[q], h.size(), h.fittedNow(), h.slope(), h.slopeStdError(), thresholds[q]);
+        if (timeToThreshold[q] < 0.0f) {
+            out.printf("-\n");
+        } else {
+            out.printf("%.0f%s\n", timeToThreshold[q], (preAlarmMask & (1 << q)) ? " PRE-ALARM" : "");
+        }
+    }
+    out.printf(" horizon %.0f s, smoke sampled every %d ms, temp every DHT22 read (%d ms)\n",
+               preAlarmHorizon, TREND_SAMPLE_MS, SENSOR_DHT_PERIOD_MS);
+}
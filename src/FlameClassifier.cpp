@@ -0,0 +1,138 @@
+#include "FlameClassifier.h"
+#include "SensorTask.h"
+#include "FireFusion.h"
+#include <esp_timer.h>
+
+static bool traceEnabled = false;          // Only touched from loop()
+
+static int countBits(uint64_t bits) {
+    int count = 0;
+    for (; bits; bits &= bits - 1) count++;
+    return count;
+}
+
+// ============================================================================
+// FEATURES
+// Everything relative to the channel's own margin, so the features do not
+// depend on sensor gain or mounting distance
+// ============================================================================
+void extractFlameFeatures(const FlameSnapshot& flame, const EnvSnapshot& env, float* features) {
+    int best = 0;
+    float bestRatio = -1e9f, secondRatio = -1e9f;
+    float deviationSum = 0.0f, marginSum = 0.0f;
+    uint32_t spikeMask = 0;
+
+    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+        const IRChannelData& ch = flame.channels[i];
+        float margin = (ch.marginMilliVolts > 1.0f) ? ch.marginMilliVolts : 1.0f;
+        float ratio = ch.deviation / margin;
+        if (ratio > bestRatio) {
+            secondRatio = bestRatio;
+            bestRatio = ratio;
+            best = i;
+        } else if (ratio > secondRatio) {
+            secondRatio = ratio;
+        }
+        deviationSum += ch.deviation;
+        marginSum += margin;
+        if (ch.isSpike) spikeMask |= (1UL << i);
+    }
+
+    const IRChannelData& top = flame.channels[best];
+    float topMargin = (top.marginMilliVolts > 1.0f) ? top.marginMilliVolts : 1.0f;
+    IRSpatialClass spatial = IRSpatialTable<IRActiveLayout>::classify(spikeMask);
+    uint64_t window = (FLAME_MODEL_PERSISTENCE_UPDATES >= 64) ? ~0ULL
+                                                              : ((1ULL << FLAME_MODEL_PERSISTENCE_UPDATES) - 1);
+
+    features[FEATURE_DEV_BEST] = bestRatio;
+    features[FEATURE_DEV_SECOND] = (IR_NUM_CHANNELS > 1) ? secondRatio : 0.0f;
+    features[FEATURE_DEV_MEAN] = deviationSum / marginSum;
+    features[FEATURE_SPIKE_FRACTION] = (float)countBits(spikeMask) / IR_NUM_CHANNELS;
+    features[FEATURE_POINT] = (spatial == IR_SPATIAL_POINT) ? 1.0f : 0.0f;
+    features[FEATURE_WIDE] = (spatial == IR_SPATIAL_AMBIENT || spatial == IR_SPATIAL_SCATTERED) ? 1.0f : 0.0f;
+    features[FEATURE_PERSISTENCE] = (float)countBits(top.spikeHistory & window) / FLAME_MODEL_PERSISTENCE_UPDATES;
+    features[FEATURE_FLICKER_RATIO] = top.flickerRatio;
+    features[FEATURE_FLICKER_LEVEL] = top.flickerMilliVolts / FLICKER_MIN_RMS_MV;
+    features[FEATURE_SWING] = (top.peakDeviation - top.troughDeviation) / topMargin;
+    features[FEATURE_SMOKE] = env.smokePPM / THRESHOLD_SMOKE;
+    features[FEATURE_TEMP] = (env.temperature > -100.0f)
+        ? (env.temperature - FUSION_TEMP_AMBIENT) / (THRESHOLD_TEMP - FUSION_TEMP_AMBIENT)
+        : 0.0f;                                 // DHT22 failed: neutral
+}
+
+// ============================================================================
+// INFERENCE
+// ============================================================================
+void classifyFlameSnapshot(FlameSnapshot& flame, const EnvSnapshot& env) {
+    int64_t start = esp_timer_get_time();
+
+    float probabilities[FLAME_NUM_CLASSES];
+    extractFlameFeatures(flame, env, flame.modelFeatures);
+    flame.modelClass = FlameModel::infer(flame.modelFeatures, probabilities);
+    for (int k = 0; k < FLAME_NUM_CLASSES; k++) {
+        flame.modelProbability[k] = (uint8_t)(probabilities[k] * 100.0f + 0.5f);
+    }
+
+    int64_t elapsed = esp_timer_get_time() - start;
+    flame.modelMicros = (elapsed > 0xFFFF) ? 0xFFFF : (uint16_t)elapsed;
+}
+
+// ============================================================================
+// TRACE
+// Printed from loop(), never from the sensing task: one line per published
+// update that loop() sees, stamped with the update's own time. An update is
+// missed only while loop() stalls for more than FLAME_DETECTION_UPDATE_MS.
+// ============================================================================
+void printFlameModelTrace() {
+    static uint32_t lastTraced = 0;
+    if (!traceEnabled) return;
+
+    FlameSnapshot flame;
+    if (!readFlameSnapshot(flame) || flame.updateCount == lastTraced) return;
+    lastTraced = flame.updateCount;
+
+    // ms,dev_best,dev_second,dev_mean,spikes,point,wide,persistence,flicker,flicker_mv,swing,smoke,temp
+    Serial.printf("[MLTRACE] %lu", (unsigned long)(flame.timestampUs / 1000));
+    for (int i = 0; i < FLAME_NUM_FEATURES; i++) {
+        Serial.printf(",%.3f", flame.modelFeatures[i]);
+    }
+    Serial.printf("\n");
+}
+
+void setFlameModelTrace(bool enabled) {
+    traceEnabled = enabled;
+}
+
+bool isFlameModelTrace() {
+    return traceEnabled;
+}
+
+// ============================================================================
+// STATUS
+// ============================================================================
+void printFlameModel(Print& out) {
+    static const char* const featureNames[FLAME_NUM_FEATURES] = {
+        "dev_best", "dev_second", "dev_mean", "spikes", "point", "wide",
+        "persist", "flicker", "flicker_lvl", "swing", "smoke", "temp"
+    };
+
+    out.printf(" %d-%d-%d int8 MLP, %s weights, trace %s\n",
+               FLAME_MODEL_INPUTS, FLAME_MODEL_HIDDEN, FLAME_MODEL_CLASSES,
+               FLAME_MODEL_FROM_TRACES ? "trace-trained" : "synthetic (advisory)",
+               traceEnabled ? "on" : "off");
+
+    FlameSnapshot flame;
+    if (!readFlameSnapshot(flame)) {
+        out.printf(" no IR update yet\n");
+        return;
+    }
+    out.printf(" class %s (quiet %u%%, flame %u%%, nuisance %u%%), %u us per update\n",
+               flameClassName(flame.modelClass),
+               flame.modelProbability[FLAME_CLASS_QUIET], flame.modelProbability[FLAME_CLASS_FLAME],
+               flame.modelProbability[FLAME_CLASS_NUISANCE], flame.modelMicros);
+    out.printf(" features:");
+    for (int i = 0; i < FLAME_NUM_FEATURES; i++) {
+        out.printf("%s %s=%.2f", (i % 6 == 0) ? "\n  " : "", featureNames[i], flame.modelFeatures[i]);
+    }
+    out.printf("\n");
+}
@@ -0,0 +1,184 @@
+#include "FusionScore.h"
+#include <math.h>
+
+static float clampRange(float value, float hi) {
+    return (value < 0.0f) ? 0.0f : (value > hi ? hi : value);
+}
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+FireFusion::FireFusion()
+    : score(0.0f),
+      instantScore(0.0f),
+      level(FIRE_AMAN) {
+    weights[FUSION_FLAME] = FUSION_WEIGHT_FLAME;
+    weights[FUSION_SMOKE_LEVEL] = FUSION_WEIGHT_SMOKE;
+    weights[FUSION_SMOKE_SLOPE] = FUSION_WEIGHT_SMOKE_SLOPE;
+    weights[FUSION_TEMP_LEVEL] = FUSION_WEIGHT_TEMP;
+    weights[FUSION_TEMP_SLOPE] = FUSION_WEIGHT_TEMP_SLOPE;
+    weights[FUSION_IR_SHIFT] = FUSION_WEIGHT_IR_SHIFT;
+    weights[FUSION_SMOKE_SHIFT] = FUSION_WEIGHT_SMOKE_SHIFT;
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) {
+        evidence[i] = 0.0f;
+    }
+}
+
+// ============================================================================
+// UPDATE
+// ============================================================================
+FireLevel FireFusion::update(const FusionInput& input, float dtSeconds) {
+    if (input.flameState == FLAME_DETECTED) {
+        evidence[FUSION_FLAME] = 1.0f;
+    } else if (input.flameState == FLAME_POTENTIAL) {
+        evidence[FUSION_FLAME] = 0.5f * input.flameConfidence / 100.0f;
+    } else {
+        evidence[FUSION_FLAME] = 0.0f;      // Idle, or ambient IR that is not a flame
+    }
+#if FUSION_MODEL_VETO
+    if (input.modelNuisance >= FUSION_MODEL_VETO_PERCENT) evidence[FUSION_FLAME] = 0.0f;
+#endif
+
+    float smokeSpan = input.smokeThreshold - input.smokeBackground;
+    evidence[FUSION_SMOKE_LEVEL] = (smokeSpan > 0.0f)
+        ? clampRange((input.smokePPM - input.smokeBackground) / smokeSpan, FUSION_LEVEL_CAP)
+        : 0.0f;
+    evidence[FUSION_SMOKE_SLOPE] = clampRange(input.smokeSlope / FUSION_SMOKE_SLOPE_FULL, 1.0f);
+
+    if (input.temperature > -100.0f) {
+        evidence[FUSION_TEMP_LEVEL] = clampRange((input.temperature - FUSION_TEMP_AMBIENT) /
+                                                 (THRESHOLD_TEMP - FUSION_TEMP_AMBIENT), FUSION_LEVEL_CAP);
+        evidence[FUSION_TEMP_SLOPE] = clampRange(input.temperatureSlope / FUSION_TEMP_SLOPE_FULL, 1.0f);
+    } else {
+        evidence[FUSION_TEMP_LEVEL] = 0.0f;
+        evidence[FUSION_TEMP_SLOPE] = 0.0f;
+    }
+
+    // Small persistent shifts, long before the levels get anywhere
+    evidence[FUSION_IR_SHIFT] = clampRange(input.irShiftLevel, 1.0f);
+    evidence[FUSION_SMOKE_SHIFT] = clampRange(input.smokeShiftLevel, 1.0f);
+
+    float sum = 0.0f;
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) {
+        sum += weights[i] * evidence[i];
+    }
+    instantScore = clampRange(sum, 100.0f);
+
+    // Asymmetric first-order lag, exact for any update interval
+    float tau = (instantScore > score) ? FUSION_ATTACK_S : FUSION_RELEASE_S;
+    float alpha = (dtSeconds > 0.0f) ? 1.0f - expf(-dtSeconds / tau) : 0.0f;
+    score += alpha * (instantScore - score);
+
+    level = (score >= FUSION_BAHAYA_SCORE) ? FIRE_BAHAYA : (score >= FUSION_WASPADA_SCORE ? FIRE_WASPADA : FIRE_AMAN);
+    return level;
+}
+
+// ============================================================================
+// GETTERS / CONFIGURATION
+// ============================================================================
+float FireFusion::getScore() const {
+    return score;
+}
+
+float FireFusion::getInstantScore() const {
+    return instantScore;
+}
+
+float FireFusion::getEvidence(FusionEvidence which) const {
+    return (which < FUSION_NUM_EVIDENCE) ? evidence[which] : 0.0f;
+}
+
+FireLevel FireFusion::getLevel() const {
+    return level;
+}
+
+void FireFusion::setWeight(FusionEvidence which, float points) {
+    if (which >= FUSION_NUM_EVIDENCE) return;
+    weights[which] = (points < 0.0f) ? 0.0f : points;
+}
+
+float FireFusion::getWeight(FusionEvidence which) const {
+    return (which < FUSION_NUM_EVIDENCE) ? weights[which] : 0.0f;
+}
+
+void FireFusion::reset() {
+    score = 0.0f;
+    instantScore = 0.0f;
+    level = FIRE_AMAN;
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) {
+        evidence[i] = 0.0f;
+    }
+}
+
+const char* FireFusion::levelName(FireLevel level) {
+    static const char* const names[] = {"Aman", "Waspada", "Bahaya"};
+    return (level <= FIRE_BAHAYA) ? names[level] : "?";
+}
+
+const char* FireFusion::evidenceName(FusionEvidence which) {
+    static const char* const names[FUSION_NUM_EVIDENCE] = {"flame", "smoke", "smoke/s", "temp", "temp/s",
+                                                                   "ir-cusum", "smk-cusum"};
+    return (which < FUSION_NUM_EVIDENCE) ? names[which] : "?";
+}
+
+// ============================================================================
+// TIME-TO-ALARM COMPARISON
+// ============================================================================
+FusionEpisodeTracker::FusionEpisodeTracker()
+    : closed(0) {
+    episode.open = false;
+    episode.startMs = 0;
+    episode.quietSinceMs = 0;
+    for (int rule = 0; rule < 2; rule++) {
+        episode.firstMs[rule][0] = episode.firstMs[rule][1] = -1;
+    }
+    lastEpisode = episode;
+}
+
+void FusionEpisodeTracker::noteLevel(FusionRule rule, FireLevel level, unsigned long now) {
+    for (int i = 0; i < 2; i++) {
+        if (level >= FIRE_WASPADA + i && episode.firstMs[rule][i] < 0) {
+            episode.firstMs[rule][i] = (long)(now - episode.startMs);
+        }
+    }
+}
+
+FusionEpisodeEvent FusionEpisodeTracker::update(FireLevel fused, FireLevel legacy, unsigned long now) {
+    bool active = fused != FIRE_AMAN || legacy != FIRE_AMAN;
+    FusionEpisodeEvent event = FUSION_EPISODE_NONE;
+
+    if (!episode.open) {
+        if (!active) return FUSION_EPISODE_NONE;
+        episode.open = true;
+        episode.startMs = now;
+        for (int rule = 0; rule < 2; rule++) {
+            episode.firstMs[rule][0] = episode.firstMs[rule][1] = -1;
+        }
+        event = FUSION_EPISODE_STARTED;
+    }
+
+    noteLevel(FUSION_RULE_SCORE, fused, now);
+    noteLevel(FUSION_RULE_LEGACY, legacy, now);
+
+    if (active) {
+        episode.quietSinceMs = now;
+    } else if (now - episode.quietSinceMs >= FUSION_EPISODE_GAP_MS) {
+        episode.open = false;
+        lastEpisode = episode;
+        closed++;
+        event = FUSION_EPISODE_CLOSED;
+    }
+    return event;
+}
+
+const FusionEpisode& FusionEpisodeTracker::current() const {
+    return episode;
+}
+
+const FusionEpisode& FusionEpisodeTracker::last() const {
+    return lastEpisode;
+}
+
+uint32_t FusionEpisodeTracker::getClosedCount() const {
+    return closed;
+}
@@ -1,180 +1,744 @@
 #include "IRFlameSensor.h"
+#include "AdcSampler.h"
+#include "IROversampler.h"
+#include "IRFixedPoint.h"
 #include "Config.h"
+#include <esp_system.h>
+
+// ============================================================================
+// RTC BASELINE SNAPSHOT
+// RTC slow memory keeps its contents across a software reset, watchdog or
+// panic (not a power cycle). The learned noise is carried along so the
+// automatic margins come back together with the baselines. The storage fits
+// the largest layout; each layout views it through its own record, and the
+// channel count in the record keeps a snapshot of another layout out.
+// ============================================================================
+#define IR_SNAPSHOT_MAGIC           0x49524231UL    // "IRB1"
+
+static RTC_NOINIT_ATTR IRBaselineSnapshotT<IR_MAX_LAYOUT_CHANNELS> irSnapshotStorage;
+
+template <typename Layout>
+static IRBaselineSnapshotT<Layout::channels>& irBaselineSnapshot() {
+    static_assert(sizeof(IRBaselineSnapshotT<Layout::channels>) <= sizeof(irSnapshotStorage),
+                  "RTC snapshot storage is sized for IR_MAX_LAYOUT_CHANNELS");
+    return *reinterpret_cast<IRBaselineSnapshotT<Layout::channels>*>(&irSnapshotStorage);
+}
 
 // ============================================================================
 // CONSTRUCTOR
 // ============================================================================
-IRFlameSensor::IRFlameSensor()
-    : currentState(FLAME_IDLE),
+template <typename Layout>
+IRFlameSensorT<Layout>::IRFlameSensorT()
+    : spikeMask(0),
+      shiftMask(0),
+      currentState(FLAME_IDLE),
       potentialFlameStartTime(0),
+      updatesSincePotential(0),
+      overallConfidence(0),
       sensitivityMargin(SENSITIVITY_MARGIN),
-      lastUpdateTime(0) {
-    // Initialize all channels with zero baseline
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
-        channels[i].baseline = 0.0f;
-        channels[i].rawMilliVolts = 0;
-        channels[i].deviation = 0.0f;
-        channels[i].isSpike = false;
-        channels[i].lastSpikeTime = 0;
+      autoMargin(IR_AUTO_MARGIN),
+      warmupUpdates(0),
+      snapshotPending(false),
+      baselineRestored(false),
+      armStartTime(0),
+      timeToArmed(0),
+      lastSnapshotTime(0),
+      lastUpdateTime(0),
+      samplesThisSecond(0),
+      samplesPerSecond(0),
+      conversionsAtWindowStart(0),
+      conversionsPerSecond(0),
+      sampleWindowStart(0) {
+    // Baselines are seeded by the first reading (see updateBaselines)
+    for (int i = 0; i < Layout::channels; i++) {
+        baseline[i] = 0.0f;
+        rawMilliVolts[i] = 0;
+        deviation[i] = 0.0f;
+        lastSpikeTime[i] = 0;
+        spikeHistory[i] = 0;
+        noiseMilliVolts[i] = 0.0f;
+        samplesPerUpdate[i] = OVERSAMPLING_SAMPLES;
+        flickerMilliVolts[i] = 0.0f;
+        flickerRatio[i] = 0.0f;
+        peakDeviation[i] = 0.0f;
+        troughDeviation[i] = 0.0f;
+        confidence[i] = 0;
+        deviationExtrema[i].setWindow(PEAK_WINDOW_UPDATES);
+        baselineQ16[i] = 0;
+        deviationQ16[i] = 0;
+        noiseVarianceRaw[i] = -1.0f;
+        setMargin(i, SENSITIVITY_MARGIN);
+        residualVariance[i] = 0.0f;
+        lastResidual[i] = 0.0f;
+        quietUpdates[i] = 0;
+        flickerSpikeBlock[i] = true;
+        flickerVerdict[i] = FLICKER_UNKNOWN;
+        outlierFilters[i].setMode(IR_OUTLIER_FILTER);
+        shiftDetectors[i].configure(IR_CUSUM_DRIFT_MV, IR_CUSUM_THRESHOLD);
+        shiftDetectors[i].setReferenceAlpha(FLAME_DETECTION_UPDATE_MS / 1000.0f / IR_CUSUM_REFERENCE_TAU_S);
+    }
+
+#if IR_FIR_PREFILTER
+    firDesignLowPass(firCoeffs, IR_FIR_TAPS, IR_FIR_CUTOFF_HZ / FLICKER_SAMPLE_RATE_HZ);
+    for (int i = 0; i < Layout::channels; i++) {
+        firFilters[i].init(firCoeffs, IR_FIR_TAPS, IR_FIR_DECIMATION);
+        firOutput[i] = 0.0f;
     }
+    firPrimed = false;
+    firFresh = 0;
+#endif
 }
 
 // ============================================================================
 // INITIALIZATION
 // ============================================================================
-void IRFlameSensor::init() {
-    Serial.println("[IRFlameSensor] Initializing 5-channel advanced flame detector...");
+template <typename Layout>
+void IRFlameSensorT<Layout>::init() {
+    irOversampler.begin();
+
+    Serial.printf("[IRFlameSensor] Initializing %d-channel %s advanced flame detector...\n", Layout::channels,
+                  (Layout::topology == IR_TOPOLOGY_RING) ? "ring" : "linear");
     Serial.printf("[IRFlameSensor] Oversampling: %d samples per read\n", OVERSAMPLING_SAMPLES);
-    Serial.printf("[IRFlameSensor] EMA Alpha: %.3f\n", EMA_ALPHA);
+    Serial.printf("[IRFlameSensor] EMA Alpha: %.3f (1/(n+1) for the first %d updates)\n", EMA_ALPHA, IR_WARMUP_UPDATES);
     Serial.printf("[IRFlameSensor] Sensitivity Margin: %d mV\n", sensitivityMargin);
+    if (autoMargin) {
+        Serial.printf("[IRFlameSensor] Auto margin: %.1f x sigma, %.0f-%.0f mV, learned after %d quiet updates\n",
+                      IR_AUTO_MARGIN_K, IR_AUTO_MARGIN_MIN_MV, IR_AUTO_MARGIN_MAX_MV, IR_AUTO_MARGIN_WARMUP);
+    }
     Serial.printf("[IRFlameSensor] Temporal Verification: %d ms\n", TEMPORAL_VERIFICATION_MS);
-    Serial.printf("[IRFlameSensor] Ambient Interference Threshold: %d sensors\n", AMBIENT_INTERFERENCE_MIN);
+    Serial.printf("[IRFlameSensor] Ambient Interference Threshold: %d sensors\n", Layout::ambientMin);
+    Serial.printf("[IRFlameSensor] CUSUM: drift %.0f mV, threshold %.0f mV x updates, reference tau %.0f s\n",
+                  IR_CUSUM_DRIFT_MV, IR_CUSUM_THRESHOLD, IR_CUSUM_REFERENCE_TAU_S);
+#if IR_FIR_PREFILTER
+    Serial.printf("[IRFlameSensor] FIR prefilter: %d taps, %.1f Hz cutoff, %d Hz -> %d Hz\n",
+                  IR_FIR_TAPS, IR_FIR_CUTOFF_HZ, FLICKER_SAMPLE_RATE_HZ,
+                  FLICKER_SAMPLE_RATE_HZ / IR_FIR_DECIMATION);
+#endif
+    Serial.printf("[IRFlameSensor] Flicker band: %d-%d Hz @ %d Hz, block %d samples\n",
+                  FLICKER_FIRST_BIN * FLICKER_SAMPLE_RATE_HZ / FLICKER_BLOCK_SAMPLES,
+                  FLICKER_LAST_BIN * FLICKER_SAMPLE_RATE_HZ / FLICKER_BLOCK_SAMPLES,
+                  FLICKER_SAMPLE_RATE_HZ, FLICKER_BLOCK_SAMPLES);
+
+    armStartTime = millis();
+#if IR_BASELINE_SNAPSHOT
+    // RTC memory is random after power-on / brownout; the checksum catches the rest
+    const IRBaselineSnapshotT<Layout::channels>& snapshot = irBaselineSnapshot<Layout>();
+    esp_reset_reason_t reason = esp_reset_reason();
+    snapshotPending = reason != ESP_RST_POWERON && reason != ESP_RST_BROWNOUT &&
+                      snapshot.magic == IR_SNAPSHOT_MAGIC &&
+                      snapshot.channels == Layout::channels &&
+                      snapshot.checksum == snapshot.computeChecksum();
+    Serial.printf("[IRFlameSensor] Baseline snapshot: %s\n",
+                  snapshotPending ? "found, checked against the first read" : "none, seeding from the first read");
+#endif
     Serial.println("[IRFlameSensor] Initialization complete!");
 }
 
 // ============================================================================
-// READ CHANNEL WITH OVERSAMPLING
-// Returns analog value in millivolts (0-3300 mV for ESP32)
+// BASELINE WARM-START
+// The first reading seeds the baseline (alpha = 1), then alpha = 1/(n+1)
+// makes it the running mean of the readings so far until that reaches
+// EMA_ALPHA. Starting from 0 instead took ~160 updates (8 s) before a
+// 1.5 V baseline came within the margin, with every channel spiking and the
+// detector stuck in AMBIENT_INTERFERENCE meanwhile.
 // ============================================================================
-uint16_t IRFlameSensor::readChannelMilliVolts(uint8_t channel) {
-    if (channel >= IR_NUM_CHANNELS) return 0;
+template <typename Layout>
+float IRFlameSensorT<Layout>::baselineAlpha() const {
+    float alpha = 1.0f / (warmupUpdates + 1);
+    return (alpha > EMA_ALPHA) ? alpha : EMA_ALPHA;
+}
+
+// After a reset the snapshot is checked against the first reading. A scene
+// change during the reset shows on many channels at once (same count as
+// ambient interference) and the snapshot is dropped; a flame that started
+// meanwhile shows on one or two and must stay visible, so it is kept.
+template <typename Layout>
+void IRFlameSensorT<Layout>::restoreSnapshot() {
+    snapshotPending = false;
+
+    const IRBaselineSnapshotT<Layout::channels>& snapshot = irBaselineSnapshot<Layout>();
+    uint8_t disagreeing = 0;
+    for (int i = 0; i < Layout::channels; i++) {
+        if (fabsf(rawMilliVolts[i] - snapshot.baseline[i]) > marginMilliVolts[i]) disagreeing++;
+    }
+    if (disagreeing >= Layout::ambientMin) {
+        Serial.printf("[IRFlameSensor] Snapshot dropped: %d channels moved, seeding from this read\n", disagreeing);
+        return;
+    }
+
+    for (int i = 0; i < Layout::channels; i++) {
+        baseline[i] = snapshot.baseline[i];
+        baselineQ16[i] = (int32_t)(baseline[i] * IR_Q16_ONE);
+        residualVariance[i] = snapshot.residualVariance[i];
+        quietUpdates[i] = snapshot.quietUpdates[i];
+        lastResidual[i] = rawMilliVolts[i] - baseline[i];
+        refreshMargin(i);
+    }
+    warmupUpdates = IR_WARMUP_UPDATES;
+    baselineRestored = true;
+    Serial.println("[IRFlameSensor] Baselines restored from RTC snapshot");
+}
+
+// Only a quiet, armed picture is worth restoring, never one with a detection
+template <typename Layout>
+void IRFlameSensorT<Layout>::saveSnapshot() {
+#if IR_BASELINE_SNAPSHOT
+    if (timeToArmed == 0 || currentState != FLAME_IDLE || spikeMask != 0) return;
 
-    // Accumulate OVERSAMPLING_SAMPLES readings
-    long totalMV = 0;
-    for (int i = 0; i < OVERSAMPLING_SAMPLES; i++) {
-        // analogReadMilliVolts() provides better linearity than analogRead()
-        totalMV += analogReadMilliVolts(IR_PINS[channel]);
-        // Very small delay to allow ADC capacitor to settle
-        delayMicroseconds(10);
+    unsigned long now = millis();
+    if (now - lastSnapshotTime < IR_BASELINE_SNAPSHOT_MS) return;
+    lastSnapshotTime = now;
+
+    IRBaselineSnapshotT<Layout::channels>& snapshot = irBaselineSnapshot<Layout>();
+    snapshot.magic = IR_SNAPSHOT_MAGIC;
+    snapshot.channels = Layout::channels;
+    for (int i = 0; i < Layout::channels; i++) {
+        snapshot.baseline[i] = baseline[i];
+        snapshot.residualVariance[i] = residualVariance[i];
+        snapshot.quietUpdates[i] = quietUpdates[i];
     }
+    snapshot.checksum = snapshot.computeChecksum();
+#endif
+}
 
-    // Return average in millivolts
-    return (uint16_t)(totalMV / OVERSAMPLING_SAMPLES);
+template <typename Layout>
+void IRFlameSensorT<Layout>::checkArmed() {
+    if (timeToArmed != 0 || warmupUpdates == 0 || spikeMask != 0 || currentState != FLAME_IDLE) return;
+
+    timeToArmed = millis() - armStartTime;
+    if (timeToArmed == 0) timeToArmed = 1;
+    Serial.printf("[IRFlameSensor] Armed %lu ms after start (baselines %s)\n", timeToArmed,
+                  baselineRestored ? "restored from RTC snapshot" : "seeded from first read");
+}
+
+template <typename Layout>
+bool IRFlameSensorT<Layout>::isArmed() const {
+    return timeToArmed != 0;
+}
+
+template <typename Layout>
+unsigned long IRFlameSensorT<Layout>::getTimeToArmed() const {
+    return timeToArmed;
+}
+
+template <typename Layout>
+bool IRFlameSensorT<Layout>::isBaselineRestored() const {
+    return baselineRestored;
 }
 
 // ============================================================================
-// UPDATE BASELINES (EMA)
-// Called regularly to adapt baseline to slow environmental changes
+// PICK UP OVERSAMPLED BLOCK
+// The interleaved oversampler fills the accumulators in the background; only
+// the finished per-channel averages are converted to millivolts here.
 // ============================================================================
-void IRFlameSensor::updateBaselines() {
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
-        // EMA Formula: Baseline = (α × Current) + ((1 - α) × Baseline)
-        // α = 0.01 means 99% inertia (ignores spikes, tracks slow changes)
-        channels[i].baseline = (EMA_ALPHA * channels[i].rawMilliVolts) +
-                               ((1.0f - EMA_ALPHA) * channels[i].baseline);
+template <typename Layout>
+bool IRFlameSensorT<Layout>::readOversampledChannels() {
+    static_assert(Layout::channels <= IR_NUM_CHANNELS, "ADC scan and oversampler are sized for IRActiveLayout");
+    uint16_t targets[Layout::channels];
+    chooseSampleCounts(targets);
+
+    IROversampleBlock block;
+    if (!irOversampler.collect(block, targets)) return false;
+
+    uint32_t blockSamples = 0;
+    for (int i = 0; i < Layout::channels; i++) {
+        rawMilliVolts[i] = adcSampler.rawToMilliVolts(block.meanRaw[i]);
+        samplesPerUpdate[i] = block.samples[i];
+        blockSamples += block.samples[i];
+
+        // Smooth the per-block Welford variance into a per-channel noise floor
+        if (block.samples[i] > 1) {
+            if (noiseVarianceRaw[i] < 0.0f) {
+                noiseVarianceRaw[i] = block.varianceRaw[i];
+            } else {
+                noiseVarianceRaw[i] += NOISE_VARIANCE_ALPHA * (block.varianceRaw[i] - noiseVarianceRaw[i]);
+            }
+        }
 
-        // Calculate deviation from baseline
-        channels[i].deviation = channels[i].rawMilliVolts - channels[i].baseline;
+        // Local mV-per-code slope of the calibration curve around this level
+        uint16_t lo = (block.meanRaw[i] > 16) ? block.meanRaw[i] - 16 : 0;
+        uint16_t hi = (block.meanRaw[i] < 4095 - 16) ? block.meanRaw[i] + 16 : 4095;
+        float mvPerCode = (hi > lo) ? (float)(adcSampler.rawToMilliVolts(hi) - adcSampler.rawToMilliVolts(lo)) / (hi - lo)
+                                    : 0.8f;
+        noiseMilliVolts[i] = (noiseVarianceRaw[i] > 0.0f) ? sqrtf(noiseVarianceRaw[i]) * mvPerCode : 0.0f;
+    }
 
-        // Determine if this channel shows a spike
-        channels[i].isSpike = channels[i].deviation > sensitivityMargin;
+    // Samples-per-second report, refreshed once per second
+    unsigned long now = millis();
+    samplesThisSecond += blockSamples;
+    if (now - sampleWindowStart >= 1000) {
+        uint32_t conversions = irOversampler.getConversionCount();
+        samplesPerSecond = samplesThisSecond * 1000UL / (now - sampleWindowStart);
+        conversionsPerSecond = (conversions - conversionsAtWindowStart) * 1000UL / (now - sampleWindowStart);
+        samplesThisSecond = 0;
+        conversionsAtWindowStart = conversions;
+        sampleWindowStart = now;
+    }
+    return true;
+}
+
+// ============================================================================
+// PICK UP FIR OUTPUT (IR_FIR_PREFILTER)
+// Drop-in replacement for readOversampledChannels(): the 100 Hz stream is
+// low-passed and decimated in updateHighRate(), so 50/100 Hz ripple that a
+// boxcar average lets through never reaches the baseline.
+// ============================================================================
+template <typename Layout>
+bool IRFlameSensorT<Layout>::readFilteredChannels() {
+#if IR_FIR_PREFILTER
+    const uint32_t allChannels = (1UL << Layout::channels) - 1;
+    if (firFresh != allChannels) return false;
+    firFresh = 0;
+
+    for (int i = 0; i < Layout::channels; i++) {
+        float mv = firOutput[i];
+        rawMilliVolts[i] = (mv <= 0.0f) ? 0 : (uint16_t)(mv + 0.5f);
+    }
+    return true;
+#else
+    return false;
+#endif
+}
+
+// ============================================================================
+// OUTLIER REJECTION
+// Runs over the sequence of per-update readings; a reading corrupted by a
+// burst of glitches never reaches the baseline or the spike test
+// ============================================================================
+template <typename Layout>
+void IRFlameSensorT<Layout>::rejectOutliers() {
+    for (int i = 0; i < Layout::channels; i++) {
+        rawMilliVolts[i] = outlierFilters[i].push(rawMilliVolts[i]);
     }
 }
 
 // ============================================================================
-// SPATIAL VOTING: Count active spikes
+// CHANGE DETECTION (CUSUM)
+// Runs on the raw readings, not the deviation: the EMA baseline follows a
+// slow rise and would hide it, the CUSUM reference does not
 // ============================================================================
-uint8_t IRFlameSensor::countActiveSpikes() const {
-    uint8_t count = 0;
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
-        if (channels[i].isSpike) count++;
+template <typename Layout>
+void IRFlameSensorT<Layout>::detectShifts() {
+    uint32_t mask = 0;
+    for (int i = 0; i < Layout::channels; i++) {
+        if (shiftDetectors[i].push(rawMilliVolts[i]) > 0) mask |= (1UL << i);
+    }
+    shiftMask = mask;
+}
+
+template <typename Layout>
+void IRFlameSensorT<Layout>::setChangeDetector(float driftMilliVolts, float threshold) {
+    for (int i = 0; i < Layout::channels; i++) {
+        shiftDetectors[i].configure(driftMilliVolts, threshold);
     }
-    return count;
+    Serial.printf("[IRFlameSensor] CUSUM drift %.1f mV, threshold %.0f mV x updates\n",
+                  shiftDetectors[0].getDrift(), shiftDetectors[0].getThreshold());
+}
+
+template <typename Layout>
+float IRFlameSensorT<Layout>::getChangeDrift() const {
+    return shiftDetectors[0].getDrift();
+}
+
+template <typename Layout>
+float IRFlameSensorT<Layout>::getChangeThreshold() const {
+    return shiftDetectors[0].getThreshold();
+}
+
+template <typename Layout>
+uint32_t IRFlameSensorT<Layout>::getShiftMask() const {
+    return shiftMask;
+}
+
+template <typename Layout>
+void IRFlameSensorT<Layout>::setChannelFilter(uint8_t channel, SampleFilterMode mode) {
+    if (channel >= Layout::channels) return;
+    outlierFilters[channel].setMode(mode);
+}
+
+template <typename Layout>
+SampleFilterMode IRFlameSensorT<Layout>::getChannelFilter(uint8_t channel) const {
+    return (channel < Layout::channels) ? outlierFilters[channel].getMode() : SAMPLE_FILTER_MEAN;
 }
 
 // ============================================================================
-// SPATIAL VOTING: Check if two channels are adjacent
-// Channels: 0-1-2-3-4 (linear array)
+// ADAPTIVE OVERSAMPLING
+// The average of n samples has noise sigma/sqrt(n). Take just enough samples
+// that the averaged noise stays below |deviation - margin| / Z: channels far
+// from the decision threshold need few samples, borderline ones get all 64.
+// Only the esp_timer fallback converts less for it; the DMA scan runs at
+// ADC_SAMPLE_FREQ_HZ regardless and the blocks just finish sooner.
 // ============================================================================
-bool IRFlameSensor::areChannelsAdjacent(uint8_t ch1, uint8_t ch2) const {
-    return (ch1 < IR_NUM_CHANNELS && ch2 < IR_NUM_CHANNELS &&
-            abs((int)ch1 - (int)ch2) == 1);
+template <typename Layout>
+void IRFlameSensorT<Layout>::chooseSampleCounts(uint16_t* targets) const {
+    for (int i = 0; i < Layout::channels; i++) {
+#if ADAPTIVE_OVERSAMPLING
+        float sigma = noiseMilliVolts[i];
+        float distance = fabsf(deviation[i] - marginMilliVolts[i]);
+
+        if (noiseVarianceRaw[i] < 0.0f || distance < 1.0f) {
+            targets[i] = OVERSAMPLING_SAMPLES;      // No noise estimate yet / on the edge
+            continue;
+        }
+
+        float ratio = ADAPTIVE_CONFIDENCE_Z * sigma / distance;
+        float needed = ceilf(ratio * ratio);
+        if (needed < OVERSAMPLING_MIN_SAMPLES) needed = OVERSAMPLING_MIN_SAMPLES;
+        if (needed > OVERSAMPLING_SAMPLES) needed = OVERSAMPLING_SAMPLES;
+        targets[i] = (uint16_t)needed;
+#else
+        targets[i] = OVERSAMPLING_SAMPLES;
+#endif
+    }
 }
 
 // ============================================================================
-// SPATIAL VOTING: Point Source Detection
-// True if only 1 or 2 adjacent sensors show spike
+// UPDATE BASELINES (EMA)
+// Called regularly to adapt baseline to slow environmental changes
 // ============================================================================
-bool IRFlameSensor::isPointSource() const {
-    uint8_t spikeCount = countActiveSpikes();
+template <typename Layout>
+void IRFlameSensorT<Layout>::updateBaselines() {
+#if IR_BASELINE_SNAPSHOT
+    if (warmupUpdates == 0 && snapshotPending) restoreSnapshot();
+#endif
+#if IR_FIXED_POINT_BASELINE
+    // Integer pipeline - same result within IRFixedPoint.h tolerance, ISR-safe.
+    // Alpha by integer division, margins already Q16.16 (setMargin())
+    int32_t alphaQ24 = irWarmupAlphaQ24(warmupUpdates, IR_ALPHA_Q24(EMA_ALPHA));
+    if (warmupUpdates < IR_WARMUP_UPDATES) warmupUpdates++;
+    spikeMask = irFixedUpdateChannels(rawMilliVolts, baselineQ16, deviationQ16, Layout::channels,
+                                      alphaQ24, marginQ16);
+
+    // Float copies for the later stages and reporting
+    for (int i = 0; i < Layout::channels; i++) {
+        baseline[i] = irQ16ToMilliVolts(baselineQ16[i]);
+        deviation[i] = irQ16ToMilliVolts(deviationQ16[i]);
+    }
+#else
+    float alpha = baselineAlpha();
+    if (warmupUpdates < IR_WARMUP_UPDATES) warmupUpdates++;
+
+    spikeMask = 0;
+    for (int i = 0; i < Layout::channels; i++) {
+        // EMA Formula: Baseline = (α × Current) + ((1 - α) × Baseline)
+        // α = 0.01 means 99% inertia (ignores spikes, tracks slow changes)
+        baseline[i] = (alpha * rawMilliVolts[i]) + ((1.0f - alpha) * baseline[i]);
 
-    // Single sensor spike is a point source
-    if (spikeCount == 1) return true;
+        // Calculate deviation from baseline
+        deviation[i] = rawMilliVolts[i] - baseline[i];
+
+        // Determine if this channel shows a spike
+        if (deviation[i] > marginMilliVolts[i]) spikeMask |= (1UL << i);
+    }
+#endif
+}
 
-    // Two adjacent sensors spike = point source (localized flame)
-    if (spikeCount == 2) {
-        for (int i = 0; i < IR_NUM_CHANNELS - 1; i++) {
-            if (channels[i].isSpike && channels[i + 1].isSpike) {
-                return true;  // Found adjacent pair
+// ============================================================================
+// AUTOMATIC MARGINS
+// sigma^2 = E[(r_t - r_t-1)^2] / 2 for white noise on the residual r = raw -
+// baseline; using increments keeps the slow EMA lag (baseline still
+// settling, gentle drift) out of the noise estimate. Learning is frozen while
+// a detection (POTENTIAL / DETECTED) is in progress and on a channel that is
+// spiking, so a flame never teaches the detector to ignore it. Ambient
+// interference only freezes the channels it makes spike.
+// ============================================================================
+template <typename Layout>
+void IRFlameSensorT<Layout>::learnMargins() {
+    bool frozen = currentState == FLAME_POTENTIAL || currentState == FLAME_DETECTED;
+
+    for (int i = 0; i < Layout::channels; i++) {
+        float increment = deviation[i] - lastResidual[i];
+        lastResidual[i] = deviation[i];
+
+        if (frozen || ((spikeMask >> i) & 1)) continue;
+
+        if (quietUpdates[i] == 0) {
+            residualVariance[i] = 0.0f;         // First quiet update has no valid increment
+        } else {
+            float sample = 0.5f * increment * increment;
+            if (quietUpdates[i] == 1) {
+                residualVariance[i] = sample;
+            } else {
+                residualVariance[i] += IR_AUTO_MARGIN_ALPHA * (sample - residualVariance[i]);
             }
         }
+        if (quietUpdates[i] < 0xFFFF) quietUpdates[i]++;
+
+        refreshMargin(i);
     }
+}
 
-    // Multiple non-adjacent spikes or >2 spikes = not point source
-    return false;
+template <typename Layout>
+void IRFlameSensorT<Layout>::refreshMargin(uint8_t channel) {
+    if (!autoMargin || quietUpdates[channel] < IR_AUTO_MARGIN_WARMUP) {
+        setMargin(channel, sensitivityMargin);
+        return;
+    }
+
+    float margin = IR_AUTO_MARGIN_K * sqrtf(residualVariance[channel]);
+    if (margin < IR_AUTO_MARGIN_MIN_MV) margin = IR_AUTO_MARGIN_MIN_MV;
+    if (margin > IR_AUTO_MARGIN_MAX_MV) margin = IR_AUTO_MARGIN_MAX_MV;
+    setMargin(channel, margin);
+}
+
+// The only writer of the margins, so the Q16.16 copy for the integer
+// pipeline is converted here and never per update
+template <typename Layout>
+void IRFlameSensorT<Layout>::setMargin(uint8_t channel, float milliVolts) {
+    marginMilliVolts[channel] = milliVolts;
+    marginQ16[channel] = (int32_t)(milliVolts * IR_Q16_ONE);
+}
+
+template <typename Layout>
+void IRFlameSensorT<Layout>::setAutoMargin(bool enabled) {
+    autoMargin = enabled;
+    for (int i = 0; i < Layout::channels; i++) {
+        refreshMargin(i);
+    }
+    Serial.printf("[IRFlameSensor] Auto margin %s\n", enabled ? "enabled" : "disabled");
+}
+
+template <typename Layout>
+bool IRFlameSensorT<Layout>::isAutoMargin() const {
+    return autoMargin;
 }
 
 // ============================================================================
-// SPATIAL VOTING: Ambient Interference Detection
-// True if >3 sensors (4 or 5) show spike simultaneously
-// Typical signature of direct sunlight or room-wide IR source
+// SPIKE HISTORY
+// Shift each channel's spike flag into a 64-bit register; persistence is
+// then a popcount over the newest SPIKE_HISTORY_WINDOW bits, O(1) per update
 // ============================================================================
-bool IRFlameSensor::isAmbientInterference() const {
-    uint8_t spikeCount = countActiveSpikes();
-    return spikeCount >= AMBIENT_INTERFERENCE_MIN;
+template <typename Layout>
+void IRFlameSensorT<Layout>::recordSpikeHistory() {
+    unsigned long now = millis();
+    for (int i = 0; i < Layout::channels; i++) {
+        spikeHistory[i] = (spikeHistory[i] << 1) | ((spikeMask >> i) & 1);
+        if (spikeHistory[i] & 1) {
+            lastSpikeTime[i] = now;
+        }
+    }
+}
+
+// A detection stays alive while some channel (or adjacent pair, for a flame
+// between two sensors; on a ring the last channel neighbours the first)
+// keeps SPIKE_DUTY_PERCENT over the last SPIKE_HISTORY_WINDOW updates.
+// Updates before the detection started count as hits, so a young detection
+// may miss as many updates as an old one.
+template <typename Layout>
+bool IRFlameSensorT<Layout>::spikeDutyMet() const {
+    const uint8_t required = (SPIKE_HISTORY_WINDOW * SPIKE_DUTY_PERCENT + 99) / 100;
+    const uint8_t allowedMisses = SPIKE_HISTORY_WINDOW - required;
+
+    uint8_t window = (updatesSincePotential < SPIKE_HISTORY_WINDOW) ? updatesSincePotential : SPIKE_HISTORY_WINDOW;
+    uint64_t mask = (window >= 64) ? ~0ULL : ((1ULL << window) - 1);
+
+    for (int i = 0; i < Layout::channels; i++) {
+        uint64_t history = spikeHistory[i];
+        if (i + 1 < Layout::channels) {
+            history |= spikeHistory[i + 1];
+        } else if (Layout::topology == IR_TOPOLOGY_RING && Layout::channels > 2) {
+            history |= spikeHistory[0];
+        }
+
+        uint8_t misses = window - __builtin_popcountll(history & mask);
+        if (misses <= allowedMisses) return true;
+    }
+    return false;
+}
+
+// Some channel spiked within the last SPIKE_HISTORY_WINDOW updates
+template <typename Layout>
+bool IRFlameSensorT<Layout>::recentSpikes() const {
+    const uint64_t mask = (1ULL << SPIKE_HISTORY_WINDOW) - 1;
+    for (int i = 0; i < Layout::channels; i++) {
+        if (spikeHistory[i] & mask) return true;
+    }
+    return false;
 }
 
 // ============================================================================
 // SPATIAL PATTERN EVALUATION
-// Categorize detection type and set state
+// The spike bitmask is classified with one lookup in the layout's 2^N table
+// (IRArrayLayout.h):
+//   POINT      1 sensor or 2 neighbouring sensors = potential flame
+//   AMBIENT    ambientMin+ sensors = sunlight, room reflection, etc.;
+//              cleared once no channel spiked for SPIKE_HISTORY_WINDOW
+//   SCATTERED  anything else, state left unchanged
 // ============================================================================
-void IRFlameSensor::evaluateSpatialPattern() {
-    uint8_t spikeCount = countActiveSpikes();
+template <typename Layout>
+void IRFlameSensorT<Layout>::evaluateSpatialPattern() {
+    if ((currentState == FLAME_POTENTIAL || currentState == FLAME_DETECTED) && updatesSincePotential < 64) {
+        updatesSincePotential++;
+    }
+
+    switch (IRSpatialTable<Layout>::classify(spikeMask)) {
+        case IR_SPATIAL_IDLE:
+            // No spikes detected: a flickering flame may miss a few updates,
+            // only give up once the spike duty drops below SPIKE_DUTY_PERCENT
+            if ((currentState == FLAME_POTENTIAL || currentState == FLAME_DETECTED) && !spikeDutyMet()) {
+                currentState = FLAME_IDLE;
+                potentialFlameStartTime = 0;
+            }
+            // Ambient source gone (a passing cloud leaves a short gap, so
+            // wait for a whole quiet window): arming, snapshots and margin
+            // learning all wait for IDLE
+            if (currentState == FLAME_AMBIENT_INTERFERENCE && !recentSpikes()) {
+                currentState = FLAME_IDLE;
+            }
+            break;
 
-    if (spikeCount == 0) {
-        // No spikes detected
-        if (currentState == FLAME_POTENTIAL) {
-            // Lost spike, return to idle
-            currentState = FLAME_IDLE;
+        case IR_SPATIAL_AMBIENT:
+            currentState = FLAME_AMBIENT_INTERFERENCE;
             potentialFlameStartTime = 0;
+            break;
+
+        case IR_SPATIAL_POINT:
+            currentState = pointSourceState(currentState);
+
+            // Record time of first potential flame detection
+            if (potentialFlameStartTime == 0) {
+                potentialFlameStartTime = millis();
+                updatesSincePotential = 1;
+            }
+            break;
+
+        case IR_SPATIAL_SCATTERED:
+            break;
+    }
+}
+
+// ============================================================================
+// HIGH-RATE PATH (flicker band, FIR prefilter)
+// A 100 Hz stream per channel (each sample a ~10ms average of the DMA ring,
+// which also nulls 100 Hz mains ripple) runs through a Goertzel bank. Only a
+// block during which the channel was a spike from start to end gets a
+// verdict, so the step at spike onset is never mistaken for flicker.
+// ============================================================================
+template <typename Layout>
+void IRFlameSensorT<Layout>::updateHighRate() {
+    static_assert(Layout::channels <= IR_NUM_CHANNELS, "ADC scan slots are sized for IRActiveLayout");
+
+    // Without DMA every sample is a blocking analogRead(), keep that cheap
+    uint16_t window = adcSampler.isRunning() ? FLICKER_ADC_WINDOW : 1;
+
+    for (int i = 0; i < Layout::channels; i++) {
+        float milliVolts = adcSampler.averageMilliVolts(i, window);
+
+#if IR_FIR_PREFILTER
+        // Start from the first sample instead of ramping up from 0 mV
+        if (!firPrimed) firFilters[i].reset(milliVolts);
+        if (firFilters[i].push(milliVolts, firOutput[i])) firFresh |= (1 << i);
+#endif
+
+        bool spiking = (spikeMask >> i) & 1;
+        flickerSpikeBlock[i] = flickerSpikeBlock[i] && spiking;
+
+        if (flickerBanks[i].push(milliVolts)) {
+            const FlickerResult& result = flickerBanks[i].result();
+            flickerMilliVolts[i] = result.bandRms;
+            flickerRatio[i] = result.ratio;
+
+            if (flickerSpikeBlock[i]) {
+                flickerVerdict[i] = classifyFlickerBlock(result, FLICKER_MIN_RMS_MV, FLICKER_MIN_RATIO);
+            } else {
+                flickerVerdict[i] = FLICKER_UNKNOWN;
+            }
+            flickerSpikeBlock[i] = true;
         }
-    } else if (isAmbientInterference()) {
-        // >3 sensors spiking = ambient (sunlight, room reflection, etc.)
-        currentState = FLAME_AMBIENT_INTERFERENCE;
-        potentialFlameStartTime = 0;
-    } else if (isPointSource()) {
-        // 1-2 adjacent sensors = potential flame
-        currentState = FLAME_POTENTIAL;
-
-        // Record time of first potential flame detection
-        if (potentialFlameStartTime == 0) {
-            potentialFlameStartTime = millis();
-        }
+
+        if (!spiking) flickerVerdict[i] = FLICKER_UNKNOWN;
     }
+
+#if IR_FIR_PREFILTER
+    firPrimed = true;
+#endif
 }
 
 // ============================================================================
 // TEMPORAL VERIFICATION
-// Require persistence for 500ms before declaring FLAME_DETECTED
+// Require persistence for 500ms before declaring FLAME_DETECTED. With flicker
+// detection a spiking channel that flickers confirms at once (after one full
+// 250ms block), and a spike that is known to be steady needs
+// FLICKER_STEADY_CONFIRM_MS instead: a heat lamp is held back, a flame
+// flickering below FLICKER_MIN_RMS_MV is still confirmed.
 // ============================================================================
-void IRFlameSensor::evaluateTemporal() {
+template <typename Layout>
+void IRFlameSensorT<Layout>::evaluateTemporal() {
     if (currentState == FLAME_POTENTIAL) {
         unsigned long persistenceTime = millis() - potentialFlameStartTime;
+        unsigned long requiredTime = TEMPORAL_VERIFICATION_MS;
+
+#if FLICKER_DETECTION
+        bool flickering = false;
+        bool steady = false;
+        for (int i = 0; i < Layout::channels; i++) {
+            if (!((spikeMask >> i) & 1)) continue;
+            if (flickerVerdict[i] == FLICKER_PRESENT) flickering = true;
+            if (flickerVerdict[i] == FLICKER_STEADY) steady = true;
+        }
+
+        requiredTime = flickerConfirmMs(flickering, steady, TEMPORAL_VERIFICATION_MS, FLICKER_STEADY_CONFIRM_MS);
+#endif
 
-        if (persistenceTime >= TEMPORAL_VERIFICATION_MS) {
+        if (persistenceTime >= requiredTime) {
             // Potential flame has persisted long enough
             currentState = FLAME_DETECTED;
-            Serial.printf("[IRFlameSensor] FLAME DETECTED after %lu ms persistence!\n", persistenceTime);
+            if (requiredTime == 0) {
+                Serial.printf("[IRFlameSensor] FLAME DETECTED after %lu ms (flicker confirmed)!\n", persistenceTime);
+            } else {
+                Serial.printf("[IRFlameSensor] FLAME DETECTED after %lu ms persistence%s!\n", persistenceTime,
+                              (requiredTime > TEMPORAL_VERIFICATION_MS) ? " (steady IR)" : "");
+            }
         }
     }
 }
 
+// ============================================================================
+// PEAK DETECTION & SCORING
+// Sliding max/min of the deviation (monotonic deques, O(1) per update) give
+// the recent peak and the peak-to-trough swing. Together with the present
+// deviation they score each channel 0-100:
+//   level - deviation relative to 2x the margin  (CONFIDENCE_WEIGHT_LEVEL)
+//   peak  - window peak relative to 2x the margin (CONFIDENCE_WEIGHT_PEAK)
+//   range - swing relative to the margin; flames flicker, lamps do not
+// ============================================================================
+static float clampUnit(float value) {
+    return (value < 0.0f) ? 0.0f : (value > 1.0f ? 1.0f : value);
+}
+
+template <typename Layout>
+void IRFlameSensorT<Layout>::scorePeaks() {
+    uint8_t best = 0;
+
+    for (int i = 0; i < Layout::channels; i++) {
+        float margin = (marginMilliVolts[i] > 0.0f) ? marginMilliVolts[i] : 1.0f;
+
+        deviationExtrema[i].push(deviation[i]);
+        peakDeviation[i] = deviationExtrema[i].max();
+        troughDeviation[i] = deviationExtrema[i].min();
+
+        float level = clampUnit(deviation[i] / (2.0f * margin));
+        float peak = clampUnit(peakDeviation[i] / (2.0f * margin));
+        float range = clampUnit((peakDeviation[i] - troughDeviation[i]) / margin);
+
+        float score = CONFIDENCE_WEIGHT_LEVEL * level +
+                      CONFIDENCE_WEIGHT_PEAK * peak +
+                      CONFIDENCE_WEIGHT_RANGE * range;
+        confidence[i] = (uint8_t)(score > 100.0f ? 100.0f : score + 0.5f);
+        if (confidence[i] > best) best = confidence[i];
+    }
+
+    // Room-wide IR is not a flame, however strong
+    overallConfidence = (currentState == FLAME_AMBIENT_INTERFERENCE) ? 0 : best;
+}
+
 // ============================================================================
 // MAIN UPDATE FUNCTION
 // Call this regularly (every 50ms or more frequent)
 // Non-blocking operation
 // ============================================================================
-void IRFlameSensor::update() {
+template <typename Layout>
+void IRFlameSensorT<Layout>::update() {
     unsigned long now = millis();
 
     // Check if it's time for update (FLAME_DETECTION_UPDATE_MS interval)
@@ -183,68 +747,174 @@ void IRFlameSensor::update() {
     }
     lastUpdateTime = now;
 
-    // -------- STEP 1: DATA CLEANING (OVERSAMPLING) --------
-    // Read all 5 channels with 64-sample averaging
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
-        channels[i].rawMilliVolts = readChannelMilliVolts(i);
+    updateNow();
+}
+
+template <typename Layout>
+void IRFlameSensorT<Layout>::updateNow() {
+    // -------- STEP 1: DATA CLEANING (OVERSAMPLING / FIR) --------
+    // Take the finished 64-sample averages; skip this round if none is ready
+#if IR_FIR_PREFILTER
+    if (!readFilteredChannels()) {
+        return;
     }
+#else
+    if (!readOversampledChannels()) {
+        return;
+    }
+#endif
+    rejectOutliers();
+    detectShifts();
 
     // -------- STEP 2: DYNAMIC BASELINE (EMA) --------
     updateBaselines();
+    learnMargins();
+
+    recordSpikeHistory();
 
     // -------- STEP 3: SPATIAL VOTING --------
     evaluateSpatialPattern();
+    checkArmed();
 
     // -------- STEP 4: TEMPORAL VERIFICATION --------
     evaluateTemporal();
+
+    // -------- STEP 5: PEAK DETECTION & SCORING --------
+    scorePeaks();
+
+    saveSnapshot();
 }
 
 // ============================================================================
 // PUBLIC GETTERS
 // ============================================================================
-FlameDetectionState IRFlameSensor::getFlameState() const {
+template <typename Layout>
+FlameDetectionState IRFlameSensorT<Layout>::getFlameState() const {
     return currentState;
 }
 
-bool IRFlameSensor::isFlameDetected() const {
+template <typename Layout>
+bool IRFlameSensorT<Layout>::isFlameDetected() const {
     return (currentState == FLAME_DETECTED);
 }
 
-const IRChannelData* IRFlameSensor::getChannelData(uint8_t channel) const {
-    if (channel >= IR_NUM_CHANNELS) return nullptr;
-    return &channels[channel];
+template <typename Layout>
+uint8_t IRFlameSensorT<Layout>::getConfidence() const {
+    return overallConfidence;
+}
+
+template <typename Layout>
+uint8_t IRFlameSensorT<Layout>::getChannelConfidence(uint8_t channel) const {
+    return (channel < Layout::channels) ? confidence[channel] : 0;
+}
+
+template <typename Layout>
+void IRFlameSensorT<Layout>::setPeakWindow(uint16_t updates) {
+    for (int i = 0; i < Layout::channels; i++) {
+        deviationExtrema[i].setWindow(updates);
+    }
+}
+
+template <typename Layout>
+IRChannelData IRFlameSensorT<Layout>::getChannelData(uint8_t channel) const {
+    IRChannelData data = {};
+    if (channel >= Layout::channels) return data;
+
+    data.rawMilliVolts = rawMilliVolts[channel];
+    data.baseline = baseline[channel];
+    data.deviation = deviation[channel];
+    data.isSpike = (spikeMask >> channel) & 1;
+    data.lastSpikeTime = lastSpikeTime[channel];
+    data.spikeHistory = spikeHistory[channel];
+    data.noiseMilliVolts = noiseMilliVolts[channel];
+    data.samplesPerUpdate = samplesPerUpdate[channel];
+    data.flickerMilliVolts = flickerMilliVolts[channel];
+    data.flickerRatio = flickerRatio[channel];
+    data.peakDeviation = peakDeviation[channel];
+    data.troughDeviation = troughDeviation[channel];
+    data.confidence = confidence[channel];
+    data.shift = shiftDetectors[channel].shift();
+    data.shiftLevel = shiftDetectors[channel].upperLevel();
+    data.marginMilliVolts = marginMilliVolts[channel];
+    data.residualSigma = (quietUpdates[channel] >= IR_AUTO_MARGIN_WARMUP) ? sqrtf(residualVariance[channel]) : 0.0f;
+    return data;
+}
+
+template <typename Layout>
+uint32_t IRFlameSensorT<Layout>::getSpikeMask() const {
+    return spikeMask;
 }
 
-void IRFlameSensor::getAllRawValues(uint16_t* values) const {
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
-        values[i] = channels[i].rawMilliVolts;
+template <typename Layout>
+void IRFlameSensorT<Layout>::getAllRawValues(uint16_t* values) const {
+    for (int i = 0; i < Layout::channels; i++) {
+        values[i] = rawMilliVolts[i];
     }
 }
 
-void IRFlameSensor::getAllBaselines(float* baselines) const {
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
-        baselines[i] = channels[i].baseline;
+template <typename Layout>
+void IRFlameSensorT<Layout>::getAllBaselines(float* baselines) const {
+    for (int i = 0; i < Layout::channels; i++) {
+        baselines[i] = baseline[i];
     }
 }
 
-void IRFlameSensor::setSensitivityMargin(uint16_t margin) {
+template <typename Layout>
+void IRFlameSensorT<Layout>::setSensitivityMargin(uint16_t margin) {
     sensitivityMargin = margin;
+    for (int i = 0; i < Layout::channels; i++) {
+        refreshMargin(i);
+    }
     Serial.printf("[IRFlameSensor] Sensitivity margin updated to %d mV\n", margin);
 }
 
-uint16_t IRFlameSensor::getSensitivityMargin() const {
+template <typename Layout>
+uint16_t IRFlameSensorT<Layout>::getSensitivityMargin() const {
     return sensitivityMargin;
 }
 
-void IRFlameSensor::resetBaselines() {
+template <typename Layout>
+uint32_t IRFlameSensorT<Layout>::getSamplesPerSecond() const {
+    return samplesPerSecond;
+}
+
+template <typename Layout>
+uint32_t IRFlameSensorT<Layout>::getConversionsPerSecond() const {
+    return conversionsPerSecond;
+}
+
+template <typename Layout>
+void IRFlameSensorT<Layout>::resetBaselines() {
     Serial.println("[IRFlameSensor] Resetting all baselines...");
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
-        channels[i].baseline = 0.0f;
-        channels[i].isSpike = false;
-        channels[i].lastSpikeTime = 0;
+    for (int i = 0; i < Layout::channels; i++) {
+        baseline[i] = 0.0f;
+        lastSpikeTime[i] = 0;
+        spikeHistory[i] = 0;
+        baselineQ16[i] = 0;
+        deviationQ16[i] = 0;
+        flickerBanks[i].reset();
+        flickerSpikeBlock[i] = true;
+        flickerVerdict[i] = FLICKER_UNKNOWN;
+        outlierFilters[i].reset();
+        deviationExtrema[i].reset();
+        shiftDetectors[i].reset();
+        confidence[i] = 0;
+        // Learned margins are kept: the noise belongs to the channel, not the baseline
     }
+    spikeMask = 0;
+    shiftMask = 0;
+    overallConfidence = 0;
     currentState = FLAME_IDLE;
     potentialFlameStartTime = 0;
+    updatesSincePotential = 0;
+
+    // Seed again from the next reading; the old snapshot is no longer wanted
+    warmupUpdates = 0;
+    snapshotPending = false;
+    baselineRestored = false;
+    armStartTime = millis();
+    timeToArmed = 0;
+    irBaselineSnapshot<Layout>().magic = 0;
 }
 
 // ============================================================================
@@ -252,7 +922,8 @@ void IRFlameSensor::resetBaselines() {
 // Optimized for Serial Plotter visualization
 // Format: Raw0,Baseline0,Raw1,Baseline1,...
 // ============================================================================
-void IRFlameSensor::printDebugInfo() {
+template <typename Layout>
+void IRFlameSensorT<Layout>::printDebugInfo() {
     Serial.println("\n================ FLAME DETECTOR STATUS ================");
 
     // State info
@@ -275,28 +946,52 @@ void IRFlameSensor::printDebugInfo() {
     }
 
     Serial.printf("State: %s\n", stateStr);
-    Serial.printf("Active Spikes: %d/5\n", countActiveSpikes());
-    Serial.printf("Sensitivity: %d mV\n", sensitivityMargin);
+    Serial.printf("Active Spikes: %d/%d\n", __builtin_popcount(spikeMask), Layout::channels);
+    Serial.printf("Confidence: %d%%\n", overallConfidence);
+    Serial.printf("Sensitivity: %d mV (auto margin %s)\n", sensitivityMargin, autoMargin ? "on" : "off");
+    Serial.printf("ADC samples/s: %lu used, %lu converted (%s)\n", (unsigned long)samplesPerSecond,
+                  (unsigned long)conversionsPerSecond,
+                  irOversampler.isTimerDriven() ? "esp_timer: adaptive counts save conversions"
+                                                : "DMA scan: fixed rate, adaptive counts only shorten blocks");
+    if (timeToArmed != 0) {
+        Serial.printf("Armed: %lu ms after start (%s)\n", timeToArmed, baselineRestored ? "RTC snapshot" : "first read");
+    } else {
+        Serial.printf("Armed: no (warm-up %d/%d)\n", warmupUpdates, IR_WARMUP_UPDATES);
+    }
     Serial.println("\nChannel Data:");
-    Serial.println("CH  |   Raw(mV)  |  Base(mV)  |  Dev(mV)  | Spike");
-    Serial.println("----|------------|------------|-----------|------");
+    Serial.println("CH  |   Raw(mV)  |  Base(mV)  |  Dev(mV)  | Spike | Noise(mV) | N  | Flicker(mV/ratio) | Peak/Trough(mV) | Conf | Shift      | Margin(mV)");
+    Serial.println("----|------------|------------|-----------|-------|-----------|----|-------------------|-----------------|------|------------|-----------");
 
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
-        Serial.printf(" %d  | %10d | %10.1f | %9.1f | %s\n",
+    for (int i = 0; i < Layout::channels; i++) {
+        Serial.printf(" %d  | %10d | %10.1f | %9.1f | %-5s | %9.1f | %2d | %6.1f / %.2f     | %6.0f / %6.0f | %3d  | %+d / %.2f  | %6.0f%s\n",
                       i,
-                      channels[i].rawMilliVolts,
-                      channels[i].baseline,
-                      channels[i].deviation,
-                      channels[i].isSpike ? "YES" : "NO");
+                      rawMilliVolts[i],
+                      baseline[i],
+                      deviation[i],
+                      ((spikeMask >> i) & 1) ? "YES" : "NO",
+                      noiseMilliVolts[i],
+                      samplesPerUpdate[i],
+                      flickerMilliVolts[i],
+                      flickerRatio[i],
+                      peakDeviation[i],
+                      troughDeviation[i],
+                      confidence[i],
+                      shiftDetectors[i].shift(),
+                      shiftDetectors[i].upperLevel(),
+                      marginMilliVolts[i],
+                      (autoMargin && quietUpdates[i] >= IR_AUTO_MARGIN_WARMUP) ? " (auto)" : "");
     }
 
     Serial.println("======================================================\n");
 
     // CSV format for Serial Plotter (one line, tab or comma separated)
     Serial.print("[PLOTTER] ");
-    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+    for (int i = 0; i < Layout::channels; i++) {
         if (i > 0) Serial.print("\t");
-        Serial.printf("%.0f\t%.0f", channels[i].rawMilliVolts * 1.0f, channels[i].baseline);
+        Serial.printf("%.0f\t%.0f", rawMilliVolts[i] * 1.0f, baseline[i]);
     }
     Serial.println();
 }
+
+// Only the layout the board is built for is compiled
+template class IRFlameSensorT<IRActiveLayout>;
@@ -0,0 +1,135 @@
+#include "IROversampler.h"
+#include "AdcSampler.h"
+#include "Config.h"
+
+IROversampler irOversampler;
+
+// ============================================================================
+// CONSTRUCTOR
+// ============================================================================
+IROversampler::IROversampler()
+    : channelsDone(0),
+      phase(PHASE_ACCUMULATING),
+      conversionCount(0),
+      timer(NULL),
+      nextChannel(0) {
+    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+        targets[i] = OVERSAMPLING_SAMPLES;
+        finished.meanRaw[i] = 0;
+        finished.varianceRaw[i] = 0.0f;
+        finished.samples[i] = 0;
+    }
+    resetAccumulators();
+}
+
+void IROversampler::resetAccumulators() {
+    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+        means[i] = 0.0f;
+        m2[i] = 0.0f;
+        counts[i] = 0;
+    }
+    channelsDone = 0;
+}
+
+// ============================================================================
+// INITIALIZATION
+// ============================================================================
+bool IROversampler::begin() {
+    if (adcSampler.isRunning()) {
+        // DMA pattern already scans the channels round-robin on a hardware timer
+        adcSampler.setSampleSink(onAdcSample, this);
+        Serial.println("[IROversampler] Fed by ADC DMA scan");
+        return true;
+    }
+
+    esp_timer_create_args_t args = {};
+    args.callback = onTimer;
+    args.arg = this;
+    args.dispatch_method = ESP_TIMER_TASK;
+    args.name = "ir_oversample";
+
+    if (esp_timer_create(&args, &timer) != ESP_OK ||
+        esp_timer_start_periodic(timer, OVERSAMPLER_TIMER_PERIOD_US) != ESP_OK) {
+        Serial.println("[IROversampler] Cannot start sampling timer!");
+        return false;
+    }
+
+    Serial.printf("[IROversampler] Timer-driven, one conversion every %d us\n", OVERSAMPLER_TIMER_PERIOD_US);
+    return true;
+}
+
+// ============================================================================
+// PRODUCER
+// ============================================================================
+void IROversampler::feed(uint8_t channel, uint16_t raw) {
+    if (channel >= IR_NUM_CHANNELS) return;
+    conversionCount = conversionCount + 1;
+    if (phase.load(std::memory_order_acquire) != PHASE_ACCUMULATING) return;
+    if (counts[channel] >= targets[channel]) return;
+
+    // Welford update: numerically stable running mean and M2
+    uint16_t n = ++counts[channel];
+    float delta = raw - means[channel];
+    means[channel] += delta / n;
+    m2[channel] += delta * (raw - means[channel]);
+
+    if (n < targets[channel]) return;
+
+    // This channel's block is complete
+    if (++channelsDone < IR_NUM_CHANNELS) return;
+
+    for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+        finished.meanRaw[i] = (uint16_t)(means[i] + 0.5f);
+        finished.varianceRaw[i] = (counts[i] > 1) ? m2[i] / (counts[i] - 1) : 0.0f;
+        finished.samples[i] = counts[i];
+    }
+    resetAccumulators();
+    phase.store(PHASE_FINISHED, std::memory_order_release);
+}
+
+void IROversampler::onAdcSample(uint8_t slot, uint16_t raw, void* ctx) {
+    static_cast<IROversampler*>(ctx)->feed(slot, raw);
+}
+
+void IROversampler::onTimer(void* arg) {
+    IROversampler* self = static_cast<IROversampler*>(arg);
+    if (self->phase.load(std::memory_order_acquire) != PHASE_ACCUMULATING) return;
+
+    // Round-robin: one conversion per tick, skipping channels already full,
+    // so channels that need fewer samples also cost fewer conversions
+    for (int tries = 0; tries < IR_NUM_CHANNELS; tries++) {
+        uint8_t channel = self->nextChannel;
+        self->nextChannel = (channel + 1) % IR_NUM_CHANNELS;
+        if (self->counts[channel] < self->targets[channel]) {
+            self->feed(channel, analogRead(AdcSampler::slotPin(channel)));
+            return;
+        }
+    }
+}
+
+// ============================================================================
+// CONSUMER
+// ============================================================================
+bool IROversampler::collect(IROversampleBlock& block, const uint16_t* nextTargets) {
+    if (phase.load(std::memory_order_acquire) != PHASE_FINISHED) return false;
+
+    block = finished;
+    if (nextTargets) {
+        for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+            uint16_t target = nextTargets[i];
+            if (target < 1) target = 1;
+            if (target > OVERSAMPLING_SAMPLES) target = OVERSAMPLING_SAMPLES;
+            targets[i] = target;
+        }
+    }
+    phase.store(PHASE_ACCUMULATING, std::memory_order_release);
+    return true;
+}
+
+uint32_t IROversampler::getConversionCount() const {
+    return conversionCount;
+}
+
+bool IROversampler::isTimerDriven() const {
+    return timer != NULL;
+}
@@ -0,0 +1,44 @@
+#include "MQ2Table.h"
+#include "Config.h"
+#include <math.h>
+
+#define MQ2_ADC_MAX_CODE            ((1 << MQ2_ADC_BIT_RESOLUTION) - 1)
+
+MQ2PPMTable::MQ2PPMTable() {
+    for (int i = 0; i < MQ2_TABLE_KNOTS; i++) {
+        knots[i] = 0.0f;
+    }
+}
+
+// Same steps as MQUnifiedsensor::getVoltage() + readSensor() (regression method 1)
+float MQ2PPMTable::computePPM(float adcCode) {
+    float volts = adcCode * MQ2_VOLTAGE_RESOLUTION / MQ2_ADC_MAX_CODE;
+    if (volts <= 0.0f) return 0.0f;
+
+    float rs = ((MQ2_VOLTAGE_RESOLUTION * MQ2_LOAD_RESISTANCE) / volts) - MQ2_LOAD_RESISTANCE;
+    if (rs < 0.0f) rs = 0.0f;
+
+    float ratio = rs / MQ2_R0;
+    if (ratio <= 0.0f) return MQ2_PPM_CEILING;
+
+    float ppm = MQ2_A * powf(ratio, MQ2_B);
+    if (ppm < 0.0f) return 0.0f;
+    return (ppm > MQ2_PPM_CEILING) ? MQ2_PPM_CEILING : ppm;
+}
+
+void MQ2PPMTable::build() {
+    for (int i = 0; i < MQ2_TABLE_KNOTS; i++) {
+        int code = i * MQ2_TABLE_STEP;
+        knots[i] = computePPM(code > MQ2_ADC_MAX_CODE ? MQ2_ADC_MAX_CODE : code);
+    }
+}
+
+float MQ2PPMTable::lookup(float adcCode) const {
+    if (adcCode <= 0.0f) return knots[0];
+    if (adcCode >= MQ2_ADC_MAX_CODE) return knots[MQ2_TABLE_KNOTS - 1];
+
+    float position = adcCode / MQ2_TABLE_STEP;
+    int index = (int)position;
+    float fraction = position - index;
+    return knots[index] + (knots[index + 1] - knots[index]) * fraction;
+}
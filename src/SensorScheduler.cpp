@@ -0,0 +1,160 @@
+#include "SensorScheduler.h"
+
+// Signed difference so comparisons survive the 71-minute micros() wrap
+static inline int32_t usSince(uint32_t now, uint32_t then) {
+    return (int32_t)(now - then);
+}
+
+// ============================================================================
+// CONSTRUCTOR / REGISTRATION
+// ============================================================================
+SensorScheduler::SensorScheduler()
+    : taskCount(0) {
+}
+
+int8_t SensorScheduler::addTask(const char* name, uint32_t periodMs, uint32_t deadlineMs,
+                                SchedPollFn poll, SchedCompleteFn complete, void* ctx) {
+    if (taskCount >= SCHED_MAX_TASKS || poll == NULL || periodMs == 0) return -1;
+
+    Task& task = tasks[taskCount];
+    memset(&task, 0, sizeof(task));
+    task.name = name;
+    task.periodUs = periodMs * 1000UL;
+    task.deadlineUs = (deadlineMs ? deadlineMs : periodMs) * 1000UL;
+    task.poll = poll;
+    task.complete = complete;
+    task.ctx = ctx;
+    return taskCount++;
+}
+
+void SensorScheduler::start() {
+    uint32_t now = micros();
+    for (uint8_t i = 0; i < taskCount; i++) {
+        tasks[i].nextReleaseUs = now;
+        tasks[i].pending = false;
+    }
+}
+
+// ============================================================================
+// DISPATCH
+// ============================================================================
+void SensorScheduler::releaseDueJobs(uint32_t now) {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        Task& task = tasks[i];
+        if (task.pending || usSince(now, task.nextReleaseUs) < 0) continue;
+
+        task.pending = true;
+        task.started = false;
+        task.jobExecUs = 0;
+        task.releaseUs = task.nextReleaseUs;
+        task.absDeadlineUs = task.releaseUs + task.deadlineUs;
+        task.nextReleaseUs += task.periodUs;
+
+        // Overrun: whole periods passed without a release, count them as missed
+        while (usSince(now, task.nextReleaseUs) >= 0) {
+            task.nextReleaseUs += task.periodUs;
+            task.stats.missedDeadlines++;
+        }
+    }
+}
+
+// A started job that is still pending is waiting on its driver and only
+// gets polled again once its re-poll interval has passed
+bool SensorScheduler::isRunnable(const Task& task, uint32_t now) const {
+    if (!task.pending) return false;
+    return !task.started || usSince(now, task.nextPollUs) >= 0;
+}
+
+void SensorScheduler::finishJob(Task& task) {
+    task.pending = false;
+    task.stats.jobs++;
+    task.stats.totalExecUs += task.jobExecUs;
+    if (task.jobExecUs > task.stats.maxExecUs) task.stats.maxExecUs = task.jobExecUs;
+    if (usSince(micros(), task.absDeadlineUs) > 0) task.stats.missedDeadlines++;
+
+    if (task.complete) task.complete(task.ctx);
+}
+
+uint32_t SensorScheduler::runOnce() {
+    uint32_t now = micros();
+    releaseDueJobs(now);
+
+    // Earliest deadline first among runnable jobs
+    Task* next = NULL;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        if (!isRunnable(tasks[i], now)) continue;
+        if (next == NULL || usSince(tasks[i].absDeadlineUs, next->absDeadlineUs) < 0) {
+            next = &tasks[i];
+        }
+    }
+
+    if (next) {
+        uint32_t begin = micros();
+        if (!next->started) {
+            uint32_t jitter = (uint32_t)usSince(begin, next->releaseUs);
+            next->started = true;
+            next->stats.totalReleaseJitterUs += jitter;
+            if (jitter > next->stats.maxReleaseJitterUs) next->stats.maxReleaseJitterUs = jitter;
+        }
+
+        bool done = next->poll(next->ctx);
+        next->jobExecUs += micros() - begin;
+
+        if (done) {
+            finishJob(*next);
+        } else {
+            next->nextPollUs = micros() + SCHED_ASYNC_POLL_US;
+        }
+    }
+
+    // Another job is ready right now? Otherwise sleep until the next release
+    // or the next re-poll of a waiting async job, whichever comes first
+    now = micros();
+    uint32_t wait = UINT32_MAX;
+    for (uint8_t i = 0; i < taskCount; i++) {
+        const Task& task = tasks[i];
+        if (isRunnable(task, now)) return 0;
+
+        int32_t until = usSince(task.pending ? task.nextPollUs : task.nextReleaseUs, now);
+        if (until <= 0) return 0;
+        if ((uint32_t)until < wait) wait = until;
+    }
+    return (wait == UINT32_MAX) ? SCHED_ASYNC_POLL_US : wait;
+}
+
+// ============================================================================
+// STATISTICS
+// ============================================================================
+uint8_t SensorScheduler::getTaskCount() const {
+    return taskCount;
+}
+
+const char* SensorScheduler::getTaskName(uint8_t index) const {
+    return (index < taskCount) ? tasks[index].name : NULL;
+}
+
+bool SensorScheduler::getStats(uint8_t index, SchedTaskStats& stats) const {
+    if (index >= taskCount) return false;
+    stats = tasks[index].stats;
+    return true;
+}
+
+void SensorScheduler::resetStats() {
+    for (uint8_t i = 0; i < taskCount; i++) {
+        memset(&tasks[i].stats, 0, sizeof(SchedTaskStats));
+    }
+}
+
+void SensorScheduler::printStats(Print& out) const {
+    out.printf(" %-6s | period | dl(ms) |   jobs | missed | jit avg/max (us) | exec avg/max (us)\n", "task");
+    for (uint8_t i = 0; i < taskCount; i++) {
+        SchedTaskStats s = tasks[i].stats;
+        uint32_t jobs = s.jobs ? s.jobs : 1;
+        out.printf(" %-6s | %6lu | %6lu | %6lu | %6lu | %7lu / %6lu | %7lu / %6lu\n",
+                   tasks[i].name,
+                   (unsigned long)(tasks[i].periodUs / 1000), (unsigned long)(tasks[i].deadlineUs / 1000),
+                   (unsigned long)s.jobs, (unsigned long)s.missedDeadlines,
+                   (unsigned long)(s.totalReleaseJitterUs / jobs), (unsigned long)s.maxReleaseJitterUs,
+                   (unsigned long)(s.totalExecUs / jobs), (unsigned long)s.maxExecUs);
+    }
+}
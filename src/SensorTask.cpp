@@ -0,0 +1,131 @@
+#include "SensorTask.h"
+#include "SeqLock.h"
+#include "AnalogSensor.h"
+#include "DHT22.h"
+#include <esp_timer.h>
+
+IRFlameSensor flameSensor;
+SensorScheduler sensorScheduler;
+CusumDetector smokeChangeDetector(MQ2_CUSUM_DRIFT_PPM, MQ2_CUSUM_THRESHOLD,
+                                  SENSOR_MQ2_PERIOD_MS / 1000.0f / MQ2_CUSUM_REFERENCE_TAU_S);
+
+static SeqLock<FlameSnapshot> flamePublished;
+static SeqLock<EnvSnapshot> envPublished;
+
+// Only touched from the sensing task
+static FlameSnapshot flameSnapshot;
+static EnvSnapshot envSnapshot;
+static bool dhtStarted = false;
+
+static void publishEnv() {
+    envSnapshot.updateCount++;
+    envSnapshot.timestampUs = esp_timer_get_time();
+    envPublished.write(envSnapshot);
+}
+
+// ============================================================================
+// DRIVER CALLBACKS
+// ============================================================================
+static bool pollFlame(void*) {
+    flameSensor.updateNow();
+
+    flameSnapshot.state = flameSensor.getFlameState();
+    flameSnapshot.confidence = flameSensor.getConfidence();
+    for (uint8_t i = 0; i < IR_NUM_CHANNELS; i++) {
+        flameSnapshot.channels[i] = flameSensor.getChannelData(i);
+    }
+    flameSnapshot.samplesPerSecond = flameSensor.getSamplesPerSecond();
+    flameSnapshot.conversionsPerSecond = flameSensor.getConversionsPerSecond();
+    classifyFlameSnapshot(flameSnapshot, envSnapshot);
+    flameSnapshot.updateCount++;
+    flameSnapshot.timestampUs = esp_timer_get_time();
+    flamePublished.write(flameSnapshot);
+    return true;
+}
+
+static bool pollFlicker(void*) {
+    flameSensor.updateHighRate();
+    return true;
+}
+
+static bool pollSmoke(void*) {
+    envSnapshot.smokePPM = getMQ2PPM();
+    smokeChangeDetector.push(envSnapshot.smokePPM);
+    envSnapshot.smokeShiftLevel = smokeChangeDetector.upperLevel();
+    publishEnv();
+    return true;
+}
+
+// Asynchronous: the first poll starts the RMT transaction, later polls
+// decode it once the frame (or the capture timeout) has arrived
+static bool pollDHTJob(void*) {
+    if (!dhtStarted) {
+        startDHTReading();
+        dhtStarted = true;
+        return false;
+    }
+    return pollDHT();
+}
+
+static void completeDHTJob(void*) {
+    dhtStarted = false;
+    envSnapshot.temperature = readTemperatureSafe();
+    envSnapshot.humidity = readHumiditySafe();
+    envSnapshot.temperatureReads++;
+    publishEnv();
+}
+
+// ============================================================================
+// TASK BODY
+// Sleeps until the scheduler's next release; tick granularity shows up as
+// release jitter in the statistics
+// ============================================================================
+static void sensorTask(void* arg) {
+    sensorScheduler.start();
+
+    for (;;) {
+        uint32_t waitUs = sensorScheduler.runOnce();
+        if (waitUs > 0) {
+            TickType_t ticks = pdMS_TO_TICKS(waitUs / 1000);
+            vTaskDelay(ticks > 0 ? ticks : 1);
+        }
+    }
+}
+
+bool startSensorTask() {
+    flameSensor.init();
+
+    envSnapshot.smokePPM = 0;
+    envSnapshot.smokeShiftLevel = 0;
+    envSnapshot.temperature = -999.0f;
+    envSnapshot.humidity = -999.0f;
+
+    sensorScheduler.addTask("ir", SENSOR_IR_PERIOD_MS, SENSOR_IR_DEADLINE_MS, pollFlame);
+    sensorScheduler.addTask("flickr", SENSOR_FLICKER_PERIOD_MS, SENSOR_FLICKER_DEADLINE_MS, pollFlicker);
+    sensorScheduler.addTask("mq2", SENSOR_MQ2_PERIOD_MS, SENSOR_MQ2_DEADLINE_MS, pollSmoke);
+    if (isDHTAvailable()) {
+        sensorScheduler.addTask("dht22", SENSOR_DHT_PERIOD_MS, SENSOR_DHT_DEADLINE_MS, pollDHTJob, completeDHTJob);
+    } else {
+        Serial.println("[SENSORS] DHT22 driver unavailable, temperature stays invalid");
+    }
+
+    BaseType_t created = xTaskCreatePinnedToCore(sensorTask, "sensors", SENSOR_TASK_STACK, NULL,
+                                                 SENSOR_TASK_PRIORITY, NULL, SENSOR_TASK_CORE);
+    if (created != pdPASS) {
+        Serial.println("[SENSORS] Cannot create sensing task!");
+        return false;
+    }
+
+    Serial.printf("[SENSORS] Sensing task pinned to core %d: ir %d ms, flicker %d ms, mq2 %d ms, dht22 %d ms\n",
+                  SENSOR_TASK_CORE, SENSOR_IR_PERIOD_MS, SENSOR_FLICKER_PERIOD_MS,
+                  SENSOR_MQ2_PERIOD_MS, SENSOR_DHT_PERIOD_MS);
+    return true;
+}
+
+bool readFlameSnapshot(FlameSnapshot& snapshot) {
+    return flamePublished.read(snapshot);
+}
+
+bool readEnvSnapshot(EnvSnapshot& snapshot) {
+    return envPublished.read(snapshot);
+}
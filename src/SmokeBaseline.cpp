@@ -0,0 +1,175 @@
+#include "SmokeBaseline.h"
+#include "Config.h"
+#include <Preferences.h>
+
+static P2WindowQuantile smokeP50(0.50f, SMOKE_BASELINE_WINDOW);
+static P2WindowQuantile smokeP95(0.95f, SMOKE_BASELINE_WINDOW);
+
+static float pendingSum = 0.0f;
+static uint32_t pendingCount = 0;
+static unsigned long lastLearnTime = 0;
+static unsigned long lastSaveTime = 0;
+static bool unsavedChanges = false;
+static float smokeThreshold = THRESHOLD_SMOKE;
+
+#define SMOKE_BASELINE_MAGIC 0x534D4B42     // "SMKB"
+
+struct SmokeBaselineBlob {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t window;
+    P2WindowQuantile::State p50;
+    P2WindowQuantile::State p95;
+};
+
+// ============================================================================
+// THRESHOLD
+// ============================================================================
+bool isSmokeBaselineLearned() {
+    return smokeP95.count() >= SMOKE_BASELINE_MIN_SAMPLES;
+}
+
+static void recomputeThreshold() {
+#if SMOKE_ADAPTIVE_THRESHOLD
+    if (!isSmokeBaselineLearned()) {
+        smokeThreshold = THRESHOLD_SMOKE;
+        return;
+    }
+
+    float p50 = smokeP50.value();
+    float p95 = smokeP95.value();
+    float spread = SMOKE_THRESHOLD_SPREAD_K * (p95 - p50);
+    float threshold = p95 + (spread > SMOKE_THRESHOLD_MARGIN_PPM ? spread : SMOKE_THRESHOLD_MARGIN_PPM);
+
+    if (threshold < SMOKE_THRESHOLD_MIN_PPM) threshold = SMOKE_THRESHOLD_MIN_PPM;
+    if (threshold > SMOKE_THRESHOLD_MAX_PPM) threshold = SMOKE_THRESHOLD_MAX_PPM;
+    smokeThreshold = threshold;
+#else
+    smokeThreshold = THRESHOLD_SMOKE;
+#endif
+}
+
+float getSmokeThreshold() {
+    return smokeThreshold;
+}
+
+float getSmokeBackground() {
+    return isSmokeBaselineLearned() ? smokeP50.value() : SMOKE_BACKGROUND_DEFAULT_PPM;
+}
+
+float getSmokeP95() {
+    return smokeP95.value();
+}
+
+// ============================================================================
+// NVS PERSISTENCE
+// ============================================================================
+void saveSmokeBaseline() {
+    SmokeBaselineBlob blob;
+    blob.magic = SMOKE_BASELINE_MAGIC;
+    blob.version = SMOKE_BASELINE_FORMAT_VERSION;
+    blob.window = SMOKE_BASELINE_WINDOW;
+    blob.p50 = smokeP50.getState();
+    blob.p95 = smokeP95.getState();
+
+    Preferences prefs;
+    if (!prefs.begin(SMOKE_BASELINE_NVS_NAMESPACE, false)) {    // writeable
+        Serial.println("[MQ2] Smoke baseline write failed");
+        return;
+    }
+    bool ok = prefs.putBytes("state", &blob, sizeof(blob)) == sizeof(blob);
+    prefs.end();
+
+    if (!ok) {
+        Serial.println("[MQ2] Smoke baseline write failed");
+        return;
+    }
+    unsavedChanges = false;
+}
+
+static bool loadSmokeBaseline() {
+    Preferences prefs;
+    if (!prefs.begin(SMOKE_BASELINE_NVS_NAMESPACE, true)) {     // read-only
+        return false;
+    }
+
+    SmokeBaselineBlob blob;
+    bool valid = prefs.getBytes("state", &blob, sizeof(blob)) == sizeof(blob) &&
+                 blob.magic == SMOKE_BASELINE_MAGIC &&
+                 blob.version == SMOKE_BASELINE_FORMAT_VERSION &&
+                 blob.window == SMOKE_BASELINE_WINDOW;
+    prefs.end();
+
+    // Both or neither, so p50 and p95 always describe the same window
+    if (valid) {
+        P2WindowQuantile p50 = smokeP50;
+        P2WindowQuantile p95 = smokeP95;
+        valid = p50.setState(blob.p50) && p95.setState(blob.p95);
+        if (valid) {
+            smokeP50 = p50;
+            smokeP95 = p95;
+        }
+    }
+    return valid;
+}
+
+// ============================================================================
+// INITIALIZATION & LEARNING
+// ============================================================================
+void initSmokeBaseline() {
+    if (loadSmokeBaseline()) {
+        recomputeThreshold();
+        Serial.printf("[MQ2] Smoke baseline restored: p50 %.1f, p95 %.1f PPM (%lu samples) -> threshold %.1f PPM\n",
+                      smokeP50.value(), smokeP95.value(), (unsigned long)smokeP95.count(), smokeThreshold);
+    } else {
+        Serial.printf("[MQ2] No smoke baseline in NVS, threshold %d PPM until %d min learned\n",
+                      THRESHOLD_SMOKE, SMOKE_BASELINE_MIN_SAMPLES * (SMOKE_BASELINE_SAMPLE_MS / 1000) / 60);
+    }
+    lastLearnTime = millis();
+    lastSaveTime = millis();
+}
+
+void updateSmokeBaseline(float smokePPM, bool quiet) {
+    // Smoke from a real event must not become the new background
+    if (quiet && smokePPM < smokeThreshold) {
+        pendingSum += smokePPM;
+        pendingCount++;
+    }
+
+    unsigned long now = millis();
+    if (now - lastLearnTime < SMOKE_BASELINE_SAMPLE_MS) return;
+    lastLearnTime = now;
+
+    if (pendingCount > 0) {
+        float mean = pendingSum / pendingCount;
+        smokeP50.push(mean);
+        smokeP95.push(mean);
+        unsavedChanges = true;
+        recomputeThreshold();
+    }
+    pendingSum = 0.0f;
+    pendingCount = 0;
+
+    if (unsavedChanges && now - lastSaveTime >= SMOKE_BASELINE_SAVE_MS) {
+        lastSaveTime = now;
+        saveSmokeBaseline();
+    }
+}
+
+void resetSmokeBaseline() {
+    smokeP50.reset();
+    smokeP95.reset();
+    pendingSum = 0.0f;
+    pendingCount = 0;
+    recomputeThreshold();
+    saveSmokeBaseline();
+    Serial.println("[MQ2] Smoke baseline reset");
+}
+
+void printSmokeBaseline(Print& out) {
+    out.printf(" background p50 %.1f PPM, p95 %.1f PPM (%lu samples, %s)\n",
+               smokeP50.value(), smokeP95.value(), (unsigned long)smokeP95.count(),
+               isSmokeBaselineLearned() ? "learned" : "learning");
+    out.printf(" threshold %.1f PPM (fixed %d), learning every %d s\n",
+               smokeThreshold, THRESHOLD_SMOKE, SMOKE_BASELINE_SAMPLE_MS / 1000);
+}
@@ -7,6 +7,14 @@
 #include "Config.h"
 #include "DHT22.h"
 #include "AnalogSensor.h"
+#include "AdcSampler.h"
+#include "AdcCalibration.h"
+#include "SensorTask.h"
+#include "FireTrend.h"
+#include "FireFusion.h"
+#include "SmokeBaseline.h"
+#include "FireAlarm.h"
+#include "AlarmRules.h"
 
 // Watchdog Vars
 unsigned long lastConnectAttempt = 0;
@@ -17,14 +25,46 @@ const unsigned long STARTUP_GRACE_PERIOD = 5000;  // 5 detik grace period saat s
 
 // State Vars
 unsigned int dangerCount = 0;
-bool lastDangerState = false;
-bool lastWarningState = false;
 float temp_value, smoke_value;
+SensorFrame lastFrame = {};
 
 // Timer Intervals
 unsigned long lastFastCheck = 0;
 unsigned long lastSlowCheck = 0;
 
+// LED & buzzer hanya ditulis saat state alarm berubah
+static void applyAlarmOutputs(FireLevel level) {
+    digitalWrite(LED_RED, level == FIRE_BAHAYA ? HIGH : LOW);
+    digitalWrite(LED_YELLOW, level == FIRE_WASPADA ? HIGH : LOW);
+    digitalWrite(LED_GREEN, level == FIRE_AMAN ? HIGH : LOW);
+    if (level == FIRE_BAHAYA) {
+        tone(BUZZER, 1000);
+    } else {
+        noTone(BUZZER);
+    }
+}
+
+// Konfirmasi Bahaya dari aplikasi (tombol di V6)
+BLYNK_WRITE(V6) {
+    if (param.asInt()) acknowledgeFireAlarm();
+}
+
+// Setiap ganti/hapus aturan alarm dicatat sebagai event Blynk
+static void logAlarmRulesChange(size_t length, uint16_t checksum) {
+    if (length == 0) {
+        Blynk.logEvent("sys_rules", "Aturan alarm dihapus, kembali ke aturan bawaan");
+        return;
+    }
+    char text[64];
+    snprintf(text, sizeof(text), "Aturan alarm diganti: %u byte, checksum %04x", (unsigned)length, checksum);
+    Blynk.logEvent("sys_rules", text);
+}
+
+// Ganti aturan alarm tanpa flash ulang: image hex dari tools/rulec.py
+BLYNK_WRITE(ALARM_RULES_PIN) {
+    loadAlarmRulesHex(param.asStr());
+}
+
 void setup() {
     Serial.begin(115200);
     startupTime = millis();  // Catat waktu startup untuk grace period
@@ -37,10 +77,125 @@ void setup() {
     // Setup LEDC for buzzer PWM (tone)
     ledcSetup(0, 5000, 8);  // Channel 0, 5kHz, 8-bit resolution
     ledcAttachPin(BUZZER, 0);
+    applyAlarmOutputs(FIRE_AMAN);
 
     setupDHT();
+    adcCalibration.begin();
+    adcSampler.begin();
     initMQ2Sensor();
+    initSmokeBaseline();
+    startSensorTask();
     BlynkEdgent.begin();
+    initAlarmRules();  // LittleFS sudah di-mount oleh BlynkEdgent.begin()
+    setAlarmRulesChangeHandler(logAlarmRulesChange);
+
+    // Statistik scheduler sensor: "sched" atau "sched reset"
+    edgentConsole.addCommand("sched", [](int argc, const char** argv) {
+        if (argc >= 1 && 0 == strcmp(argv[0], "reset")) {
+            sensorScheduler.resetStats();
+            edgentConsole.print("scheduler stats cleared\n");
+            return;
+        }
+        sensorScheduler.printStats(edgentConsole.getStream());
+        edgentConsole.getStream().printf(" snapshot read misses %lu\n", (unsigned long)getSnapshotReadMisses());
+    });
+
+    // Prediksi tren & pra-alarm: "trend" atau "trend horizon <detik>"
+    edgentConsole.addCommand("trend", [](int argc, const char** argv) {
+        if (argc >= 2 && 0 == strcmp(argv[0], "horizon")) {
+            setPreAlarmHorizon(atof(argv[1]));
+        }
+        printFireTrend(edgentConsole.getStream());
+    });
+
+    // Skor fusi: "fusion", "fusion weight <nama input> <poin>", "fusion reset"
+    edgentConsole.addCommand("fusion", [](int argc, const char** argv) {
+        if (argc >= 1 && 0 == strcmp(argv[0], "reset")) {
+            fireFusion.reset();
+        } else if (argc >= 3 && 0 == strcmp(argv[0], "weight")) {
+            for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) {
+                if (0 == strcmp(argv[1], FireFusion::evidenceName((FusionEvidence)i))) {
+                    fireFusion.setWeight((FusionEvidence)i, atof(argv[2]));
+                }
+            }
+        }
+        printFireFusion(edgentConsole.getStream());
+    });
+
+    // Latar belakang asap adaptif: "smoke", "smoke reset", "smoke save"
+    edgentConsole.addCommand("smoke", [](int argc, const char** argv) {
+        if (argc >= 1 && 0 == strcmp(argv[0], "reset")) {
+            resetSmokeBaseline();
+        } else if (argc >= 1 && 0 == strcmp(argv[0], "save")) {
+            saveSmokeBaseline();
+        }
+        printSmokeBaseline(edgentConsole.getStream());
+    });
+
+    // State alarm: "alarm", "alarm ack" (konfirmasi Bahaya), "alarm reset" (hitungan transisi)
+    edgentConsole.addCommand("alarm", [](int argc, const char** argv) {
+        if (argc >= 1 && 0 == strcmp(argv[0], "ack")) {
+            acknowledgeFireAlarm();
+        } else if (argc >= 1 && 0 == strcmp(argv[0], "reset")) {
+            fireAlarm.resetCounters();
+        }
+        printFireAlarm(edgentConsole.getStream());
+    });
+
+    // Aturan alarm (bytecode): "rules", "rules begin|add <hex>|commit", "rules load <hex>",
+    // "rules reload", "rules clear", "rules bench [n]"
+    edgentConsole.addCommand("rules", [](int argc, const char** argv) {
+        Stream& out = edgentConsole.getStream();
+        if (argc >= 1 && 0 == strcmp(argv[0], "begin")) {
+            beginAlarmRulesUpload();
+            out.print("send the image with \"rules add <hex>\", then \"rules commit\"\n");
+            return;
+        } else if (argc >= 2 && 0 == strcmp(argv[0], "add")) {
+            if (!appendAlarmRulesHex(argv[1])) out.print("bad chunk\n");
+            return;
+        } else if (argc >= 1 && 0 == strcmp(argv[0], "commit")) {
+            commitAlarmRulesUpload();
+        } else if (argc >= 2 && 0 == strcmp(argv[0], "load")) {
+            loadAlarmRulesHex(argv[1]);
+        } else if (argc >= 1 && 0 == strcmp(argv[0], "reload")) {
+            reloadAlarmRules();
+        } else if (argc >= 1 && 0 == strcmp(argv[0], "clear")) {
+            clearAlarmRules();
+        } else if (argc >= 1 && 0 == strcmp(argv[0], "bench")) {
+            benchAlarmRules(out, (argc >= 2) ? atoi(argv[1]) : 0);
+            return;
+        }
+        printAlarmRules(out);
+    });
+
+    // Detektor CUSUM: "cusum", "cusum ir <drift mV> <ambang>", "cusum smoke <drift PPM> <ambang>"
+    edgentConsole.addCommand("cusum", [](int argc, const char** argv) {
+        if (argc >= 3 && 0 == strcmp(argv[0], "ir")) {
+            flameSensor.setChangeDetector(atof(argv[1]), atof(argv[2]));
+        } else if (argc >= 3 && 0 == strcmp(argv[0], "smoke")) {
+            smokeChangeDetector.configure(atof(argv[1]), atof(argv[2]));
+        }
+
+        Stream& out = edgentConsole.getStream();
+        FlameSnapshot flame;
+        if (readFlameSnapshot(flame)) {
+            for (int i = 0; i < IR_NUM_CHANNELS; i++) {
+                out.printf(" ir%d   shift %+d  level %.2f\n", i, flame.channels[i].shift, flame.channels[i].shiftLevel);
+            }
+        }
+        out.printf(" smoke ref %.1f PPM  level %.2f\n", smokeChangeDetector.reference(), smokeChangeDetector.upperLevel());
+        out.printf(" ir drift %.1f mV thr %.0f | smoke drift %.1f PPM thr %.0f\n",
+                   flameSensor.getChangeDrift(), flameSensor.getChangeThreshold(),
+                   smokeChangeDetector.getDrift(), smokeChangeDetector.getThreshold());
+    });
+
+    // Classifier api/gangguan: "model", "model trace on|off" (rekam data latih [MLTRACE])
+    edgentConsole.addCommand("model", [](int argc, const char** argv) {
+        if (argc >= 2 && 0 == strcmp(argv[0], "trace")) {
+            setFlameModelTrace(0 == strcmp(argv[1], "on"));
+        }
+        printFlameModel(edgentConsole.getStream());
+    });
     lastConnectAttempt = millis();
 }
 
@@ -90,45 +245,65 @@ void loop() {
 
     // 2. FAST CHECK (100ms): Respon cepat untuk API & ASAP
     if (now - lastFastCheck >= 100) {
-        smoke_value = getMQ2PPM();
-        bool flameDetected = isFlameDetected();
-        int irAnalogValue = getIRAnalogValue();
-        bool smokeDetected = smoke_value > THRESHOLD_SMOKE;
-
-        bool dangerNow = flameDetected || (temp_value > THRESHOLD_TEMP && smokeDetected);
-        bool warningNow = !dangerNow && (smokeDetected || temp_value > THRESHOLD_TEMP);
-
-        if (dangerNow) {
-            digitalWrite(LED_RED, HIGH); digitalWrite(LED_GREEN, LOW); digitalWrite(LED_YELLOW, LOW);
-            tone(BUZZER, 1000);
-            if (!lastDangerState) {
+        // Satu frame per tick: setiap kanal IR hanya dibaca sekali
+        lastFrame = captureSensorFrame();
+        const SensorFrame& frame = lastFrame;
+        temp_value = frame.temperature;
+        smoke_value = frame.smokePPM;
+        bool flameDetected = frame.flameDetected;
+        bool smokeDetected = frame.smokePPM > getSmokeThreshold();  // Relatif thd latar belakang
+        bool tempHigh = frame.temperature > THRESHOLD_TEMP;
+
+        // Pra-alarm: tren naik diprediksi melewati ambang dalam horizon
+        updateFireTrend(frame);
+        bool preAlarm = isPreAlarm();
+
+        // Aturan lama (boolean) tetap dihitung sebagai pembanding waktu-ke-alarm
+        FireLevel legacyLevel = legacyFireLevel(flameDetected, smokeDetected, tempHigh);
+        FireLevel fusedLevel = evaluateFireFusion(frame, legacyLevel);
+
+        // Latar belakang asap hanya dipelajari saat tidak ada kejadian
+        updateSmokeBaseline(frame.smokePPM, fusedLevel == FIRE_AMAN && !preAlarm);
+
+        // State machine alarm: histeresis, waktu tinggal minimum, Bahaya terkunci
+        AlarmRequest request = requestFireAlarm(frame, preAlarm);
+        FireLevel previousLevel = fireAlarm.getState();
+        if (updateFireAlarm(request.level, now)) {
+            FireLevel level = fireAlarm.getState();
+            applyAlarmOutputs(level);
+
+            if (level == FIRE_BAHAYA) {
                 Blynk.logEvent("bahaya", "BAHAYA API!");
                 dangerCount++;
+            } else if (level == FIRE_WASPADA && previousLevel == FIRE_AMAN) {
+                // Turun dari Bahaya ke Waspada tidak perlu notifikasi baru
+                if (request.smokeHigh || request.tempHigh) {
+                    Blynk.logEvent("waspada", "Asap/Suhu Meningkat: " + String(frame.smokePPM) + " PPM / " + String(frame.temperature) + "°C");
+                } else if (request.preAlarm) {
+                    Blynk.logEvent("waspada", "Pra-alarm: ambang diprediksi terlewati dalam " + String(getPreAlarmEta(), 0) + " detik");
+                } else {
+                    Blynk.logEvent("waspada", "Skor kebakaran: " + String(fireFusion.getScore(), 0));
+                }
             }
-        } else if (warningNow) {
-            digitalWrite(LED_YELLOW, HIGH); digitalWrite(LED_GREEN, LOW); digitalWrite(LED_RED, LOW);
-            noTone(BUZZER);
-            if (!lastWarningState) Blynk.logEvent("waspada", "Asap/Suhu Meningkat: " + String(smoke_value) + " PPM / " + String(temp_value) + "°C");
-        } else {
-            digitalWrite(LED_GREEN, HIGH); digitalWrite(LED_YELLOW, LOW); digitalWrite(LED_RED, LOW);
-            noTone(BUZZER);
         }
 
-        String kondisi = lastDangerState ? "Bahaya" : (lastWarningState ? "Waspada" : "Aman");
-        Blynk.virtualWrite(V0, temp_value);
-        Blynk.virtualWrite(V1, smoke_value);
-        Blynk.virtualWrite(V2, irAnalogValue);
+        String kondisi = fireAlarm.isLatched() ? "Bahaya (konfirmasi)" : FireFusion::levelName(fireAlarm.getState());
+        Blynk.virtualWrite(V0, frame.temperature);
+        Blynk.virtualWrite(V1, frame.smokePPM);
+        Blynk.virtualWrite(V2, frame.irMax);
         Blynk.virtualWrite(V3, kondisi);
         Blynk.virtualWrite(V4, dangerCount);
+        Blynk.virtualWrite(V5, fireFusion.getScore());
 
-        lastDangerState = dangerNow;
-        lastWarningState = warningNow;
         lastFastCheck = now;
     }
 
-    // 3. SLOW CHECK (2000ms): Update DHT & Kirim ke Blynk + Serial Monitor
+    // Data latih classifier ("model trace on"), dicetak di sini, bukan di task sensor
+    printFlameModelTrace();
+
+    // 3. SLOW CHECK (2000ms): Log ke Serial Monitor (DHT22 dibaca task sensor)
     if (now - lastSlowCheck >= 2000) {
-        temp_value = readTemperatureSafe();
+        printSensorFrame(lastFrame);
         lastSlowCheck = now;
     }
 }
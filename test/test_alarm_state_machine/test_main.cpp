@@ -0,0 +1,227 @@
+#include <unity.h>
+#include <stdio.h>
+#include "AlarmStateMachine.h"
+
+// ============================================================================
+// FireAlarm confirm, dwell, latch and acknowledge, and a 1 h simulation of a
+// fusion score hovering at a threshold: the unfiltered rule against the
+// hysteresis switches plus the state machine.
+// ============================================================================
+
+#define TEST_TICK_MS        100         // loop() fast check
+#define TEST_HOUR_TICKS     36000
+#define TEST_ACK_MS         300000      // Operator acknowledges every 5 min
+#define TEST_WASPADA_SCORE  30.0f       // FUSION_WASPADA_SCORE
+#define TEST_BAHAYA_SCORE   60.0f       // FUSION_BAHAYA_SCORE
+#define TEST_WASPADA_EXIT   20.0f       // ALARM_WASPADA_EXIT_SCORE
+#define TEST_BAHAYA_EXIT    45.0f       // ALARM_BAHAYA_EXIT_SCORE
+
+static FireAlarm alarm;
+static uint32_t rngState;
+
+static uint32_t nextRandom() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+static float uniform(float lo, float hi) {
+    return lo + (hi - lo) * (nextRandom() & 0xFFFF) / 65535.0f;
+}
+
+// Near-Gaussian, unit sigma
+static float noise() {
+    float sum = 0.0f;
+    for (int k = 0; k < 4; k++) sum += uniform(-1.0f, 1.0f);
+    return sum * 0.866f;
+}
+
+// Feed `level` every tick over [from, to); returns the time of the first
+// transition, or -1
+static long hold(FireLevel level, unsigned long from, unsigned long to) {
+    long changedAt = -1;
+    for (unsigned long t = from; t < to; t += TEST_TICK_MS) {
+        if (alarm.update(level, t) && changedAt < 0) changedAt = (long)t;
+    }
+    return changedAt;
+}
+
+void setUp() {
+    alarm = FireAlarm();
+    rngState = 12345;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_hysteresis_switch() {
+    HysteresisSwitch sw(30.0f, 20.0f);
+    TEST_ASSERT_FALSE(sw.update(30.0f));
+    TEST_ASSERT_TRUE(sw.update(30.5f));
+    TEST_ASSERT_TRUE(sw.update(21.0f));             // Between exit and enter: holds
+    TEST_ASSERT_TRUE(sw.update(20.0f));
+    TEST_ASSERT_FALSE(sw.update(19.5f));
+    TEST_ASSERT_FALSE(sw.update(29.0f));
+    sw.update(40.0f);
+    sw.reset();
+    TEST_ASSERT_FALSE(sw.isOn());
+}
+
+void test_waspada_needs_confirm() {
+    // A blip shorter than the confirm time never reaches the outputs
+    TEST_ASSERT_EQUAL(-1, hold(FIRE_WASPADA, 0, ALARM_WASPADA_CONFIRM_MS));
+    TEST_ASSERT_EQUAL(-1, hold(FIRE_AMAN, 1000, 2000));
+    TEST_ASSERT_EQUAL(FIRE_AMAN, alarm.getState());
+
+    TEST_ASSERT_EQUAL(2000 + ALARM_WASPADA_CONFIRM_MS, hold(FIRE_WASPADA, 2000, 5000));
+    TEST_ASSERT_EQUAL(FIRE_WASPADA, alarm.getState());
+    TEST_ASSERT_EQUAL_UINT32(1, alarm.getTransitionCount(FIRE_AMAN, FIRE_WASPADA));
+}
+
+void test_bahaya_enters_at_once() {
+    TEST_ASSERT_TRUE(alarm.update(FIRE_BAHAYA, 500));
+    TEST_ASSERT_EQUAL(FIRE_BAHAYA, alarm.getState());
+    TEST_ASSERT_EQUAL_UINT32(1, alarm.getTransitionCount(FIRE_AMAN, FIRE_BAHAYA));
+}
+
+void test_dwell_retriggered_by_demand() {
+    hold(FIRE_WASPADA, 0, 2000);
+    TEST_ASSERT_EQUAL(FIRE_WASPADA, alarm.getState());
+
+    // Quiet, then one more Waspada tick at 8 s restarts the 10 s dwell
+    TEST_ASSERT_EQUAL(-1, hold(FIRE_AMAN, 2000, 8000));
+    TEST_ASSERT_FALSE(alarm.update(FIRE_WASPADA, 8000));
+    TEST_ASSERT_EQUAL(8100 + ALARM_WASPADA_DWELL_MS - TEST_TICK_MS,
+                      hold(FIRE_AMAN, 8100, 8000 + 2 * ALARM_WASPADA_DWELL_MS));
+    TEST_ASSERT_EQUAL(FIRE_AMAN, alarm.getState());
+}
+
+void test_bahaya_latches_until_acknowledged() {
+    TEST_ASSERT_FALSE(alarm.acknowledge());         // Nothing to acknowledge
+    alarm.update(FIRE_BAHAYA, 0);
+    TEST_ASSERT_TRUE(alarm.isLatched());
+
+    // Far past the dwell, still Bahaya
+    TEST_ASSERT_EQUAL(-1, hold(FIRE_AMAN, 100, 10 * ALARM_BAHAYA_DWELL_MS));
+    TEST_ASSERT_TRUE(alarm.isLatched());
+
+    TEST_ASSERT_TRUE(alarm.acknowledge());
+    TEST_ASSERT_FALSE(alarm.isLatched());
+    TEST_ASSERT_EQUAL(FIRE_BAHAYA, alarm.getState());
+    TEST_ASSERT_TRUE(alarm.update(FIRE_AMAN, 10 * ALARM_BAHAYA_DWELL_MS));
+    TEST_ASSERT_EQUAL(FIRE_AMAN, alarm.getState());
+
+    // A new Bahaya latches again
+    alarm.update(FIRE_BAHAYA, 11 * ALARM_BAHAYA_DWELL_MS);
+    TEST_ASSERT_TRUE(alarm.isLatched());
+}
+
+void test_acknowledged_bahaya_keeps_dwell() {
+    alarm.update(FIRE_BAHAYA, 0);
+    alarm.acknowledge();
+    hold(FIRE_BAHAYA, 0, 5000);
+    // Drops to what is still asked for, only after the Bahaya dwell
+    TEST_ASSERT_EQUAL(4900 + ALARM_BAHAYA_DWELL_MS, hold(FIRE_WASPADA, 5000, 60000));
+    TEST_ASSERT_EQUAL(FIRE_WASPADA, alarm.getState());
+}
+
+void test_counters() {
+    hold(FIRE_WASPADA, 0, 2000);
+    alarm.update(FIRE_BAHAYA, 2000);
+    alarm.acknowledge();
+    hold(FIRE_AMAN, 2100, 40000);
+    TEST_ASSERT_EQUAL_UINT32(3, alarm.getTransitions());
+    TEST_ASSERT_EQUAL_UINT32(1, alarm.getTransitionCount(FIRE_BAHAYA, FIRE_AMAN));
+    TEST_ASSERT_EQUAL_UINT32(3, alarm.getRequestChanges());
+    TEST_ASSERT_EQUAL_UINT32(40000 - (2000 + ALARM_BAHAYA_DWELL_MS), alarm.getTimeInState(40000));
+
+    alarm.resetCounters();
+    TEST_ASSERT_EQUAL_UINT32(0, alarm.getTransitions());
+    TEST_ASSERT_EQUAL_UINT32(0, alarm.getRequestChanges());
+    TEST_ASSERT_EQUAL(FIRE_AMAN, alarm.getState());
+}
+
+// ----------------------------------------------------------------------------
+// One hour with the score drawn around `center` with `sigma` every tick.
+// "Old" is loop() before the state machine: raw comparisons written to the
+// outputs, an event on every rising edge.
+struct FlapResult {
+    uint32_t oldChanges, oldEvents;
+    uint32_t newTransitions, newEvents;
+};
+
+static FlapResult simulateHour(float center, float sigma) {
+    FlapResult result = {0, 0, 0, 0};
+    HysteresisSwitch waspadaSwitch(TEST_WASPADA_SCORE, TEST_WASPADA_EXIT);
+    HysteresisSwitch bahayaSwitch(TEST_BAHAYA_SCORE, TEST_BAHAYA_EXIT);
+    FireLevel oldLevel = FIRE_AMAN;
+
+    for (unsigned long tick = 0; tick < TEST_HOUR_TICKS; tick++) {
+        unsigned long now = tick * TEST_TICK_MS;
+        float score = center + sigma * noise();
+
+        FireLevel raw = (score > TEST_BAHAYA_SCORE) ? FIRE_BAHAYA
+                      : ((score > TEST_WASPADA_SCORE) ? FIRE_WASPADA : FIRE_AMAN);
+        if (raw != oldLevel) {
+            result.oldChanges++;
+            if (raw > oldLevel) result.oldEvents++;
+            oldLevel = raw;
+        }
+
+        bool danger = bahayaSwitch.update(score);
+        bool warning = waspadaSwitch.update(score);
+        FireLevel previous = alarm.getState();
+        if (alarm.update(danger ? FIRE_BAHAYA : (warning ? FIRE_WASPADA : FIRE_AMAN), now)) {
+            FireLevel level = alarm.getState();
+            if (level == FIRE_BAHAYA || (level == FIRE_WASPADA && previous == FIRE_AMAN)) result.newEvents++;
+        }
+        if (now % TEST_ACK_MS == TEST_ACK_MS - TEST_TICK_MS) alarm.acknowledge();
+    }
+    result.newTransitions = alarm.getTransitions();
+
+    char summary[128];
+    snprintf(summary, sizeof(summary), "score %.0f +/- %.0f: old %lu output changes, %lu events; new %lu transitions, %lu events",
+             center, sigma, (unsigned long)result.oldChanges, (unsigned long)result.oldEvents,
+             (unsigned long)result.newTransitions, (unsigned long)result.newEvents);
+    TEST_MESSAGE(summary);
+    return result;
+}
+
+void test_hour_hovering_below_waspada() {
+    FlapResult result = simulateHour(25.0f, 6.0f);
+    TEST_ASSERT_GREATER_THAN(5000, result.oldChanges);
+    TEST_ASSERT_EQUAL_UINT32(1, result.newTransitions);
+    TEST_ASSERT_EQUAL_UINT32(1, result.newEvents);
+    TEST_ASSERT_EQUAL(FIRE_WASPADA, alarm.getState());
+}
+
+void test_hour_hovering_at_waspada() {
+    FlapResult result = simulateHour(30.0f, 3.0f);
+    TEST_ASSERT_GREATER_THAN(5000, result.oldChanges);
+    TEST_ASSERT_EQUAL_UINT32(1, result.newTransitions);
+    TEST_ASSERT_EQUAL_UINT32(1, result.newEvents);
+}
+
+void test_hour_hovering_at_bahaya() {
+    // Acknowledged every 5 min, but the request keeps coming back within the dwell
+    FlapResult result = simulateHour(60.0f, 4.0f);
+    TEST_ASSERT_GREATER_THAN(5000, result.oldChanges);
+    TEST_ASSERT_EQUAL_UINT32(1, result.newTransitions);
+    TEST_ASSERT_EQUAL_UINT32(1, result.newEvents);
+    TEST_ASSERT_EQUAL(FIRE_BAHAYA, alarm.getState());
+    TEST_ASSERT_FALSE(alarm.isLatched());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_hysteresis_switch);
+    RUN_TEST(test_waspada_needs_confirm);
+    RUN_TEST(test_bahaya_enters_at_once);
+    RUN_TEST(test_dwell_retriggered_by_demand);
+    RUN_TEST(test_bahaya_latches_until_acknowledged);
+    RUN_TEST(test_acknowledged_bahaya_keeps_dwell);
+    RUN_TEST(test_counters);
+    RUN_TEST(test_hour_hovering_below_waspada);
+    RUN_TEST(test_hour_hovering_at_waspada);
+    RUN_TEST(test_hour_hovering_at_bahaya);
+    return UNITY_END();
+}
@@ -0,0 +1,165 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "CusumDetector.h"
+
+// ============================================================================
+// CusumDetector: detection delay against h / (d - k) for steps up and down,
+// no flag on zero-mean noise, the 2h cap clearing a flag after the signal
+// returns, and configure() clamping.
+// ============================================================================
+
+#define TEST_DRIFT          25.0f       // IR_CUSUM_DRIFT_MV
+#define TEST_THRESHOLD      500.0f      // IR_CUSUM_THRESHOLD
+#define TEST_LEVEL          1500.0f     // A channel's resting level (mV)
+
+static CusumDetector detector;
+static uint32_t rngState;
+
+static uint32_t nextRandom() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+static float uniform(float lo, float hi) {
+    return lo + (hi - lo) * (nextRandom() & 0xFFFF) / 65535.0f;
+}
+
+// Near-Gaussian, unit sigma
+static float noise() {
+    float sum = 0.0f;
+    for (int k = 0; k < 4; k++) sum += uniform(-1.0f, 1.0f);
+    return sum * 0.866f;
+}
+
+// Push `level` `count` times; returns the 1-based sample at which the shift
+// first read `expected`, or -1
+static long hold(float level, long count, int8_t expected) {
+    long at = -1;
+    for (long i = 1; i <= count; i++) {
+        if (detector.push(level) == expected && at < 0) at = i;
+    }
+    return at;
+}
+
+void setUp() {
+    detector = CusumDetector(TEST_DRIFT, TEST_THRESHOLD);
+    detector.push(TEST_LEVEL);          // Reference
+    rngState = 12345;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_step_delay_matches_theory() {
+    static const float steps[] = {30.0f, 50.0f, 100.0f, 300.0f};
+    for (unsigned s = 0; s < sizeof(steps) / sizeof(steps[0]); s++) {
+        for (int sign = 1; sign >= -1; sign -= 2) {
+            setUp();
+            float d = steps[s];
+            long delay = hold(TEST_LEVEL + sign * d, 1000, (int8_t)sign);
+            // First sample with n (d - k) > h
+            long expected = (long)floorf(TEST_THRESHOLD / (d - TEST_DRIFT)) + 1;
+            TEST_ASSERT_EQUAL(expected, delay);
+        }
+    }
+}
+
+void test_step_delay_in_noise() {
+    // +100 mV in 10 mV noise: about h / (d - k) = 6.7 updates
+    long total = 0;
+    const int trials = 200;
+    for (int t = 0; t < trials; t++) {
+        detector = CusumDetector(TEST_DRIFT, TEST_THRESHOLD);
+        detector.push(TEST_LEVEL);
+        long at = -1;
+        for (long i = 1; i <= 100 && at < 0; i++) {
+            if (detector.push(TEST_LEVEL + 100.0f + 10.0f * noise()) == 1) at = i;
+        }
+        TEST_ASSERT_GREATER_THAN(0, at);
+        total += at;
+    }
+    float mean = (float)total / trials;
+    char summary[80];
+    snprintf(summary, sizeof(summary), "mean delay %.2f updates (h/(d-k) = %.2f)", mean, TEST_THRESHOLD / 75.0f);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f, TEST_THRESHOLD / 75.0f, mean);
+}
+
+void test_below_drift_never_flags() {
+    TEST_ASSERT_EQUAL(-1, hold(TEST_LEVEL + TEST_DRIFT, 100000, 1));
+    TEST_ASSERT_EQUAL(-1, hold(TEST_LEVEL - TEST_DRIFT, 100000, -1));
+}
+
+void test_zero_mean_noise_no_flag() {
+    // Sigma 20 mV (close to the drift), a day of updates at 10 Hz
+    long flagged = 0;
+    float peak = 0.0f;
+    for (long i = 0; i < 864000L; i++) {
+        if (detector.push(TEST_LEVEL + 20.0f * noise()) != 0) flagged++;
+        if (detector.upperLevel() > peak) peak = detector.upperLevel();
+        if (detector.lowerLevel() > peak) peak = detector.lowerLevel();
+    }
+    char summary[80];
+    snprintf(summary, sizeof(summary), "peak level %.3f of threshold", peak);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_EQUAL(0, flagged);
+}
+
+void test_cap_clears_flag_after_return() {
+    // Long rise: the sum saturates at 2h instead of growing without bound
+    hold(TEST_LEVEL + 200.0f, 10000, 1);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 2.0f, detector.upperLevel());
+
+    // Back at the reference, S+ falls by k per update: h / k updates to clear
+    long cleared = hold(TEST_LEVEL, 1000, 0);
+    TEST_ASSERT_EQUAL((long)(TEST_THRESHOLD / TEST_DRIFT), cleared);
+    TEST_ASSERT_EQUAL(0, detector.shift());
+
+    // Dropping below the reference clears faster
+    setUp();
+    hold(TEST_LEVEL + 200.0f, 10000, 1);
+    cleared = hold(TEST_LEVEL - 100.0f, 1000, 0);
+    TEST_ASSERT_EQUAL((long)ceilf(TEST_THRESHOLD / (100.0f + TEST_DRIFT)), cleared);
+}
+
+void test_reference_follows_slowly() {
+    detector.setReferenceAlpha(0.01f);
+    hold(TEST_LEVEL + 100.0f, 1, 0);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, TEST_LEVEL + 1.0f, detector.reference());
+
+    detector.reset();
+    TEST_ASSERT_EQUAL(0, detector.push(900.0f));           // New reference, no flag
+    TEST_ASSERT_EQUAL_FLOAT(900.0f, detector.reference());
+}
+
+void test_configure_clamps() {
+    detector.configure(-5.0f, 0.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, detector.getDrift());
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, detector.getThreshold());
+
+    detector.configure(10.0f, -300.0f);
+    TEST_ASSERT_EQUAL_FLOAT(10.0f, detector.getDrift());
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, detector.getThreshold());
+
+    // As typed on the console ("cusum smoke nan nan")
+    detector.configure(NAN, NAN);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, detector.getDrift());
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, detector.getThreshold());
+
+    detector.configure(TEST_DRIFT, TEST_THRESHOLD);
+    TEST_ASSERT_EQUAL_FLOAT(TEST_DRIFT, detector.getDrift());
+    TEST_ASSERT_EQUAL_FLOAT(TEST_THRESHOLD, detector.getThreshold());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_step_delay_matches_theory);
+    RUN_TEST(test_step_delay_in_noise);
+    RUN_TEST(test_below_drift_never_flags);
+    RUN_TEST(test_zero_mean_noise_no_flag);
+    RUN_TEST(test_cap_clears_flag_after_return);
+    RUN_TEST(test_reference_follows_slowly);
+    RUN_TEST(test_configure_clamps);
+    return UNITY_END();
+}
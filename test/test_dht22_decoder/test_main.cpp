@@ -0,0 +1,128 @@
+#include <unity.h>
+#include <string.h>
+#include "DHT22Decoder.h"
+
+// ============================================================================
+// dht22DecodePulses() on captured frames in the (level, width) form the RMT
+// receiver in DHT22.cpp hands over: idle-high lead-in, 80/80us response,
+// 40 data bits, trailing low. Widths carry the few-us jitter of a real
+// sensor. Broken captures are derived from them.
+// ============================================================================
+
+// 65.2 %RH, 23.4 C
+static const DHT22Pulse FRAME_ROOM[] = {
+    {1, 32}, {0, 79}, {1, 81},
+    {0, 48}, {1, 23}, {0, 56}, {1, 23}, {0, 53}, {1, 27}, {0, 48}, {1, 27}, {0, 51}, {1, 23}, {0, 49}, {1, 26}, {0, 54}, {1, 68}, {0, 51}, {1, 23},  // 0x02
+    {0, 56}, {1, 71}, {0, 48}, {1, 29}, {0, 49}, {1, 24}, {0, 48}, {1, 27}, {0, 54}, {1, 68}, {0, 51}, {1, 68}, {0, 56}, {1, 29}, {0, 50}, {1, 25},  // 0x8C
+    {0, 54}, {1, 24}, {0, 56}, {1, 23}, {0, 52}, {1, 27}, {0, 50}, {1, 23}, {0, 51}, {1, 25}, {0, 49}, {1, 27}, {0, 49}, {1, 27}, {0, 48}, {1, 27},  // 0x00
+    {0, 51}, {1, 71}, {0, 56}, {1, 71}, {0, 53}, {1, 71}, {0, 55}, {1, 25}, {0, 52}, {1, 69}, {0, 50}, {1, 28}, {0, 51}, {1, 68}, {0, 52}, {1, 27},  // 0xEA
+    {0, 55}, {1, 25}, {0, 55}, {1, 70}, {0, 49}, {1, 68}, {0, 56}, {1, 71}, {0, 50}, {1, 74}, {0, 53}, {1, 24}, {0, 55}, {1, 26}, {0, 48}, {1, 28},  // 0x78
+    {0, 49}
+};
+
+// 45.0 %RH, -10.1 C (sign bit set)
+static const DHT22Pulse FRAME_FREEZER[] = {
+    {1, 32}, {0, 80}, {1, 83},
+    {0, 53}, {1, 27}, {0, 55}, {1, 27}, {0, 55}, {1, 23}, {0, 49}, {1, 25}, {0, 55}, {1, 28}, {0, 49}, {1, 23}, {0, 52}, {1, 28}, {0, 55}, {1, 70},  // 0x01
+    {0, 54}, {1, 73}, {0, 53}, {1, 68}, {0, 55}, {1, 25}, {0, 50}, {1, 27}, {0, 49}, {1, 26}, {0, 48}, {1, 24}, {0, 52}, {1, 69}, {0, 51}, {1, 26},  // 0xC2
+    {0, 54}, {1, 74}, {0, 55}, {1, 23}, {0, 50}, {1, 26}, {0, 54}, {1, 27}, {0, 52}, {1, 24}, {0, 54}, {1, 29}, {0, 56}, {1, 25}, {0, 54}, {1, 25},  // 0x80
+    {0, 54}, {1, 24}, {0, 50}, {1, 68}, {0, 50}, {1, 69}, {0, 51}, {1, 28}, {0, 51}, {1, 23}, {0, 55}, {1, 74}, {0, 50}, {1, 25}, {0, 52}, {1, 68},  // 0x65
+    {0, 50}, {1, 71}, {0, 56}, {1, 25}, {0, 53}, {1, 69}, {0, 56}, {1, 27}, {0, 48}, {1, 71}, {0, 56}, {1, 26}, {0, 54}, {1, 26}, {0, 54}, {1, 23},  // 0xA8
+    {0, 55}
+};
+
+#define ROOM_COUNT          (sizeof(FRAME_ROOM) / sizeof(FRAME_ROOM[0]))
+#define FREEZER_COUNT       (sizeof(FRAME_FREEZER) / sizeof(FRAME_FREEZER[0]))
+#define FIRST_BIT_PULSE     3           // Index of the first data bit's low pulse
+
+static DHT22Pulse work[ROOM_COUNT];
+static DHT22Reading reading;
+
+void setUp() {
+    memcpy(work, FRAME_ROOM, sizeof(work));
+    reading.temperature = -999.0f;
+    reading.humidity = -999.0f;
+}
+
+void tearDown() {}
+
+// High pulse of data bit `bit` (0 = MSB of the humidity)
+static DHT22Pulse& bitHigh(int bit) {
+    return work[FIRST_BIT_PULSE + 2 * bit + 1];
+}
+
+// ----------------------------------------------------------------------------
+void test_room_reading() {
+    TEST_ASSERT_EQUAL(DHT22_DECODE_OK, dht22DecodePulses(FRAME_ROOM, ROOM_COUNT, reading));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 65.2f, reading.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 23.4f, reading.temperature);
+}
+
+void test_negative_temperature() {
+    TEST_ASSERT_EQUAL(DHT22_DECODE_OK, dht22DecodePulses(FRAME_FREEZER, FREEZER_COUNT, reading));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 45.0f, reading.humidity);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -10.1f, reading.temperature);
+}
+
+void test_without_lead_in() {
+    // Capture started after the idle-high lead-in: the response is enough
+    TEST_ASSERT_EQUAL(DHT22_DECODE_OK, dht22DecodePulses(FRAME_ROOM + 1, ROOM_COUNT - 1, reading));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 23.4f, reading.temperature);
+}
+
+void test_bad_checksum() {
+    // One data bit read wrong (0 -> 1 in the temperature low byte)
+    bitHigh(39 - 8).widthUs = 70;
+    TEST_ASSERT_EQUAL(DHT22_DECODE_BAD_CHECKSUM, dht22DecodePulses(work, ROOM_COUNT, reading));
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, -999.0f, reading.temperature);     // Untouched
+
+    // Checksum byte itself corrupted
+    memcpy(work, FRAME_ROOM, sizeof(work));
+    bitHigh(39).widthUs = 72;
+    TEST_ASSERT_EQUAL(DHT22_DECODE_BAD_CHECKSUM, dht22DecodePulses(work, ROOM_COUNT, reading));
+}
+
+void test_truncated_capture() {
+    // Capture timeout cut the last bytes off
+    TEST_ASSERT_EQUAL(DHT22_DECODE_TOO_SHORT, dht22DecodePulses(FRAME_ROOM, ROOM_COUNT - 17, reading));
+    // Capture started late, in the middle of the humidity
+    TEST_ASSERT_EQUAL(DHT22_DECODE_TOO_SHORT, dht22DecodePulses(FRAME_ROOM + 20, ROOM_COUNT - 20, reading));
+    TEST_ASSERT_EQUAL(DHT22_DECODE_TOO_SHORT, dht22DecodePulses(FRAME_ROOM, 0, reading));
+}
+
+void test_out_of_spec_pulses() {
+    bitHigh(12).widthUs = DHT22_BIT_HIGH_MAX_US + 20;              // Stretched high
+    TEST_ASSERT_EQUAL(DHT22_DECODE_BAD_TIMING, dht22DecodePulses(work, ROOM_COUNT, reading));
+
+    memcpy(work, FRAME_ROOM, sizeof(work));
+    bitHigh(20).widthUs = DHT22_BIT_HIGH_MIN_US - 5;               // Glitch
+    TEST_ASSERT_EQUAL(DHT22_DECODE_BAD_TIMING, dht22DecodePulses(work, ROOM_COUNT, reading));
+
+    memcpy(work, FRAME_ROOM, sizeof(work));
+    work[FIRST_BIT_PULSE + 2 * 30].widthUs = DHT22_BIT_LOW_MAX_US + 60;    // Long low before bit 30
+    TEST_ASSERT_EQUAL(DHT22_DECODE_BAD_TIMING, dht22DecodePulses(work, ROOM_COUNT, reading));
+
+    memcpy(work, FRAME_ROOM, sizeof(work));
+    work[FIRST_BIT_PULSE + 2 * 5].level = 1;                         // Low pulse missed, two highs in a row
+    TEST_ASSERT_EQUAL(DHT22_DECODE_BAD_TIMING, dht22DecodePulses(work, ROOM_COUNT, reading));
+}
+
+void test_bit_threshold() {
+    // 0 and 1 are told apart at DHT22_BIT_THRESHOLD_US: a slow 0 still reads 0
+    bitHigh(0).widthUs = DHT22_BIT_THRESHOLD_US;
+    TEST_ASSERT_EQUAL(DHT22_DECODE_OK, dht22DecodePulses(work, ROOM_COUNT, reading));
+    bitHigh(0).widthUs = DHT22_BIT_THRESHOLD_US + 1;
+    TEST_ASSERT_EQUAL(DHT22_DECODE_BAD_CHECKSUM, dht22DecodePulses(work, ROOM_COUNT, reading));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_room_reading);
+    RUN_TEST(test_negative_temperature);
+    RUN_TEST(test_without_lead_in);
+    RUN_TEST(test_bad_checksum);
+    RUN_TEST(test_truncated_capture);
+    RUN_TEST(test_out_of_spec_pulses);
+    RUN_TEST(test_bit_threshold);
+    return UNITY_END();
+}
@@ -0,0 +1,171 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "FirDecimator.h"
+
+// ============================================================================
+// The IR prefilter as IRFlameSensor configures it with IR_FIR_PREFILTER=1:
+// 41 taps, 5 Hz cutoff at 100 Hz, decimated by 5. Checks the designed
+// response against the numbers in IRFlameSensor.h and the decimator output
+// against a double-precision convolution.
+// ============================================================================
+
+#define TEST_TAPS           41          // IR_FIR_TAPS
+#define TEST_RATE_HZ        100.0       // FLICKER_SAMPLE_RATE_HZ
+#define TEST_CUTOFF_HZ      5.0         // IR_FIR_CUTOFF_HZ
+#define TEST_DECIMATION     5           // IR_FIR_DECIMATION
+
+static float coeffs[TEST_TAPS];
+
+// |H(f)| of the designed taps, in dB
+static double responseDb(double hz) {
+    double re = 0.0, im = 0.0;
+    for (int k = 0; k < TEST_TAPS; k++) {
+        double w = 2.0 * M_PI * hz / TEST_RATE_HZ * k;
+        re += coeffs[k] * cos(w);
+        im -= coeffs[k] * sin(w);
+    }
+    return 20.0 * log10(sqrt(re * re + im * im) + 1e-12);
+}
+
+// Worst (highest) response over [fromHz, toHz]
+static double maxResponseDb(double fromHz, double toHz) {
+    double worst = -1000.0;
+    for (double hz = fromHz; hz <= toHz + 1e-9; hz += 0.01) {
+        double db = responseDb(hz);
+        if (db > worst) worst = db;
+    }
+    return worst;
+}
+
+void setUp() {
+    firDesignLowPass(coeffs, TEST_TAPS, (float)(TEST_CUTOFF_HZ / TEST_RATE_HZ));
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_design_is_symmetric_with_unity_dc_gain() {
+    double sum = 0.0;
+    for (int k = 0; k < TEST_TAPS; k++) {
+        sum += coeffs[k];
+        TEST_ASSERT_EQUAL_FLOAT(coeffs[k], coeffs[TEST_TAPS - 1 - k]);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 1.0, sum);
+}
+
+void test_passband() {
+    // Baseline drift and a growing fire pass untouched; -6 dB at the cutoff
+    TEST_ASSERT_TRUE(responseDb(1.0) > -0.1);
+    TEST_ASSERT_TRUE(responseDb(2.0) > -0.5);
+    TEST_ASSERT_FLOAT_WITHIN(0.5, -6.0, responseDb(TEST_CUTOFF_HZ));
+    for (double hz = 0.0; hz < TEST_CUTOFF_HZ; hz += 0.01) {
+        TEST_ASSERT_TRUE(responseDb(hz) <= 1e-6);          // No passband ripple above 0 dB
+    }
+}
+
+void test_stopband() {
+    double from10 = maxResponseDb(10.0, 50.0);
+    double at50 = responseDb(50.0);
+
+    char summary[96];
+    snprintf(summary, sizeof(summary), "stopband: <= %.1f dB over 10-50 Hz, %.1f dB at 50 Hz", from10, at50);
+    TEST_MESSAGE(summary);
+
+    TEST_ASSERT_TRUE(from10 <= -50.0);
+    TEST_ASSERT_TRUE(at50 <= -70.0);
+}
+
+void test_decimator_matches_reference_convolution() {
+    FirDecimator fir;
+    TEST_ASSERT_TRUE(fir.init(coeffs, TEST_TAPS, TEST_DECIMATION));
+    TEST_ASSERT_EQUAL_UINT16((TEST_TAPS - 1) / 2, fir.delaySamples());
+
+    // Level, 50 Hz ripple and 8 Hz flicker, all in mV
+    const int samples = 5000;
+    static float input[samples];
+    for (int n = 0; n < samples; n++) {
+        double t = n / TEST_RATE_HZ;
+        input[n] = (float)(1500.0 + 0.05 * n + 200.0 * sin(2.0 * M_PI * 50.0 * t + 0.3) +
+                           80.0 * sin(2.0 * M_PI * 8.0 * t));
+    }
+
+    fir.reset(input[0]);
+    int outputs = 0;
+    double maxError = 0.0;
+    for (int n = 0; n < samples; n++) {
+        float output;
+        if (!fir.push(input[n], output)) continue;
+        outputs++;
+
+        double expected = 0.0;
+        for (int k = 0; k < TEST_TAPS; k++) {
+            expected += (double)coeffs[k] * input[n - k < 0 ? 0 : n - k];
+        }
+        double error = fabs(output - expected);
+        if (error > maxError) maxError = error;
+    }
+
+    char summary[64];
+    snprintf(summary, sizeof(summary), "max error vs double reference: %.5f mV", maxError);
+    TEST_MESSAGE(summary);
+
+    TEST_ASSERT_EQUAL_INT32(samples / TEST_DECIMATION, outputs);
+    TEST_ASSERT_TRUE(maxError < 0.005);
+}
+
+void test_ripple_is_removed() {
+    FirDecimator fir;
+    fir.init(coeffs, TEST_TAPS, TEST_DECIMATION);
+    fir.reset(1500.0f);
+
+    // 200 mV of 50 Hz (and 15 Hz) ripple on a steady level
+    double maxDeviation = 0.0;
+    for (int n = 0; n < 2000; n++) {
+        double t = n / TEST_RATE_HZ;
+        float input = (float)(1500.0 + 200.0 * sin(2.0 * M_PI * 50.0 * t + 1.0) + 200.0 * sin(2.0 * M_PI * 15.0 * t));
+        float output;
+        if (fir.push(input, output) && n >= TEST_TAPS) {
+            double deviation = fabs(output - 1500.0);
+            if (deviation > maxDeviation) maxDeviation = deviation;
+        }
+    }
+    TEST_ASSERT_TRUE(maxDeviation < 200.0 * (pow(10.0, -67.0 / 20.0) + pow(10.0, -70.0 / 20.0)) + 0.01);
+}
+
+void test_step_settles_after_taps() {
+    FirDecimator fir;
+    fir.init(coeffs, TEST_TAPS, 1);
+    fir.reset(1000.0f);
+
+    // Linear phase: the step crosses its midpoint around the group delay
+    float output = 0.0f, beforeMiddle = 0.0f;
+    for (int n = 0; n < TEST_TAPS; n++) {
+        fir.push(2000.0f, output);
+        if (n + 1 == fir.delaySamples()) beforeMiddle = output;
+        if (n == fir.delaySamples()) TEST_ASSERT_FLOAT_WITHIN(0.01f, 1500.0f, (beforeMiddle + output) / 2.0f);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 2000.0f, output);
+}
+
+void test_init_rejects_bad_arguments() {
+    FirDecimator fir;
+    float output;
+    TEST_ASSERT_TRUE(!fir.init(NULL, TEST_TAPS, 1));
+    TEST_ASSERT_TRUE(!fir.init(coeffs, 0, 1));
+    TEST_ASSERT_TRUE(!fir.init(coeffs, FIR_MAX_TAPS + 1, 1));
+    TEST_ASSERT_TRUE(!fir.init(coeffs, TEST_TAPS, 0));
+    TEST_ASSERT_TRUE(!fir.push(1.0f, output));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_design_is_symmetric_with_unity_dc_gain);
+    RUN_TEST(test_passband);
+    RUN_TEST(test_stopband);
+    RUN_TEST(test_decimator_matches_reference_convolution);
+    RUN_TEST(test_ripple_is_removed);
+    RUN_TEST(test_step_settles_after_taps);
+    RUN_TEST(test_init_rejects_bad_arguments);
+    return UNITY_END();
+}
@@ -0,0 +1,246 @@
+#include <unity.h>
+#include <math.h>
+#include "FusionScore.h"
+
+// ============================================================================
+// FireFusion evidence, attack/release of the score and its level mapping,
+// the legacy rule and the time-to-alarm episodes, as evaluateFireFusion()
+// and tools/fusionreplay.cpp drive them.
+// ============================================================================
+
+#define TEST_DT_S           0.1f        // loop() fast check
+
+static FireFusion fusion;
+
+static FusionInput quietInput() {
+    FusionInput input;
+    input.flameState = FLAME_IDLE;
+    input.flameConfidence = 0;
+    input.smokePPM = 20.0f;
+    input.smokeBackground = 20.0f;
+    input.smokeThreshold = 50.0f;
+    input.smokeSlope = 0.0f;
+    input.temperature = 25.0f;
+    input.temperatureSlope = 0.0f;
+    input.irShiftLevel = 0.0f;
+    input.smokeShiftLevel = 0.0f;
+    input.modelNuisance = 0;
+    return input;
+}
+
+static FusionInput flameInput() {
+    FusionInput input = quietInput();
+    input.flameState = FLAME_DETECTED;
+    input.flameConfidence = 90;
+    return input;
+}
+
+// Feed `input` for `seconds` in TEST_DT_S steps
+static void run(const FusionInput& input, float seconds) {
+    int steps = (int)(seconds / TEST_DT_S + 0.5f);
+    for (int i = 0; i < steps; i++) fusion.update(input, TEST_DT_S);
+}
+
+void setUp() {
+    fusion = FireFusion();
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_evidence_normalization() {
+    FusionInput input = quietInput();
+    input.flameState = FLAME_POTENTIAL;
+    input.flameConfidence = 60;
+    input.smokePPM = 35.0f;                                 // Half way to the threshold
+    input.smokeSlope = 2.0f * FUSION_SMOKE_SLOPE_FULL;      // Capped at 1
+    input.temperature = THRESHOLD_TEMP;
+    input.temperatureSlope = -1.0f;                         // Falling: no evidence
+    input.irShiftLevel = 0.4f;
+    input.smokeShiftLevel = 3.0f;
+    fusion.update(input, TEST_DT_S);
+
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.3f, fusion.getEvidence(FUSION_FLAME));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.5f, fusion.getEvidence(FUSION_SMOKE_LEVEL));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, fusion.getEvidence(FUSION_SMOKE_SLOPE));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, fusion.getEvidence(FUSION_TEMP_LEVEL));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getEvidence(FUSION_TEMP_SLOPE));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.4f, fusion.getEvidence(FUSION_IR_SHIFT));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 1.0f, fusion.getEvidence(FUSION_SMOKE_SHIFT));
+
+    float expected = 0.3f * FUSION_WEIGHT_FLAME + 0.5f * FUSION_WEIGHT_SMOKE + FUSION_WEIGHT_SMOKE_SLOPE +
+                     FUSION_WEIGHT_TEMP + 0.4f * FUSION_WEIGHT_IR_SHIFT + FUSION_WEIGHT_SMOKE_SHIFT;
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, expected > 100.0f ? 100.0f : expected, fusion.getInstantScore());
+}
+
+void test_level_evidence_caps_and_invalid_inputs() {
+    FusionInput input = quietInput();
+    input.flameState = FLAME_AMBIENT_INTERFERENCE;          // Not a flame
+    input.flameConfidence = 100;
+    input.smokePPM = 500.0f;
+    input.temperature = -999.0f;                            // DHT22 failed
+    input.temperatureSlope = 5.0f;
+    fusion.update(input, TEST_DT_S);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getEvidence(FUSION_FLAME));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, FUSION_LEVEL_CAP, fusion.getEvidence(FUSION_SMOKE_LEVEL));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getEvidence(FUSION_TEMP_LEVEL));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getEvidence(FUSION_TEMP_SLOPE));
+
+    // Threshold not above the background yet: no smoke level evidence
+    input.smokeThreshold = input.smokeBackground;
+    fusion.update(input, TEST_DT_S);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getEvidence(FUSION_SMOKE_LEVEL));
+
+    // Everything at once still caps the instant score at 100
+    FusionInput all = flameInput();
+    all.smokePPM = 500.0f;
+    all.temperature = 80.0f;
+    fusion.update(all, TEST_DT_S);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 100.0f, fusion.getInstantScore());
+}
+
+void test_attack_time_constant() {
+    float target = FUSION_WEIGHT_FLAME;
+
+    // First update after boot has dt 0 and leaves the score alone
+    fusion.update(flameInput(), 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getScore());
+
+    run(flameInput(), FUSION_ATTACK_S);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, target * (1.0f - expf(-1.0f)), fusion.getScore());
+
+    // Exact for any interval: one update of the whole span lands on the same value
+    FireFusion single;
+    single.update(flameInput(), FUSION_ATTACK_S);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, fusion.getScore(), single.getScore());
+
+    run(flameInput(), 10.0f * FUSION_ATTACK_S);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, target, fusion.getScore());
+}
+
+void test_release_time_constant() {
+    run(flameInput(), 20.0f * FUSION_ATTACK_S);
+    float start = fusion.getScore();
+
+    run(quietInput(), FUSION_RELEASE_S);
+    TEST_ASSERT_FLOAT_WITHIN(0.05f, start * expf(-1.0f), fusion.getScore());
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getInstantScore());
+
+    // A single noisy reading barely moves a quiet score (attack is still a lag)
+    FireFusion quiet;
+    quiet.update(quietInput(), TEST_DT_S);
+    quiet.update(flameInput(), TEST_DT_S);
+    TEST_ASSERT_TRUE(quiet.getScore() < FUSION_WASPADA_SCORE / 2.0f);
+}
+
+// Score settled on `points` of flame evidence
+static FireLevel settledLevel(float points) {
+    FireFusion f;
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) f.setWeight((FusionEvidence)i, 0.0f);
+    f.setWeight(FUSION_FLAME, points);
+    return f.update(flameInput(), 100.0f * FUSION_RELEASE_S);
+}
+
+void test_level_mapping() {
+    TEST_ASSERT_EQUAL(FIRE_AMAN, settledLevel(0.0f));
+    TEST_ASSERT_EQUAL(FIRE_AMAN, settledLevel(FUSION_WASPADA_SCORE - 0.1f));
+    TEST_ASSERT_EQUAL(FIRE_WASPADA, settledLevel(FUSION_WASPADA_SCORE));
+    TEST_ASSERT_EQUAL(FIRE_WASPADA, settledLevel(FUSION_BAHAYA_SCORE - 0.1f));
+    TEST_ASSERT_EQUAL(FIRE_BAHAYA, settledLevel(FUSION_BAHAYA_SCORE));
+    TEST_ASSERT_EQUAL(FIRE_BAHAYA, settledLevel(100.0f));
+
+    // A confirmed flame alone reaches Bahaya with the shipped weights
+    run(flameInput(), 5.0f);
+    TEST_ASSERT_EQUAL(FIRE_BAHAYA, fusion.getLevel());
+}
+
+void test_weights_and_names() {
+    fusion.setWeight(FUSION_SMOKE_LEVEL, -5.0f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getWeight(FUSION_SMOKE_LEVEL));
+    fusion.setWeight(FUSION_NUM_EVIDENCE, 50.0f);           // Ignored
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getWeight(FUSION_NUM_EVIDENCE));
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, FUSION_WEIGHT_FLAME, fusion.getWeight(FUSION_FLAME));
+
+    TEST_ASSERT_EQUAL_STRING("Waspada", FireFusion::levelName(FIRE_WASPADA));
+    TEST_ASSERT_EQUAL_STRING("smk-cusum", FireFusion::evidenceName(FUSION_SMOKE_SHIFT));
+
+    run(flameInput(), 5.0f);
+    fusion.reset();
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, fusion.getScore());
+    TEST_ASSERT_EQUAL(FIRE_AMAN, fusion.getLevel());
+}
+
+void test_legacy_rule() {
+    TEST_ASSERT_EQUAL(FIRE_AMAN, legacyFireLevel(false, false, false));
+    TEST_ASSERT_EQUAL(FIRE_WASPADA, legacyFireLevel(false, true, false));
+    TEST_ASSERT_EQUAL(FIRE_WASPADA, legacyFireLevel(false, false, true));
+    TEST_ASSERT_EQUAL(FIRE_BAHAYA, legacyFireLevel(false, true, true));
+    TEST_ASSERT_EQUAL(FIRE_BAHAYA, legacyFireLevel(true, false, false));
+}
+
+// ----------------------------------------------------------------------------
+void test_episode_timing() {
+    FusionEpisodeTracker episodes;
+    TEST_ASSERT_EQUAL(FUSION_EPISODE_NONE, episodes.update(FIRE_AMAN, FIRE_AMAN, 500));
+    TEST_ASSERT_EQUAL(FUSION_EPISODE_STARTED, episodes.update(FIRE_WASPADA, FIRE_AMAN, 1000));
+    episodes.update(FIRE_BAHAYA, FIRE_AMAN, 3000);
+    episodes.update(FIRE_BAHAYA, FIRE_WASPADA, 5000);
+    episodes.update(FIRE_AMAN, FIRE_WASPADA, 9000);
+    TEST_ASSERT_TRUE(episodes.current().open);
+
+    // Both quiet from 10 s: closes once the gap has passed
+    TEST_ASSERT_EQUAL(FUSION_EPISODE_NONE, episodes.update(FIRE_AMAN, FIRE_AMAN, 10000));
+    TEST_ASSERT_EQUAL(FUSION_EPISODE_NONE, episodes.update(FIRE_AMAN, FIRE_AMAN, 9000 + FUSION_EPISODE_GAP_MS - 1));
+    TEST_ASSERT_EQUAL(FUSION_EPISODE_CLOSED, episodes.update(FIRE_AMAN, FIRE_AMAN, 9000 + FUSION_EPISODE_GAP_MS));
+    TEST_ASSERT_FALSE(episodes.current().open);
+    TEST_ASSERT_EQUAL_UINT32(1, episodes.getClosedCount());
+
+    const FusionEpisode& e = episodes.last();
+    TEST_ASSERT_EQUAL(1000, (long)e.startMs);
+    TEST_ASSERT_EQUAL(8000, (long)e.durationMs());
+    TEST_ASSERT_EQUAL(0, e.firstMs[FUSION_RULE_SCORE][0]);
+    TEST_ASSERT_EQUAL(2000, e.firstMs[FUSION_RULE_SCORE][1]);
+    TEST_ASSERT_EQUAL(4000, e.firstMs[FUSION_RULE_LEGACY][0]);
+    TEST_ASSERT_EQUAL(-1, e.firstMs[FUSION_RULE_LEGACY][1]);
+
+    // The next episode starts clean
+    episodes.update(FIRE_AMAN, FIRE_BAHAYA, 100000);
+    TEST_ASSERT_EQUAL(-1, episodes.current().firstMs[FUSION_RULE_SCORE][0]);
+    TEST_ASSERT_EQUAL(0, episodes.current().firstMs[FUSION_RULE_LEGACY][1]);
+}
+
+// Smouldering fire: smoke creeps up 0.3 PPM/s with a CUSUM flag, no flame.
+// The score reaches Waspada long before the smoke crosses its threshold.
+void test_smouldering_fire_alarms_before_legacy() {
+    FusionEpisodeTracker episodes;
+    FusionInput input = quietInput();
+    for (unsigned long ms = 0; ms < 300000; ms += 100) {
+        float t = ms / 1000.0f;
+        input.smokePPM = 20.0f + 0.3f * t;
+        input.smokeSlope = 0.3f;
+        input.smokeShiftLevel = (t > 10.0f) ? 1.0f : 0.0f;
+        FireLevel fused = fusion.update(input, TEST_DT_S);
+        FireLevel legacy = legacyFireLevel(false, input.smokePPM > input.smokeThreshold, false);
+        episodes.update(fused, legacy, ms);
+    }
+    const FusionEpisode& e = episodes.current();
+    TEST_ASSERT_TRUE(e.open);
+    TEST_ASSERT_EQUAL(0, e.firstMs[FUSION_RULE_SCORE][0]);                      // Fusion opened it
+    TEST_ASSERT_TRUE(e.firstMs[FUSION_RULE_LEGACY][0] > 60000);                 // ~100 s to the threshold
+    TEST_ASSERT_TRUE(e.firstMs[FUSION_RULE_SCORE][1] >= 0);                     // Smoke alone reaches Bahaya
+    TEST_ASSERT_EQUAL(-1, e.firstMs[FUSION_RULE_LEGACY][1]);                    // Legacy needs heat too
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_evidence_normalization);
+    RUN_TEST(test_level_evidence_caps_and_invalid_inputs);
+    RUN_TEST(test_attack_time_constant);
+    RUN_TEST(test_release_time_constant);
+    RUN_TEST(test_level_mapping);
+    RUN_TEST(test_weights_and_names);
+    RUN_TEST(test_legacy_rule);
+    RUN_TEST(test_episode_timing);
+    RUN_TEST(test_smouldering_fire_alarms_before_legacy);
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "FlameModel.h"
+
+// ============================================================================
+// FlameModel::infer() against the golden vectors tools/train_flame_model.py
+// writes into FlameModelWeights.h: the least confident validation vectors of
+// each class, so a one-LSB difference between the trainer's integer path and
+// the device's shows up in the probabilities. Also the input quantizer.
+// ============================================================================
+
+#define TEST_PROBABILITY_TOLERANCE  1e-5f       // float expf() against Python doubles
+
+void setUp() {}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_quantize() {
+    TEST_ASSERT_EQUAL_INT8(0, FlameModel::quantize(0.0f));
+    TEST_ASSERT_EQUAL_INT8(32, FlameModel::quantize(1.0f));
+    TEST_ASSERT_EQUAL_INT8(-16, FlameModel::quantize(-0.5f));
+    // Halves away from zero, like the trainer's quantize_input()
+    TEST_ASSERT_EQUAL_INT8(1, FlameModel::quantize(1.0f / 64.0f));
+    TEST_ASSERT_EQUAL_INT8(-1, FlameModel::quantize(-1.0f / 64.0f));
+    TEST_ASSERT_EQUAL_INT8(3, FlameModel::quantize(5.0f / 64.0f));
+    // Saturates instead of wrapping
+    TEST_ASSERT_EQUAL_INT8(127, FlameModel::quantize(4.0f));
+    TEST_ASSERT_EQUAL_INT8(127, FlameModel::quantize(1000.0f));
+    TEST_ASSERT_EQUAL_INT8(-128, FlameModel::quantize(-4.0f));
+    TEST_ASSERT_EQUAL_INT8(-128, FlameModel::quantize(-1000.0f));
+    TEST_ASSERT_EQUAL_INT8(-128, FlameModel::quantize(NAN));
+}
+
+void test_golden_vectors() {
+    TEST_ASSERT_GREATER_THAN(0, FLAME_MODEL_GOLDEN);
+    float worst = 0.0f;
+    for (int g = 0; g < FLAME_MODEL_GOLDEN; g++) {
+        float probabilities[FLAME_MODEL_CLASSES];
+        FlameClass cls = FlameModel::infer(flameModelGoldenFeatures[g], probabilities);
+
+        char message[32];
+        snprintf(message, sizeof(message), "golden vector %d", g);
+        TEST_ASSERT_EQUAL_MESSAGE(flameModelGoldenClass[g], cls, message);
+        for (int k = 0; k < FLAME_MODEL_CLASSES; k++) {
+            float error = fabsf(probabilities[k] - flameModelGoldenProbabilities[g][k]);
+            if (error > worst) worst = error;
+            TEST_ASSERT_FLOAT_WITHIN_MESSAGE(TEST_PROBABILITY_TOLERANCE, flameModelGoldenProbabilities[g][k],
+                                             probabilities[k], message);
+        }
+    }
+    char summary[64];
+    snprintf(summary, sizeof(summary), "%d vectors, worst probability difference %.2e", FLAME_MODEL_GOLDEN, worst);
+    TEST_MESSAGE(summary);
+}
+
+void test_probabilities_optional_and_normalized() {
+    for (int g = 0; g < FLAME_MODEL_GOLDEN; g++) {
+        float probabilities[FLAME_MODEL_CLASSES];
+        FlameClass cls = FlameModel::infer(flameModelGoldenFeatures[g], probabilities);
+        TEST_ASSERT_EQUAL(cls, FlameModel::infer(flameModelGoldenFeatures[g], NULL));
+
+        float sum = 0.0f;
+        for (int k = 0; k < FLAME_MODEL_CLASSES; k++) {
+            TEST_ASSERT_TRUE(probabilities[k] <= probabilities[cls]);
+            sum += probabilities[k];
+        }
+        TEST_ASSERT_FLOAT_WITHIN(1e-5f, 1.0f, sum);
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_quantize);
+    RUN_TEST(test_golden_vectors);
+    RUN_TEST(test_probabilities_optional_and_normalized);
+    return UNITY_END();
+}
@@ -0,0 +1,235 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "FlickerBank.h"
+#include "IRFlameSensor.h"
+
+// ============================================================================
+// Goertzel bank and the flicker decision rule of
+// IRFlameSensor::updateHighRate() / evaluateTemporal() on synthetic 100 Hz
+// traces: in-bin sinusoids, flame-like flicker, a warming heat lamp, noise,
+// and a flame whose flicker dies down after it was confirmed.
+// ============================================================================
+
+#define TEST_MIN_RMS_MV     20.0f       // FLICKER_MIN_RMS_MV in IRFlameSensor.h
+#define TEST_MIN_RATIO      0.6f        // FLICKER_MIN_RATIO
+#define TEST_PLAIN_MS       500         // TEMPORAL_VERIFICATION_MS
+#define TEST_STEADY_MS      3000        // FLICKER_STEADY_CONFIRM_MS
+#define TEST_BLOCK_MS       (1000 * FLICKER_BLOCK_SAMPLES / FLICKER_SAMPLE_RATE_HZ)
+
+static uint32_t rngState;
+static uint32_t sampleIndex;        // Continuous time across runBlocks() calls
+
+static float uniform(float lo, float hi) {
+    rngState = rngState * 1664525u + 1013904223u;
+    return lo + (hi - lo) * ((rngState >> 8) & 0xFFFF) / 65535.0f;
+}
+
+// Roughly Gaussian, unit variance
+static float noise() {
+    float sum = 0.0f;
+    for (int k = 0; k < 4; k++) sum += uniform(-1.0f, 1.0f);
+    return sum * 0.866f;
+}
+
+// Feed whole blocks of f(t) and return the last block's result
+template <typename Signal>
+static FlickerResult runBlocks(GoertzelBank& bank, int blocks, Signal signal) {
+    for (int b = 0; b < blocks; b++) {
+        for (int k = 0; k < FLICKER_BLOCK_SAMPLES; k++, sampleIndex++) {
+            float t = (float)sampleIndex / FLICKER_SAMPLE_RATE_HZ;
+            bank.push(signal(t));
+        }
+    }
+    return bank.result();
+}
+
+void setUp() {
+    rngState = 2024;
+    sampleIndex = 0;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+struct InBin {
+    float hz, amplitude;
+    float operator()(float t) const { return 1500.0f + amplitude * sinf(2.0f * (float)M_PI * hz * t); }
+};
+
+void test_in_bin_sinusoid_reads_rms() {
+    for (int bin = FLICKER_FIRST_BIN; bin <= FLICKER_LAST_BIN; bin++) {
+        GoertzelBank bank;
+        InBin signal = {bin * (float)FLICKER_SAMPLE_RATE_HZ / FLICKER_BLOCK_SAMPLES, 100.0f};
+        FlickerResult r = runBlocks(bank, 4, signal);
+        TEST_ASSERT_FLOAT_WITHIN(0.5f, 100.0f / sqrtf(2.0f), r.bandRms);
+        TEST_ASSERT_FLOAT_WITHIN(0.01f, 1.0f, r.ratio);
+        TEST_ASSERT_EQUAL_UINT32(4, bank.blockCount());
+    }
+}
+
+struct Constant {
+    float operator()(float) const { return 2400.0f; }
+};
+
+void test_constant_level_has_no_band_energy() {
+    GoertzelBank bank;
+    FlickerResult r = runBlocks(bank, 2, Constant());
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 0.0f, r.bandRms);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f, 0.0f, r.ratio);
+    TEST_ASSERT_TRUE(classifyFlickerBlock(r, TEST_MIN_RMS_MV, TEST_MIN_RATIO) == FLICKER_STEADY);
+}
+
+// Flame-like: several components between 6 and 12 Hz under 5 mV noise
+struct Flame {
+    float scale;
+    float operator()(float t) const {
+        float w = 2.0f * (float)M_PI * t;
+        return 1800.0f + scale * (60.0f * sinf(w * 6.3f) + 40.0f * sinf(w * 9.1f + 1.0f) +
+                                  30.0f * sinf(w * 11.7f + 2.0f)) + 5.0f * noise();
+    }
+};
+
+void test_flame_flicker_is_present() {
+    GoertzelBank bank;
+    float minRatio = 1.0f, minRms = 1e9f;
+    for (int b = 0; b < 40; b++) {
+        FlickerResult r = runBlocks(bank, 1, Flame{1.0f});
+        if (r.ratio < minRatio) minRatio = r.ratio;
+        if (r.bandRms < minRms) minRms = r.bandRms;
+        TEST_ASSERT_TRUE(classifyFlickerBlock(r, TEST_MIN_RMS_MV, TEST_MIN_RATIO) == FLICKER_PRESENT);
+    }
+
+    char summary[64];
+    snprintf(summary, sizeof(summary), "flame: min bandRms %.1f mV, min ratio %.3f", minRms, minRatio);
+    TEST_MESSAGE(summary);
+}
+
+// Heat lamp warming up: slow exponential rise, no flicker
+struct HeatLamp {
+    float operator()(float t) const { return 900.0f + 800.0f * (1.0f - expf(-t / 4.0f)) + 3.0f * noise(); }
+};
+
+void test_heat_lamp_is_steady() {
+    GoertzelBank bank;
+    for (int b = 0; b < 40; b++) {
+        FlickerResult r = runBlocks(bank, 1, HeatLamp());
+        TEST_ASSERT_TRUE(r.bandRms < TEST_MIN_RMS_MV);
+        TEST_ASSERT_TRUE(classifyFlickerBlock(r, TEST_MIN_RMS_MV, TEST_MIN_RATIO) == FLICKER_STEADY);
+    }
+}
+
+struct WhiteNoise {
+    float operator()(float) const { return 1200.0f + 5.0f * noise(); }
+};
+
+void test_white_noise_is_steady() {
+    GoertzelBank bank;
+    float maxRms = 0.0f;
+    for (int b = 0; b < 200; b++) {
+        FlickerResult r = runBlocks(bank, 1, WhiteNoise());
+        if (r.bandRms > maxRms) maxRms = r.bandRms;
+        TEST_ASSERT_TRUE(classifyFlickerBlock(r, TEST_MIN_RMS_MV, TEST_MIN_RATIO) == FLICKER_STEADY);
+    }
+    TEST_ASSERT_TRUE(maxRms < TEST_MIN_RMS_MV);
+}
+
+// ----------------------------------------------------------------------------
+void test_confirm_rule() {
+    TEST_ASSERT_EQUAL_UINT32(0, flickerConfirmMs(true, false, TEST_PLAIN_MS, TEST_STEADY_MS));
+    TEST_ASSERT_EQUAL_UINT32(0, flickerConfirmMs(true, true, TEST_PLAIN_MS, TEST_STEADY_MS));
+    TEST_ASSERT_EQUAL_UINT32(TEST_STEADY_MS, flickerConfirmMs(false, true, TEST_PLAIN_MS, TEST_STEADY_MS));
+    TEST_ASSERT_EQUAL_UINT32(TEST_PLAIN_MS, flickerConfirmMs(false, false, TEST_PLAIN_MS, TEST_STEADY_MS));
+}
+
+// Time from the start of a spike until evaluateTemporal() would confirm it,
+// with a verdict after every block; 0 if never within limitMs
+template <typename Signal>
+static uint32_t confirmTime(Signal signal, uint32_t limitMs) {
+    GoertzelBank bank;
+    sampleIndex = 0;
+    FlickerVerdict verdict = FLICKER_UNKNOWN;
+    for (uint32_t ms = TEST_BLOCK_MS; ms <= limitMs; ms += TEST_BLOCK_MS) {
+        FlickerResult r = runBlocks(bank, 1, signal);
+        verdict = classifyFlickerBlock(r, TEST_MIN_RMS_MV, TEST_MIN_RATIO);
+        uint32_t required = flickerConfirmMs(verdict == FLICKER_PRESENT, verdict == FLICKER_STEADY,
+                                             TEST_PLAIN_MS, TEST_STEADY_MS);
+        if (ms >= required) return ms;
+    }
+    return 0;
+}
+
+void test_weak_flame_is_delayed_not_blocked() {
+    // In-band RMS ~10 mV: below FLICKER_MIN_RMS_MV, so every block reads steady
+    uint32_t weak = confirmTime(Flame{0.125f}, 10000);
+    uint32_t strong = confirmTime(Flame{1.0f}, 10000);
+    uint32_t lamp = confirmTime(HeatLamp(), 10000);
+
+    char summary[96];
+    snprintf(summary, sizeof(summary), "confirmed after: flame %lu ms, weak flame %lu ms, heat lamp %lu ms",
+             (unsigned long)strong, (unsigned long)weak, (unsigned long)lamp);
+    TEST_MESSAGE(summary);
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLOCK_MS, strong);
+    TEST_ASSERT_EQUAL_UINT32(TEST_STEADY_MS, weak);
+    TEST_ASSERT_EQUAL_UINT32(TEST_STEADY_MS, lamp);
+}
+
+// Flickers for one block, then burns steadily at the same level
+struct FlameThenSteady {
+    float operator()(float t) const {
+        return (t < TEST_BLOCK_MS / 1000.0f) ? Flame{1.0f}(t) : 1800.0f + 3.0f * noise();
+    }
+};
+
+// POINT case of evaluateSpatialPattern() plus evaluateTemporal(), one
+// verdict per block while the point source stays lit
+void test_confirmed_flame_survives_steady_blocks() {
+    GoertzelBank bank;
+    FlameDetectionState state = FLAME_IDLE;
+    uint32_t potentialSince = 0, confirmedAt = 0, dropped = 0;
+
+    for (uint32_t ms = TEST_BLOCK_MS; ms <= 10000; ms += TEST_BLOCK_MS) {
+        FlickerResult r = runBlocks(bank, 1, FlameThenSteady());
+        FlickerVerdict verdict = classifyFlickerBlock(r, TEST_MIN_RMS_MV, TEST_MIN_RATIO);
+        if (ms > TEST_BLOCK_MS) TEST_ASSERT_TRUE(verdict == FLICKER_STEADY);
+
+        FlameDetectionState previous = state;
+        state = pointSourceState(state);
+        if (previous == FLAME_IDLE) potentialSince = ms - TEST_BLOCK_MS;
+        if (state == FLAME_POTENTIAL) {
+            uint32_t required = flickerConfirmMs(verdict == FLICKER_PRESENT, verdict == FLICKER_STEADY,
+                                                 TEST_PLAIN_MS, TEST_STEADY_MS);
+            if (ms - potentialSince >= required) {
+                state = FLAME_DETECTED;
+                if (confirmedAt == 0) confirmedAt = ms;
+            }
+        }
+        if (previous == FLAME_DETECTED && state != FLAME_DETECTED) dropped++;
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(TEST_BLOCK_MS, confirmedAt);
+    TEST_ASSERT_EQUAL_UINT32(0, dropped);
+    TEST_ASSERT_TRUE(state == FLAME_DETECTED);
+}
+
+void test_point_source_state() {
+    TEST_ASSERT_TRUE(pointSourceState(FLAME_IDLE) == FLAME_POTENTIAL);
+    TEST_ASSERT_TRUE(pointSourceState(FLAME_AMBIENT_INTERFERENCE) == FLAME_POTENTIAL);
+    TEST_ASSERT_TRUE(pointSourceState(FLAME_POTENTIAL) == FLAME_POTENTIAL);
+    TEST_ASSERT_TRUE(pointSourceState(FLAME_DETECTED) == FLAME_DETECTED);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_in_bin_sinusoid_reads_rms);
+    RUN_TEST(test_constant_level_has_no_band_energy);
+    RUN_TEST(test_flame_flicker_is_present);
+    RUN_TEST(test_heat_lamp_is_steady);
+    RUN_TEST(test_white_noise_is_steady);
+    RUN_TEST(test_confirm_rule);
+    RUN_TEST(test_weak_flame_is_delayed_not_blocked);
+    RUN_TEST(test_point_source_state);
+    RUN_TEST(test_confirmed_flame_survives_steady_blocks);
+    return UNITY_END();
+}
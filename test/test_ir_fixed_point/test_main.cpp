@@ -0,0 +1,174 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "IRFixedPoint.h"
+
+// ============================================================================
+// Integer baseline pipeline against the float path of
+// IRFlameSensor::updateBaselines() over a long synthetic trace: 0-3300 mV
+// steps, ramps, noise and short spikes on five channels with different
+// margins, starting from the 1/(n+1) warm-up.
+// ============================================================================
+
+#define TEST_EMA_ALPHA      0.01f       // EMA_ALPHA in IRFlameSensor.h
+#define TEST_WARMUP         100         // IR_WARMUP_UPDATES
+#define TEST_CHANNELS       5
+#define TEST_UPDATES        200000      // Per channel: 10^6 updates in total
+#define TOLERANCE_MV        0.05f       // Stated in IRFixedPoint.h
+
+static uint32_t rngState;
+
+static uint32_t nextRandom() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+static float uniform(float lo, float hi) {
+    return lo + (hi - lo) * (nextRandom() & 0xFFFF) / 65535.0f;
+}
+
+// Piecewise trace: a level that steps or ramps every few hundred updates,
+// white noise on top and an occasional spike burst
+struct TraceChannel {
+    float level, target, slope, sigma;
+    int segmentLeft, burstLeft;
+
+    uint16_t next() {
+        if (segmentLeft-- <= 0) {
+            segmentLeft = 50 + nextRandom() % 800;
+            target = uniform(0.0f, 3300.0f);
+            slope = (nextRandom() & 1) ? 0.0f : (target - level) / segmentLeft;   // Step or ramp
+            if (slope == 0.0f) level = target;
+            sigma = uniform(0.0f, 40.0f);
+        }
+        level += slope;
+        if (burstLeft == 0 && nextRandom() % 500 == 0) burstLeft = 5 + nextRandom() % 20;
+        float burst = (burstLeft > 0) ? (burstLeft--, 600.0f) : 0.0f;
+
+        float noise = 0.0f;
+        for (int k = 0; k < 4; k++) noise += uniform(-1.0f, 1.0f);
+        float v = level + burst + sigma * noise * 0.866f;
+        return (uint16_t)(v < 0.0f ? 0.0f : (v > 3300.0f ? 3300.0f : v));
+    }
+};
+
+void setUp() {
+    rngState = 12345;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_alpha_constant_precision() {
+    float alpha = IR_ALPHA_Q24(TEST_EMA_ALPHA) / 16777216.0f;
+    TEST_ASSERT_FLOAT_WITHIN(1e-6f * TEST_EMA_ALPHA, TEST_EMA_ALPHA, alpha);
+}
+
+void test_warmup_alpha_is_integer_reciprocal() {
+    int32_t floorQ24 = IR_ALPHA_Q24(TEST_EMA_ALPHA);
+    TEST_ASSERT_EQUAL_INT32(1L << 24, irWarmupAlphaQ24(0, floorQ24));
+    for (uint32_t n = 0; n < 1000; n++) {
+        float expected = 1.0f / (n + 1);
+        if (expected < TEST_EMA_ALPHA) expected = TEST_EMA_ALPHA;
+        float actual = irWarmupAlphaQ24(n, floorQ24) / 16777216.0f;
+        TEST_ASSERT_FLOAT_WITHIN(2.0f / 16777216.0f + 1e-6f * expected, expected, actual);
+    }
+}
+
+void test_first_update_seeds_baseline() {
+    uint16_t raw[TEST_CHANNELS] = {0, 1, 1500, 2999, 3300};
+    int32_t baseline[TEST_CHANNELS] = {0};
+    int32_t deviation[TEST_CHANNELS];
+    int32_t margin[TEST_CHANNELS];
+    for (int i = 0; i < TEST_CHANNELS; i++) margin[i] = irMilliVoltsToQ16(300);
+
+    uint32_t mask = irFixedUpdateChannels(raw, baseline, deviation, TEST_CHANNELS,
+                                          irWarmupAlphaQ24(0, IR_ALPHA_Q24(TEST_EMA_ALPHA)), margin);
+    TEST_ASSERT_EQUAL_UINT32(0, mask);
+    for (int i = 0; i < TEST_CHANNELS; i++) {
+        TEST_ASSERT_EQUAL_INT32(irMilliVoltsToQ16(raw[i]), baseline[i]);
+        TEST_ASSERT_EQUAL_INT32(0, deviation[i]);
+    }
+}
+
+void test_spike_mask_per_channel_margin() {
+    uint16_t raw[TEST_CHANNELS] = {1000, 1000, 1000, 1000, 1000};
+    int32_t baseline[TEST_CHANNELS], deviation[TEST_CHANNELS], margin[TEST_CHANNELS];
+    for (int i = 0; i < TEST_CHANNELS; i++) {
+        baseline[i] = irMilliVoltsToQ16(800);
+        margin[i] = irMilliVoltsToQ16(100 + 50 * i);           // 100..300 mV
+    }
+    // Deviation after one step at alpha 0.01 is 198 mV: above 100 and 150 only
+    uint32_t mask = irFixedUpdateChannels(raw, baseline, deviation, TEST_CHANNELS,
+                                          IR_ALPHA_Q24(TEST_EMA_ALPHA), margin);
+    TEST_ASSERT_EQUAL_UINT32(0x03, mask);
+}
+
+void test_long_trace_matches_float_path() {
+    TraceChannel traces[TEST_CHANNELS] = {};
+    float baseline[TEST_CHANNELS] = {0}, deviation[TEST_CHANNELS];
+    float margin[TEST_CHANNELS];
+    int32_t baselineQ16[TEST_CHANNELS] = {0}, deviationQ16[TEST_CHANNELS], marginQ16[TEST_CHANNELS];
+    for (int i = 0; i < TEST_CHANNELS; i++) {
+        margin[i] = 100.0f + 125.0f * i;
+        marginQ16[i] = (int32_t)(margin[i] * IR_Q16_ONE);
+    }
+
+    float maxBaselineError = 0.0f, maxDeviationError = 0.0f;
+    uint32_t spikes = 0, disagreements = 0;
+    uint16_t warmup = 0;
+    int32_t floorQ24 = IR_ALPHA_Q24(TEST_EMA_ALPHA);
+
+    for (uint32_t t = 0; t < TEST_UPDATES; t++) {
+        uint16_t raw[TEST_CHANNELS];
+        for (int i = 0; i < TEST_CHANNELS; i++) raw[i] = traces[i].next();
+
+        // Float path, as IRFlameSensor::updateBaselines()
+        float alpha = 1.0f / (warmup + 1);
+        if (alpha < TEST_EMA_ALPHA) alpha = TEST_EMA_ALPHA;
+        uint32_t floatMask = 0;
+        for (int i = 0; i < TEST_CHANNELS; i++) {
+            baseline[i] = (alpha * raw[i]) + ((1.0f - alpha) * baseline[i]);
+            deviation[i] = raw[i] - baseline[i];
+            if (deviation[i] > margin[i]) floatMask |= (1UL << i);
+        }
+
+        uint32_t fixedMask = irFixedUpdateChannels(raw, baselineQ16, deviationQ16, TEST_CHANNELS,
+                                                   irWarmupAlphaQ24(warmup, floorQ24), marginQ16);
+        if (warmup < TEST_WARMUP) warmup++;
+
+        for (int i = 0; i < TEST_CHANNELS; i++) {
+            float baselineError = fabsf(irQ16ToMilliVolts(baselineQ16[i]) - baseline[i]);
+            float deviationError = fabsf(irQ16ToMilliVolts(deviationQ16[i]) - deviation[i]);
+            if (baselineError > maxBaselineError) maxBaselineError = baselineError;
+            if (deviationError > maxDeviationError) maxDeviationError = deviationError;
+
+            bool floatSpike = (floatMask >> i) & 1;
+            if (floatSpike) spikes++;
+            if (floatSpike != (bool)((fixedMask >> i) & 1)) {
+                disagreements++;
+                // Only allowed when the deviation sits on the margin
+                TEST_ASSERT_FLOAT_WITHIN(TOLERANCE_MV, margin[i], deviation[i]);
+            }
+        }
+    }
+
+    char summary[128];
+    snprintf(summary, sizeof(summary), "max error: baseline %.4f mV, deviation %.4f mV; %lu spikes, %lu disagree",
+             maxBaselineError, maxDeviationError, (unsigned long)spikes, (unsigned long)disagreements);
+    TEST_MESSAGE(summary);
+
+    TEST_ASSERT_GREATER_THAN(1000, spikes);                     // The trace does exercise the spike test
+    TEST_ASSERT_TRUE(maxBaselineError <= TOLERANCE_MV);
+    TEST_ASSERT_TRUE(maxDeviationError <= TOLERANCE_MV);
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_alpha_constant_precision);
+    RUN_TEST(test_warmup_alpha_is_integer_reciprocal);
+    RUN_TEST(test_first_update_seeds_baseline);
+    RUN_TEST(test_spike_mask_per_channel_margin);
+    RUN_TEST(test_long_trace_matches_float_path);
+    return UNITY_END();
+}
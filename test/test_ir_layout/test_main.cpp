@@ -0,0 +1,105 @@
+#include <unity.h>
+#include <string.h>
+#include "IRFlameSensor.h"
+
+// ============================================================================
+// A second array layout next to the board's IRStrip5Layout: a ring of 8
+// sensors where the last one neighbours the first. Generates its spatial
+// table, the detector class and the RTC snapshot record on the host.
+// ============================================================================
+
+static const int RING8_PINS[] = {32, 33, 34, 35, 36, 37, 38, 39};
+
+struct IRRing8Layout {
+    static const uint8_t channels = 8;
+    static const IRArrayTopology topology = IR_TOPOLOGY_RING;
+    static const uint8_t ambientMin = 5;
+    static int pin(uint8_t channel) { return RING8_PINS[channel]; }
+};
+
+// Same sensors in a line: the ends are not neighbours
+struct IRStrip8Layout {
+    static const uint8_t channels = 8;
+    static const IRArrayTopology topology = IR_TOPOLOGY_LINEAR;
+    static const uint8_t ambientMin = 5;
+    static int pin(uint8_t channel) { return RING8_PINS[channel]; }
+};
+
+typedef IRSpatialTable<IRRing8Layout> Ring8Table;
+typedef IRSpatialTable<IRStrip8Layout> Strip8Table;
+typedef IRSpatialTable<IRStrip5Layout> Strip5Table;
+
+void setUp() {}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_ring_table() {
+    TEST_ASSERT_EQUAL_UINT32(256, sizeof(Ring8Table::table));
+    TEST_ASSERT_TRUE(Ring8Table::classify(0x00) == IR_SPATIAL_IDLE);
+    TEST_ASSERT_TRUE(Ring8Table::classify(0x10) == IR_SPATIAL_POINT);
+    TEST_ASSERT_TRUE(Ring8Table::classify(0x18) == IR_SPATIAL_POINT);
+    TEST_ASSERT_TRUE(Ring8Table::classify(0x81) == IR_SPATIAL_POINT);      // Wraps around
+    TEST_ASSERT_TRUE(Ring8Table::classify(0x11) == IR_SPATIAL_SCATTERED);
+    TEST_ASSERT_TRUE(Ring8Table::classify(0x0F) == IR_SPATIAL_SCATTERED);  // 4 < ambientMin
+    TEST_ASSERT_TRUE(Ring8Table::classify(0x1F) == IR_SPATIAL_AMBIENT);
+    TEST_ASSERT_TRUE(Ring8Table::classify(0x100) == IR_SPATIAL_IDLE);      // Bit 8 is not a channel
+}
+
+void test_strip_ends_are_not_neighbours() {
+    TEST_ASSERT_TRUE(Strip8Table::classify(0x81) == IR_SPATIAL_SCATTERED);
+    TEST_ASSERT_TRUE(Strip8Table::classify(0xC0) == IR_SPATIAL_POINT);
+
+    // Every mask of the board's strip, against the rules in IRArrayLayout.h
+    for (uint32_t mask = 0; mask < 32; mask++) {
+        uint8_t count = irMaskPopcount(mask);
+        bool pair = count == 2 && irMaskHighestBit(mask) - irMaskLowestBit(mask) == 1;
+        IRSpatialClass expected = count == 0 ? IR_SPATIAL_IDLE :
+                                  count >= 4 ? IR_SPATIAL_AMBIENT :
+                                  (count == 1 || pair) ? IR_SPATIAL_POINT : IR_SPATIAL_SCATTERED;
+        TEST_ASSERT_TRUE(Strip5Table::classify(mask) == expected);
+    }
+}
+
+void test_detector_is_sized_from_layout() {
+    // Per-channel state grows with the layout; nothing is sized by the board
+    TEST_ASSERT_GREATER_THAN(sizeof(IRFlameSensorT<IRStrip5Layout>), sizeof(IRFlameSensorT<IRRing8Layout>));
+    TEST_ASSERT_EQUAL_UINT32(sizeof(IRFlameSensorT<IRStrip8Layout>), sizeof(IRFlameSensorT<IRRing8Layout>));
+    TEST_ASSERT_EQUAL_UINT32(5, IR_NUM_CHANNELS);
+}
+
+void test_snapshot_record() {
+    TEST_ASSERT_GREATER_THAN(sizeof(IRBaselineSnapshotT<5>), sizeof(IRBaselineSnapshotT<8>));
+    TEST_ASSERT_TRUE(sizeof(IRBaselineSnapshotT<8>) <= sizeof(IRBaselineSnapshotT<IR_MAX_LAYOUT_CHANNELS>));
+
+    IRBaselineSnapshotT<IRRing8Layout::channels> snapshot;
+    memset(&snapshot, 0, sizeof(snapshot));
+    snapshot.magic = 0x49524231UL;
+    snapshot.channels = IRRing8Layout::channels;
+    for (int i = 0; i < IRRing8Layout::channels; i++) {
+        snapshot.baseline[i] = 1000.0f + i;
+        snapshot.residualVariance[i] = 4.0f;
+        snapshot.quietUpdates[i] = 400;
+    }
+    snapshot.checksum = snapshot.computeChecksum();
+    TEST_ASSERT_EQUAL_UINT32(snapshot.checksum, snapshot.computeChecksum());
+
+    // The last channel of the 8-sensor record is covered by the checksum
+    snapshot.quietUpdates[7]++;
+    TEST_ASSERT_TRUE(snapshot.checksum != snapshot.computeChecksum());
+    snapshot.quietUpdates[7]--;
+
+    // The checksum itself is not
+    uint32_t expected = snapshot.checksum;
+    snapshot.checksum ^= 1;
+    TEST_ASSERT_EQUAL_UINT32(expected, snapshot.computeChecksum());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_table);
+    RUN_TEST(test_strip_ends_are_not_neighbours);
+    RUN_TEST(test_detector_is_sized_from_layout);
+    RUN_TEST(test_snapshot_record);
+    return UNITY_END();
+}
@@ -0,0 +1,183 @@
+#include <unity.h>
+#include <algorithm>
+#include <stdio.h>
+#include "MedianFilter.h"
+
+// ============================================================================
+// Bose-Nelson networks of every supported size (1..64) against
+// std::nth_element / std::sort on random, sorted, reversed and
+// duplicate-heavy windows, the comparator counts against the compare-swaps
+// actually executed, and the window / streaming filters on glitched data.
+// ============================================================================
+
+#define TEST_MAX_N          64          // SortingNetwork limit
+#define TEST_ROUNDS         200         // Random windows per size
+
+static uint32_t rngState;
+
+static uint32_t nextRandom() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+// Value that counts how often the network compares it
+struct Counted {
+    uint16_t value;
+    static uint32_t comparisons;
+
+    bool operator<(const Counted& other) const {
+        comparisons++;
+        return value < other.value;
+    }
+};
+
+uint32_t Counted::comparisons = 0;
+
+void setUp() {
+    rngState = 4242;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+// Fill `v` with window kind `round`: sorted, reversed, few distinct values,
+// 12-bit ADC codes
+static void fillWindow(uint16_t* v, int n, int round) {
+    for (int i = 0; i < n; i++) {
+        switch (round) {
+            case 0:  v[i] = (uint16_t)i; break;
+            case 1:  v[i] = (uint16_t)(n - i); break;
+            case 2:  v[i] = (uint16_t)(nextRandom() % 3); break;
+            default: v[i] = (uint16_t)(nextRandom() & 0x0FFF); break;
+        }
+    }
+}
+
+template <int N>
+static void checkSize() {
+    uint16_t v[N], sorted[N], reference[N];
+
+    for (int round = 0; round < TEST_ROUNDS; round++) {
+        fillWindow(v, N, round);
+
+        for (int i = 0; i < N; i++) sorted[i] = reference[i] = v[i];
+        SortingNetwork<uint16_t, N>::sort(sorted);
+        std::sort(reference, reference + N);
+        for (int i = 0; i < N; i++) {
+            if (sorted[i] != reference[i]) {
+                char message[64];
+                snprintf(message, sizeof(message), "N=%d round %d: index %d out of order", N, round, i);
+                TEST_FAIL_MESSAGE(message);
+            }
+        }
+
+        // Median as medianOf() defines it, from a partial selection
+        for (int i = 0; i < N; i++) reference[i] = v[i];
+        std::nth_element(reference, reference + N / 2, reference + N);
+        uint16_t upper = reference[N / 2];
+        uint16_t expected = upper;
+        if (!(N & 1)) {
+            uint16_t lower = *std::max_element(reference, reference + N / 2);
+            expected = (uint16_t)((lower + upper) / 2);
+        }
+        for (int i = 0; i < N; i++) sorted[i] = v[i];
+        TEST_ASSERT_EQUAL_UINT16(expected, (medianOf<uint16_t, N>(sorted)));
+    }
+
+    // Every compare-swap compares twice; the count must match comparators
+    Counted c[N];
+    for (int i = 0; i < N; i++) c[i].value = (uint16_t)(nextRandom() & 0x0FFF);
+    Counted::comparisons = 0;
+    SortingNetwork<Counted, N>::sort(c);
+    TEST_ASSERT_EQUAL_UINT32(2u * (SortingNetwork<uint16_t, N>::comparators), Counted::comparisons);
+}
+
+template <int N>
+struct EverySize {
+    static void check() {
+        EverySize<N - 1>::check();
+        checkSize<N>();
+    }
+};
+
+template <>
+struct EverySize<0> {
+    static void check() {}
+};
+
+void test_networks_match_std_for_every_size() {
+    EverySize<TEST_MAX_N>::check();
+}
+
+void test_comparator_counts() {
+    TEST_ASSERT_EQUAL_UINT16(0, (SortingNetwork<uint16_t, 1>::comparators));
+    TEST_ASSERT_EQUAL_UINT16(27, (SortingNetwork<uint16_t, 9>::comparators));
+    TEST_ASSERT_EQUAL_UINT16(206, (SortingNetwork<uint16_t, 31>::comparators));
+}
+
+// 0-1 principle: a network sorts everything iff it sorts every 0/1 input
+template <int N>
+static void checkZeroOne() {
+    for (uint32_t bits = 0; bits < (1UL << N); bits++) {
+        uint8_t v[N];
+        for (int i = 0; i < N; i++) v[i] = (bits >> i) & 1;
+        SortingNetwork<uint8_t, N>::sort(v);
+        for (int i = 1; i < N; i++) {
+            if (v[i - 1] > v[i]) TEST_FAIL_MESSAGE("0-1 input left unsorted");
+        }
+    }
+}
+
+void test_zero_one_principle() {
+    checkZeroOne<5>();
+    checkZeroOne<9>();
+    checkZeroOne<16>();
+    checkZeroOne<20>();
+}
+
+// ----------------------------------------------------------------------------
+void test_window_filters_reject_glitch() {
+    uint16_t v[9], copy[9];
+    for (int i = 0; i < 9; i++) v[i] = (uint16_t)(2000 + (nextRandom() % 5));
+    v[4] = 4095;
+
+    for (int i = 0; i < 9; i++) copy[i] = v[i];
+    uint16_t mean = meanOf<uint16_t, 9>(copy);
+    uint16_t median = medianOf<uint16_t, 9>(copy);
+    for (int i = 0; i < 9; i++) copy[i] = v[i];
+    uint16_t hampel = hampelMeanOf<uint16_t, 9>(copy);
+
+    TEST_ASSERT_GREATER_THAN(2200, mean);
+    TEST_ASSERT_TRUE(median >= 1995 && median <= 2009);
+    TEST_ASSERT_TRUE(hampel >= 1995 && hampel <= 2009);
+}
+
+void test_streaming_modes() {
+    MedianFilter<uint16_t, 5> filter;
+    TEST_ASSERT_TRUE(filter.getMode() == SAMPLE_FILTER_MEAN);
+    TEST_ASSERT_EQUAL_UINT16(4095, filter.push(4095));         // Mean passes through
+
+    // Median: a lone glitch never comes out once the window is full
+    filter.setMode(SAMPLE_FILTER_MEDIAN);
+    static const uint16_t input[] = {1000, 1001, 999, 1000, 4095, 1002, 998, 0, 1001, 1000};
+    for (unsigned i = 0; i < sizeof(input) / sizeof(input[0]); i++) {
+        uint16_t out = filter.push(input[i]);
+        if (i >= 4) TEST_ASSERT_TRUE(out >= 998 && out <= 1002);
+    }
+
+    // Hampel: inliers pass unchanged, the outlier becomes the median
+    filter.setMode(SAMPLE_FILTER_HAMPEL);
+    for (int i = 0; i < 4; i++) filter.push((uint16_t)(1000 + i));
+    TEST_ASSERT_EQUAL_UINT16(1003, filter.push(1003));
+    TEST_ASSERT_EQUAL_UINT16(1003, filter.push(4095));         // Window 1001..1003, 1003, 4095
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_networks_match_std_for_every_size);
+    RUN_TEST(test_comparator_counts);
+    RUN_TEST(test_zero_one_principle);
+    RUN_TEST(test_window_filters_reject_glitch);
+    RUN_TEST(test_streaming_modes);
+    return UNITY_END();
+}
@@ -0,0 +1,79 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "MQ2Table.h"
+
+// ============================================================================
+// MQ2PPMTable against the library formula (MQ2PPMTable::computePPM, the
+// pow() chain) at every ADC code and every half code in between
+// ============================================================================
+
+#define ADC_CODES               (1 << MQ2_ADC_BIT_RESOLUTION)
+#define MAX_RELATIVE_ERROR      0.007f      // Bound stated in MQ2Table.h (1 PPM and up)
+#define MAX_ABSOLUTE_ERROR_PPM  0.01f       // Below 1 PPM, where relative error is meaningless
+
+static MQ2PPMTable table;
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_table_within_bound_for_every_code() {
+    table.build();
+
+    float worst = 0.0f, worstCode = 0.0f;
+    for (int half = 0; half < 2 * ADC_CODES - 1; half++) {
+        float code = half * 0.5f;
+        float exact = MQ2PPMTable::computePPM(code);
+        float approx = table.lookup(code);
+
+        if (exact < 1.0f) {
+            TEST_ASSERT_FLOAT_WITHIN(MAX_ABSOLUTE_ERROR_PPM, exact, approx);
+            continue;
+        }
+        float relative = fabsf(approx - exact) / exact;
+        if (relative > worst) {
+            worst = relative;
+            worstCode = code;
+        }
+    }
+
+    char summary[96];
+    snprintf(summary, sizeof(summary), "max relative error %.3f%% at code %.1f", worst * 100.0f, worstCode);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_TRUE(worst <= MAX_RELATIVE_ERROR);
+}
+
+void test_full_scale_hits_the_clamped_last_knot() {
+    table.build();
+    float top = (float)(ADC_CODES - 1);
+
+    // The last knot sits past the last code and is built from the last code
+    TEST_ASSERT_EQUAL_FLOAT(MQ2PPMTable::computePPM(top), table.lookup(top));
+    TEST_ASSERT_EQUAL_FLOAT(MQ2_PPM_CEILING, table.lookup(top));
+    TEST_ASSERT_EQUAL_FLOAT(MQ2_PPM_CEILING, table.lookup(top + 100.0f));
+    TEST_ASSERT_FLOAT_WITHIN(MAX_RELATIVE_ERROR * MQ2_PPM_CEILING, MQ2PPMTable::computePPM(top - 0.5f),
+                             table.lookup(top - 0.5f));
+}
+
+void test_bottom_and_monotonic() {
+    table.build();
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, table.lookup(0.0f));
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, table.lookup(-5.0f));
+
+    // Higher voltage = lower Rs = more gas, never the other way round
+    float previous = 0.0f;
+    for (int code = 0; code < ADC_CODES; code++) {
+        float ppm = table.lookup((float)code);
+        TEST_ASSERT_TRUE(ppm >= previous);
+        previous = ppm;
+    }
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_table_within_bound_for_every_code);
+    RUN_TEST(test_full_scale_hits_the_clamped_last_knot);
+    RUN_TEST(test_bottom_and_monotonic);
+    return UNITY_END();
+}
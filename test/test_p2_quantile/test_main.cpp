@@ -0,0 +1,228 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include "P2Quantile.h"
+
+// ============================================================================
+// P2Quantile against known distributions, P2WindowQuantile following a step
+// in the smoke background both ways, and the saved-state round trip that
+// SmokeBaseline persists to NVS (including the states it must refuse).
+// ============================================================================
+
+#define TEST_WINDOW         180         // SMOKE_BASELINE_WINDOW
+
+static uint32_t rngState;
+
+static uint32_t nextRandom() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+static float uniform(float lo, float hi) {
+    return lo + (hi - lo) * (nextRandom() & 0xFFFF) / 65535.0f;
+}
+
+// Near-Gaussian, unit sigma
+static float noise() {
+    float sum = 0.0f;
+    for (int k = 0; k < 4; k++) sum += uniform(-1.0f, 1.0f);
+    return sum * 0.866f;
+}
+
+// Feed `count` background samples around `level`; returns the first sample
+// index at which the estimate came within `tolerance` of `target`, or -1
+static long feed(P2WindowQuantile& q, float level, float sigma, long count, float target, float tolerance) {
+    long reached = -1;
+    for (long i = 0; i < count; i++) {
+        q.push(level + sigma * noise());
+        if (reached < 0 && fabsf(q.value() - target) < tolerance) reached = i;
+    }
+    return reached;
+}
+
+void setUp() {
+    rngState = 12345;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_startup_exact() {
+    P2Quantile q(0.5f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, q.value());
+    q.push(30.0f);
+    q.push(10.0f);
+    q.push(20.0f);
+    TEST_ASSERT_EQUAL_FLOAT(20.0f, q.value());      // Median of the sorted first samples
+    TEST_ASSERT_EQUAL_UINT32(3, q.count());
+}
+
+void test_uniform_p50_p95() {
+    P2Quantile p50(0.5f), p95(0.95f);
+    for (int i = 0; i < 20000; i++) {
+        float x = uniform(0.0f, 1000.0f);
+        p50.push(x);
+        p95.push(x);
+    }
+    TEST_ASSERT_FLOAT_WITHIN(15.0f, 500.0f, p50.value());
+    TEST_ASSERT_FLOAT_WITHIN(10.0f, 950.0f, p95.value());
+}
+
+void test_gaussian_p50_p95() {
+    // 200 PPM background, sigma 10: p95 at mean + 1.645 sigma
+    P2Quantile p50(0.5f), p95(0.95f);
+    for (int i = 0; i < 20000; i++) {
+        float x = 200.0f + 10.0f * noise();
+        p50.push(x);
+        p95.push(x);
+    }
+    char summary[96];
+    snprintf(summary, sizeof(summary), "p50 %.2f (200), p95 %.2f (%.2f)", p50.value(), p95.value(), 200.0f + 16.45f);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_FLOAT_WITHIN(0.5f, 200.0f, p50.value());
+    TEST_ASSERT_FLOAT_WITHIN(1.5f, 216.45f, p95.value());
+}
+
+void test_window_follows_step_up_and_down() {
+    P2WindowQuantile p95(0.95f, TEST_WINDOW);
+    feed(p95, 150.0f, 5.0f, 4 * TEST_WINDOW, 0.0f, 0.0f);
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, 158.2f, p95.value());
+
+    // Background steps up (new furniture, a wet season): the p95 moves once
+    // about 5% of the window is new, and within 2 x window at the latest
+    long reached = feed(p95, 300.0f, 5.0f, 2 * TEST_WINDOW, 308.2f, 5.0f);
+    TEST_ASSERT_GREATER_OR_EQUAL(TEST_WINDOW / 20, reached);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * TEST_WINDOW, reached);
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, 308.2f, p95.value());
+
+    // And back down: old peaks are forgotten, not decayed
+    reached = feed(p95, 150.0f, 5.0f, 2 * TEST_WINDOW, 158.2f, 5.0f);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, reached);
+    TEST_ASSERT_LESS_OR_EQUAL(2 * TEST_WINDOW, reached);
+    TEST_ASSERT_FLOAT_WITHIN(5.0f, 158.2f, p95.value());
+
+    char summary[96];
+    snprintf(summary, sizeof(summary), "step down followed after %ld samples (window %d)", reached, TEST_WINDOW);
+    TEST_MESSAGE(summary);
+}
+
+void test_window_count_bounds() {
+    P2WindowQuantile q(0.5f, TEST_WINDOW);
+    for (int i = 0; i < 5 * TEST_WINDOW + 37; i++) {
+        q.push(uniform(0.0f, 1.0f));
+        if (i >= TEST_WINDOW) {
+            TEST_ASSERT_GREATER_OR_EQUAL(TEST_WINDOW, q.count());
+            TEST_ASSERT_LESS_OR_EQUAL(2 * TEST_WINDOW, q.count());
+        }
+    }
+}
+
+// ----------------------------------------------------------------------------
+void test_state_round_trip() {
+    P2WindowQuantile a(0.95f, TEST_WINDOW);
+    feed(a, 200.0f, 10.0f, 3 * TEST_WINDOW + 11, 0.0f, 0.0f);
+
+    P2WindowQuantile b(0.95f, TEST_WINDOW);
+    TEST_ASSERT_TRUE(b.setState(a.getState()));
+    TEST_ASSERT_EQUAL_FLOAT(a.value(), b.value());
+    TEST_ASSERT_EQUAL_UINT32(a.count(), b.count());
+
+    // Resumed estimator stays in step with the original
+    for (int i = 0; i < 2 * TEST_WINDOW; i++) {
+        float x = 250.0f + 10.0f * noise();
+        a.push(x);
+        b.push(x);
+    }
+    TEST_ASSERT_EQUAL_FLOAT(a.value(), b.value());
+
+    // Warm-up states resume too
+    P2Quantile young(0.5f), copy(0.5f);
+    young.push(3.0f);
+    young.push(1.0f);
+    TEST_ASSERT_TRUE(copy.setState(young.getState()));
+    TEST_ASSERT_EQUAL_FLOAT(young.value(), copy.value());
+}
+
+void test_state_rejects_unordered() {
+    P2Quantile q(0.5f);
+    for (int i = 0; i < 100; i++) q.push(uniform(0.0f, 100.0f));
+    const float before = q.value();
+
+    P2Quantile::State s = q.getState();
+    float swap = s.heights[1];
+    s.heights[1] = s.heights[3];
+    s.heights[3] = swap;
+    TEST_ASSERT_FALSE(q.setState(s));
+
+    s = q.getState();
+    s.positions[2] = s.positions[3];
+    TEST_ASSERT_FALSE(q.setState(s));
+
+    s = q.getState();
+    s.desired[1] = s.desired[4] + 1.0f;
+    TEST_ASSERT_FALSE(q.setState(s));
+
+    P2Quantile young(0.5f);
+    P2Quantile::State w = young.getState();
+    w.count = 3;
+    w.heights[0] = 5.0f;
+    w.heights[1] = 2.0f;
+    TEST_ASSERT_FALSE(young.setState(w));
+
+    TEST_ASSERT_EQUAL_FLOAT(before, q.value());         // Unchanged by the refusals
+}
+
+void test_state_rejects_nan() {
+    P2Quantile q(0.95f);
+    for (int i = 0; i < 100; i++) q.push(uniform(0.0f, 100.0f));
+
+    for (int i = 0; i < 5; i++) {
+        P2Quantile::State s = q.getState();
+        s.heights[i] = NAN;
+        TEST_ASSERT_FALSE(q.setState(s));
+        s = q.getState();
+        s.positions[i] = NAN;
+        TEST_ASSERT_FALSE(q.setState(s));
+        s = q.getState();
+        s.desired[i] = NAN;
+        TEST_ASSERT_FALSE(q.setState(s));
+    }
+}
+
+void test_state_rejects_inconsistent() {
+    P2Quantile q(0.5f);
+    for (int i = 0; i < 100; i++) q.push(uniform(0.0f, 100.0f));
+
+    // Marker positions that do not span 1..count
+    P2Quantile::State s = q.getState();
+    s.count = 50;
+    TEST_ASSERT_FALSE(q.setState(s));
+    s = q.getState();
+    s.positions[0] = 2.0f;
+    TEST_ASSERT_FALSE(q.setState(s));
+
+    // Window halves that do not match the push count (e.g. an NVS blob
+    // written with another window, or a half restarted out of step)
+    P2WindowQuantile a(0.5f, TEST_WINDOW);
+    feed(a, 200.0f, 10.0f, 3 * TEST_WINDOW, 0.0f, 0.0f);
+    P2WindowQuantile::State ws = a.getState();
+    ws.pushes += 7;
+    TEST_ASSERT_FALSE(a.setState(ws));
+
+    P2WindowQuantile other(0.5f, TEST_WINDOW / 2);
+    TEST_ASSERT_FALSE(other.setState(a.getState()));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_startup_exact);
+    RUN_TEST(test_uniform_p50_p95);
+    RUN_TEST(test_gaussian_p50_p95);
+    RUN_TEST(test_window_follows_step_up_and_down);
+    RUN_TEST(test_window_count_bounds);
+    RUN_TEST(test_state_round_trip);
+    RUN_TEST(test_state_rejects_unordered);
+    RUN_TEST(test_state_rejects_nan);
+    RUN_TEST(test_state_rejects_inconsistent);
+    return UNITY_END();
+}
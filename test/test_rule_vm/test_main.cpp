@@ -0,0 +1,278 @@
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "RuleVM.h"
+
+// ============================================================================
+// RuleProgram::load() refusing every kind of broken image (each one built
+// with a valid checksum unless the checksum is the point), and evaluate() on
+// the shipped rule sets against known sensor situations.
+// ============================================================================
+
+// tools/rulec.py tools/rules/default.rules --hex
+static const uint8_t DEFAULT_IMAGE[] = {
+    0x41, 0x52, 0x01, 0x02, 0x02, 0x05, 0x01, 0x10, 0x01, 0x0f, 0x01, 0x11, 0x0e, 0xde, 0x61
+};
+
+// tools/rulec.py tools/rules/kitchen.rules --hex
+static const uint8_t KITCHEN_IMAGE[] = {
+    0x41, 0x52, 0x01, 0x02, 0x0e, 0x1d, 0x01, 0x00, 0x01, 0x0a, 0x0d, 0x01, 0x0e, 0x00, 0x00, 0x00,
+    0xa0, 0x42, 0x0a, 0x0e, 0x01, 0x0f, 0x01, 0x0a, 0x01, 0x08, 0x00, 0x00, 0x00, 0x80, 0x3f, 0x09,
+    0x01, 0x0d, 0x0e, 0x0d, 0x0e, 0x01, 0x11, 0x01, 0x12, 0x00, 0x00, 0x00, 0xf0, 0x41, 0x07, 0x0d,
+    0x0e, 0x82, 0x85
+};
+
+static RuleProgram program;
+static uint8_t image[RULE_MAX_IMAGE + 8];
+static float inputs[RULE_NUM_INPUTS];
+
+// Header, the two sections and a correct checksum; returns the length
+static size_t build(const uint8_t* bahaya, uint8_t bahayaLength, const uint8_t* waspada, uint8_t waspadaLength) {
+    size_t n = 0;
+    image[n++] = 'A';
+    image[n++] = 'R';
+    image[n++] = RULE_IMAGE_VERSION;
+    image[n++] = RULE_NUM_OUTPUTS;
+    image[n++] = bahayaLength;
+    image[n++] = waspadaLength;
+    memcpy(image + n, bahaya, bahayaLength);
+    n += bahayaLength;
+    memcpy(image + n, waspada, waspadaLength);
+    n += waspadaLength;
+    return n + 2;
+}
+
+static size_t seal(size_t length) {
+    uint16_t sum = ruleFletcher16(image, length - 2);
+    image[length - 2] = sum & 0xFF;
+    image[length - 1] = sum >> 8;
+    return length;
+}
+
+static const uint8_t TRUE_CODE[] = {RULE_OP_INPUT, RULE_IN_FLAME};
+
+// Load an image whose Waspada section is `code`; returns the refusal reason
+static const char* refusal(const uint8_t* code, uint8_t length) {
+    const char* error = NULL;
+    size_t n = seal(build(TRUE_CODE, sizeof(TRUE_CODE), code, length));
+    TEST_ASSERT_FALSE(program.load(image, n, &error));
+    TEST_ASSERT_NOT_NULL(error);
+    return error;
+}
+
+static void loadImage(const uint8_t* data, size_t length) {
+    const char* error = "not run";
+    TEST_ASSERT_TRUE(program.load(data, length, &error));
+    TEST_ASSERT_NULL(error);
+}
+
+void setUp() {
+    program.clear();
+    memset(inputs, 0, sizeof(inputs));
+    inputs[RULE_IN_TEMP] = 25.0f;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_valid_image_loads() {
+    size_t n = seal(build(TRUE_CODE, sizeof(TRUE_CODE), TRUE_CODE, sizeof(TRUE_CODE)));
+    loadImage(image, n);
+    TEST_ASSERT_EQUAL(n, program.size());
+    inputs[RULE_IN_FLAME] = 1.0f;
+    TEST_ASSERT_TRUE(program.isTrue(RULE_OUT_WASPADA, inputs));
+}
+
+void test_rejects_header() {
+    const char* error = NULL;
+    size_t n = seal(build(TRUE_CODE, sizeof(TRUE_CODE), TRUE_CODE, sizeof(TRUE_CODE)));
+
+    TEST_ASSERT_FALSE(program.load(image, 4 + RULE_NUM_OUTPUTS + 1, &error));
+    TEST_ASSERT_EQUAL_STRING("bad size", error);
+    TEST_ASSERT_FALSE(program.load(image, RULE_MAX_IMAGE + 1, &error));
+    TEST_ASSERT_EQUAL_STRING("bad size", error);
+
+    image[1] = 'X';
+    TEST_ASSERT_FALSE(program.load(image, seal(n), &error));
+    TEST_ASSERT_EQUAL_STRING("bad magic", error);
+
+    image[1] = 'R';
+    image[2] = RULE_IMAGE_VERSION + 1;
+    TEST_ASSERT_FALSE(program.load(image, seal(n), &error));
+    TEST_ASSERT_EQUAL_STRING("unsupported version", error);
+
+    image[2] = RULE_IMAGE_VERSION;
+    image[3] = RULE_NUM_OUTPUTS + 1;
+    TEST_ASSERT_FALSE(program.load(image, seal(n), &error));
+    TEST_ASSERT_EQUAL_STRING("wrong number of outputs", error);
+
+    TEST_ASSERT_FALSE(program.isLoaded());
+}
+
+void test_rejects_checksum() {
+    const char* error = NULL;
+    memcpy(image, KITCHEN_IMAGE, sizeof(KITCHEN_IMAGE));
+    image[16] ^= 0x01;                          // Flip a bit of the constant 80
+    TEST_ASSERT_FALSE(program.load(image, sizeof(KITCHEN_IMAGE), &error));
+    TEST_ASSERT_EQUAL_STRING("checksum mismatch", error);
+
+    memcpy(image, KITCHEN_IMAGE, sizeof(KITCHEN_IMAGE));
+    image[sizeof(KITCHEN_IMAGE) - 1] ^= 0x80;
+    TEST_ASSERT_FALSE(program.load(image, sizeof(KITCHEN_IMAGE), &error));
+    TEST_ASSERT_EQUAL_STRING("checksum mismatch", error);
+}
+
+void test_rejects_section_lengths() {
+    const char* error = NULL;
+    size_t n = build(TRUE_CODE, sizeof(TRUE_CODE), TRUE_CODE, sizeof(TRUE_CODE));
+    image[5] = sizeof(TRUE_CODE) + 1;           // Sections claim one byte more than there is
+    TEST_ASSERT_FALSE(program.load(image, seal(n), &error));
+    TEST_ASSERT_EQUAL_STRING("section lengths do not match the size", error);
+
+    image[5] = sizeof(TRUE_CODE) - 1;
+    TEST_ASSERT_FALSE(program.load(image, seal(n), &error));
+    TEST_ASSERT_EQUAL_STRING("section lengths do not match the size", error);
+}
+
+void test_rejects_code() {
+    const uint8_t unknownOp[] = {RULE_NUM_OPS};
+    TEST_ASSERT_EQUAL_STRING("unknown opcode", refusal(unknownOp, sizeof(unknownOp)));
+
+    const uint8_t truncatedConst[] = {RULE_OP_CONST, 0x00, 0x00, 0x80};
+    TEST_ASSERT_EQUAL_STRING("truncated operand", refusal(truncatedConst, sizeof(truncatedConst)));
+    const uint8_t truncatedInput[] = {RULE_OP_INPUT};
+    TEST_ASSERT_EQUAL_STRING("truncated operand", refusal(truncatedInput, sizeof(truncatedInput)));
+
+    const uint8_t unknownInput[] = {RULE_OP_INPUT, RULE_NUM_INPUTS};
+    TEST_ASSERT_EQUAL_STRING("unknown input", refusal(unknownInput, sizeof(unknownInput)));
+
+    const uint8_t underflow[] = {RULE_OP_INPUT, RULE_IN_SMOKE, RULE_OP_ADD};
+    TEST_ASSERT_EQUAL_STRING("stack underflow", refusal(underflow, sizeof(underflow)));
+    const uint8_t selectUnderflow[] = {RULE_OP_INPUT, RULE_IN_FLAME, RULE_OP_INPUT, RULE_IN_SMOKE, RULE_OP_SELECT};
+    TEST_ASSERT_EQUAL_STRING("stack underflow", refusal(selectUnderflow, sizeof(selectUnderflow)));
+
+    uint8_t overflow[2 * (RULE_STACK_DEPTH + 1)];
+    for (int i = 0; i <= RULE_STACK_DEPTH; i++) {
+        overflow[2 * i] = RULE_OP_INPUT;
+        overflow[2 * i + 1] = RULE_IN_SMOKE;
+    }
+    TEST_ASSERT_EQUAL_STRING("stack overflow", refusal(overflow, sizeof(overflow)));
+
+    const uint8_t leavesTwo[] = {RULE_OP_INPUT, RULE_IN_FLAME, RULE_OP_INPUT, RULE_IN_SMOKE};
+    TEST_ASSERT_EQUAL_STRING("rule must leave exactly one value", refusal(leavesTwo, sizeof(leavesTwo)));
+    TEST_ASSERT_EQUAL_STRING("rule must leave exactly one value", refusal(leavesTwo, 0));
+}
+
+void test_failed_load_keeps_program() {
+    loadImage(KITCHEN_IMAGE, sizeof(KITCHEN_IMAGE));
+    const uint8_t unknownOp[] = {RULE_NUM_OPS};
+    refusal(unknownOp, sizeof(unknownOp));
+    TEST_ASSERT_EQUAL(sizeof(KITCHEN_IMAGE), program.size());
+    TEST_ASSERT_EQUAL(0, memcmp(KITCHEN_IMAGE, program.data(), sizeof(KITCHEN_IMAGE)));
+}
+
+// ----------------------------------------------------------------------------
+// Sensor situations, evaluated by both shipped rule sets
+struct Situation {
+    const char* name;
+    float flame, smokeHigh, smokeSlope, tempHigh, score, scoreWaspada, scoreBahaya, prealarm, prealarmEta;
+    bool kitchenBahaya, kitchenWaspada, defaultBahaya, defaultWaspada;
+};
+
+static const Situation SITUATIONS[] = {
+    // name                 flame smoke slope temp score  W  B  pre  eta    kitchen B/W   default B/W
+    {"quiet",               0, 0, 0.0f, 0,  5.0f, 0, 0, 0,  -1.0f, false, false, false, false},
+    {"frying",              0, 1, 2.0f, 0, 40.0f, 1, 0, 0,  -1.0f, false, true,  false, true},
+    {"smoke settling",      0, 1, 0.5f, 0, 25.0f, 0, 0, 0,  -1.0f, false, false, false, false},
+    {"oven heat and smoke", 0, 1, 0.0f, 1, 65.0f, 1, 1, 0,  -1.0f, false, true,  true,  true},
+    {"flame with smoke",    1, 1, 3.0f, 0, 70.0f, 1, 1, 0,  -1.0f, true,  true,  true,  true},
+    {"score far past",      0, 0, 0.0f, 1, 85.0f, 1, 1, 0,  -1.0f, true,  true,  true,  true},
+    {"pre-alarm in 45 s",   0, 0, 0.4f, 0, 15.0f, 0, 0, 1,  45.0f, false, false, false, true},
+    {"pre-alarm in 20 s",   0, 0, 0.8f, 0, 15.0f, 0, 0, 1,  20.0f, false, true,  false, true},
+};
+
+static void setSituation(const Situation& s) {
+    inputs[RULE_IN_FLAME] = s.flame;
+    inputs[RULE_IN_FLAME_STATE] = s.flame ? 3.0f : 0.0f;
+    inputs[RULE_IN_SMOKE_HIGH] = s.smokeHigh;
+    inputs[RULE_IN_SMOKE_SLOPE] = s.smokeSlope;
+    inputs[RULE_IN_TEMP_HIGH] = s.tempHigh;
+    inputs[RULE_IN_SCORE] = s.score;
+    inputs[RULE_IN_SCORE_WASPADA] = s.scoreWaspada;
+    inputs[RULE_IN_SCORE_BAHAYA] = s.scoreBahaya;
+    inputs[RULE_IN_PREALARM] = s.prealarm;
+    inputs[RULE_IN_PREALARM_ETA] = s.prealarmEta;
+}
+
+static void checkRules(const uint8_t* data, size_t length, bool kitchen) {
+    loadImage(data, length);
+    for (unsigned i = 0; i < sizeof(SITUATIONS) / sizeof(SITUATIONS[0]); i++) {
+        const Situation& s = SITUATIONS[i];
+        setSituation(s);
+        char message[64];
+        snprintf(message, sizeof(message), "%s rules, %s", kitchen ? "kitchen" : "default", s.name);
+        TEST_ASSERT_EQUAL_MESSAGE(kitchen ? s.kitchenBahaya : s.defaultBahaya,
+                                  program.isTrue(RULE_OUT_BAHAYA, inputs), message);
+        TEST_ASSERT_EQUAL_MESSAGE(kitchen ? s.kitchenWaspada : s.defaultWaspada,
+                                  program.isTrue(RULE_OUT_WASPADA, inputs), message);
+    }
+}
+
+void test_default_rules() {
+    checkRules(DEFAULT_IMAGE, sizeof(DEFAULT_IMAGE), false);
+}
+
+void test_kitchen_rules() {
+    checkRules(KITCHEN_IMAGE, sizeof(KITCHEN_IMAGE), true);
+
+    // Boundaries of the constants: score >= 80, eta < 30, slope > 1
+    setSituation(SITUATIONS[0]);
+    inputs[RULE_IN_SCORE] = 80.0f;
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, program.evaluate(RULE_OUT_BAHAYA, inputs));
+    inputs[RULE_IN_SCORE] = 79.9f;
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, program.evaluate(RULE_OUT_BAHAYA, inputs));
+    inputs[RULE_IN_PREALARM] = 1.0f;
+    inputs[RULE_IN_PREALARM_ETA] = 30.0f;
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, program.evaluate(RULE_OUT_WASPADA, inputs));
+    inputs[RULE_IN_PREALARM] = 0.0f;
+    inputs[RULE_IN_SMOKE_HIGH] = 1.0f;
+    inputs[RULE_IN_SMOKE_SLOPE] = 1.0f;
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, program.evaluate(RULE_OUT_WASPADA, inputs));
+}
+
+void test_arithmetic() {
+    // (smoke - smoke_background) / 0 + abs(-temp), select on flame
+    const uint8_t code[] = {
+        RULE_OP_INPUT, RULE_IN_FLAME,
+        RULE_OP_INPUT, RULE_IN_SMOKE, RULE_OP_INPUT, RULE_IN_SMOKE_BACKGROUND, RULE_OP_SUB,
+        RULE_OP_CONST, 0x00, 0x00, 0x00, 0x00, RULE_OP_DIV,
+        RULE_OP_INPUT, RULE_IN_TEMP, RULE_OP_NEG, RULE_OP_ABS, RULE_OP_ADD,
+        RULE_OP_INPUT, RULE_IN_TEMP,
+        RULE_OP_SELECT
+    };
+    size_t n = seal(build(TRUE_CODE, sizeof(TRUE_CODE), code, sizeof(code)));
+    loadImage(image, n);
+    inputs[RULE_IN_SMOKE] = 120.0f;
+    inputs[RULE_IN_SMOKE_BACKGROUND] = 20.0f;
+    inputs[RULE_IN_TEMP] = 31.5f;
+    TEST_ASSERT_EQUAL_FLOAT(31.5f, program.evaluate(RULE_OUT_WASPADA, inputs));
+    inputs[RULE_IN_FLAME] = 1.0f;
+    TEST_ASSERT_EQUAL_FLOAT(31.5f, program.evaluate(RULE_OUT_WASPADA, inputs));     // x / 0 = 0
+
+    program.clear();
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, program.evaluate(RULE_OUT_WASPADA, inputs));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_valid_image_loads);
+    RUN_TEST(test_rejects_header);
+    RUN_TEST(test_rejects_checksum);
+    RUN_TEST(test_rejects_section_lengths);
+    RUN_TEST(test_rejects_code);
+    RUN_TEST(test_failed_load_keeps_program);
+    RUN_TEST(test_default_rules);
+    RUN_TEST(test_kitchen_rules);
+    RUN_TEST(test_arithmetic);
+    return UNITY_END();
+}
@@ -0,0 +1,167 @@
+#include <unity.h>
+#include "SampleRing.h"
+
+// ============================================================================
+// SampleRing on the host, fed the way AdcSampler's drain task feeds it: a
+// mock ADC scans NUM_SLOTS channels round-robin, packs each conversion as a
+// TYPE1 result (12-bit data, 4-bit channel) into DMA-sized frames, and the
+// drain loop sorts the frame into one ring per slot.
+// ============================================================================
+
+#define NUM_SLOTS       6
+#define RING_CAPACITY   256
+#define FRAME_BYTES     256
+
+typedef SampleRing<uint16_t, RING_CAPACITY> Ring;
+
+struct MockAdcFeeder {
+    uint8_t channels[NUM_SLOTS];    // ADC1 channel of each slot, like the scan pattern
+    uint32_t conversions;           // Conversions produced so far
+
+    // Code of the n-th conversion of a slot: distinct per slot, wraps in 12 bits
+    static uint16_t code(uint8_t slot, uint32_t n) {
+        return (uint16_t)((slot * 613 + n) & 0x0FFF);
+    }
+
+    // Fill one frame, returns its length in bytes
+    uint32_t fill(uint8_t* frame) {
+        uint32_t length = 0;
+        for (; length + 2 <= FRAME_BYTES; length += 2, conversions++) {
+            uint8_t slot = conversions % NUM_SLOTS;
+            uint16_t word = code(slot, conversions / NUM_SLOTS) | (channels[slot] << 12);
+            frame[length] = word & 0xFF;
+            frame[length + 1] = word >> 8;
+        }
+        return length;
+    }
+};
+
+// Same demultiplexing as AdcSampler::drainTask()
+static void drain(const uint8_t* frame, uint32_t length, const uint8_t* channelToSlot, Ring* rings) {
+    for (uint32_t i = 0; i + 2 <= length; i += 2) {
+        uint16_t word = frame[i] | (frame[i + 1] << 8);
+        uint8_t slot = channelToSlot[word >> 12];
+        if (slot < NUM_SLOTS) rings[slot].push(word & 0x0FFF);
+    }
+}
+
+static Ring rings[NUM_SLOTS];
+static MockAdcFeeder feeder;
+static uint8_t channelToSlot[16];
+
+static void feedFrames(int frames) {
+    uint8_t frame[FRAME_BYTES];
+    for (int f = 0; f < frames; f++) {
+        uint32_t length = feeder.fill(frame);
+        drain(frame, length, channelToSlot, rings);
+    }
+}
+
+void setUp() {
+    // GPIO 32/33/36/39/35/34 are ADC1 channels 4/5/0/3/7/6
+    static const uint8_t scan[NUM_SLOTS] = {4, 5, 0, 3, 7, 6};
+    for (int i = 0; i < 16; i++) channelToSlot[i] = 0xFF;
+    for (uint8_t slot = 0; slot < NUM_SLOTS; slot++) {
+        feeder.channels[slot] = scan[slot];
+        channelToSlot[scan[slot]] = slot;
+        rings[slot].clear();
+    }
+    feeder.conversions = 0;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_empty_ring() {
+    uint32_t sum = 123;
+    uint16_t out[4];
+    TEST_ASSERT_EQUAL_UINT16(0, rings[0].size());
+    TEST_ASSERT_EQUAL_UINT16(0, rings[0].newest());
+    TEST_ASSERT_EQUAL_UINT16(0, rings[0].sumNewest(32, sum));
+    TEST_ASSERT_EQUAL_UINT32(0, sum);
+    TEST_ASSERT_EQUAL_UINT16(0, rings[0].copyNewest(4, out));
+}
+
+void test_partial_reads_before_full() {
+    feedFrames(1);                              // 128 conversions = 21 or 22 per slot
+    uint16_t held = rings[1].size();
+    TEST_ASSERT_EQUAL_UINT16(128 / NUM_SLOTS + (1 < 128 % NUM_SLOTS), held);
+    TEST_ASSERT_EQUAL_UINT32(held, rings[1].written());
+
+    // Asking for more than is held returns only what is there, oldest first
+    uint16_t out[64];
+    TEST_ASSERT_EQUAL_UINT16(held, rings[1].copyNewest(64, out));
+    for (uint16_t i = 0; i < held; i++) {
+        TEST_ASSERT_EQUAL_UINT16(MockAdcFeeder::code(1, i), out[i]);
+    }
+
+    uint32_t sum, expected = 0;
+    for (uint16_t i = 0; i < held; i++) expected += MockAdcFeeder::code(1, i);
+    TEST_ASSERT_EQUAL_UINT16(held, rings[1].sumNewest(200, sum));
+    TEST_ASSERT_EQUAL_UINT32(expected, sum);
+}
+
+void test_wrap_keeps_newest_window() {
+    feedFrames(15);                             // 1920 conversions = 320 per slot, one wrap
+    for (uint8_t slot = 0; slot < NUM_SLOTS; slot++) {
+        uint32_t written = rings[slot].written();
+        TEST_ASSERT_EQUAL_UINT32(320, written);
+        TEST_ASSERT_EQUAL_UINT16(RING_CAPACITY, rings[slot].size());
+        TEST_ASSERT_EQUAL_UINT16(MockAdcFeeder::code(slot, written - 1), rings[slot].newest());
+
+        // A window that straddles the physical end of the buffer
+        uint16_t out[100];
+        TEST_ASSERT_EQUAL_UINT16(100, rings[slot].copyNewest(100, out));
+        for (uint16_t i = 0; i < 100; i++) {
+            TEST_ASSERT_EQUAL_UINT16(MockAdcFeeder::code(slot, written - 100 + i), out[i]);
+        }
+    }
+}
+
+void test_many_laps() {
+    feedFrames(1000);                           // 128000 conversions, ~83 laps per slot
+    uint16_t out[RING_CAPACITY];
+    for (uint8_t slot = 0; slot < NUM_SLOTS; slot++) {
+        uint32_t written = rings[slot].written();
+        TEST_ASSERT_GREATER_THAN(50 * RING_CAPACITY, written);
+
+        // The whole ring is exactly the last Capacity conversions of this slot
+        TEST_ASSERT_EQUAL_UINT16(RING_CAPACITY, rings[slot].copyNewest(RING_CAPACITY + 10, out));
+        for (uint16_t i = 0; i < RING_CAPACITY; i++) {
+            TEST_ASSERT_EQUAL_UINT16(MockAdcFeeder::code(slot, written - RING_CAPACITY + i), out[i]);
+        }
+
+        uint32_t sum, expected = 0;
+        for (uint16_t i = 1; i <= 32; i++) expected += MockAdcFeeder::code(slot, written - i);
+        TEST_ASSERT_EQUAL_UINT16(32, rings[slot].sumNewest(32, sum));
+        TEST_ASSERT_EQUAL_UINT32(expected, sum);
+    }
+}
+
+void test_unscanned_channel_is_dropped() {
+    uint8_t frame[4] = {0x34, 0x12, 0x00, 0x20};     // Channels 1 and 2 are not scanned
+    drain(frame, sizeof(frame), channelToSlot, rings);
+    for (uint8_t slot = 0; slot < NUM_SLOTS; slot++) {
+        TEST_ASSERT_EQUAL_UINT32(0, rings[slot].written());
+    }
+}
+
+void test_clear_restarts() {
+    feedFrames(3);
+    rings[2].clear();
+    TEST_ASSERT_EQUAL_UINT16(0, rings[2].size());
+    rings[2].push(77);
+    TEST_ASSERT_EQUAL_UINT16(1, rings[2].size());
+    TEST_ASSERT_EQUAL_UINT16(77, rings[2].newest());
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_ring);
+    RUN_TEST(test_partial_reads_before_full);
+    RUN_TEST(test_wrap_keeps_newest_window);
+    RUN_TEST(test_many_laps);
+    RUN_TEST(test_unscanned_channel_is_dropped);
+    RUN_TEST(test_clear_restarts);
+    return UNITY_END();
+}
@@ -0,0 +1,177 @@
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <float.h>
+#include "TrendHistory.h"
+
+// ============================================================================
+// TrendHistory: the O(1) sums against a brute-force fit of the ring after
+// 2M pushes (about 12 days of smoke samples), and secondsToReach() on flat
+// noise, a ramp and a value already past the threshold.
+// ============================================================================
+
+#define TEST_SAMPLES        64          // TREND_HISTORY_SAMPLES
+#define TEST_PERIOD_S       0.5f        // TREND_SAMPLE_MS
+#define TEST_LONG_PUSHES    2000000L
+#define TEST_DHT_PERIOD_S   2.0f        // SENSOR_DHT_PERIOD_MS
+#define TEST_TEMP_LIMIT     36.0f       // THRESHOLD_TEMP
+#define TEST_HORIZON_S      60.0f       // PREALARM_HORIZON_S
+
+typedef TrendHistory<TEST_SAMPLES> History;
+
+static uint32_t rngState;
+
+static uint32_t nextRandom() {
+    rngState = rngState * 1664525u + 1013904223u;
+    return rngState >> 8;
+}
+
+static float uniform(float lo, float hi) {
+    return lo + (hi - lo) * (nextRandom() & 0xFFFF) / 65535.0f;
+}
+
+// Near-Gaussian, unit sigma
+static float noise() {
+    float sum = 0.0f;
+    for (int k = 0; k < 4; k++) sum += uniform(-1.0f, 1.0f);
+    return sum * 0.866f;
+}
+
+// Slope (per second) of a fresh least-squares fit of the last n samples
+static double bruteForceSlope(const float* last, int n) {
+    double meanX = (n - 1) / 2.0, meanY = 0.0;
+    for (int i = 0; i < n; i++) meanY += last[i];
+    meanY /= n;
+    double sxy = 0.0, sxx = 0.0;
+    for (int i = 0; i < n; i++) {
+        sxy += (i - meanX) * (last[i] - meanY);
+        sxx += (i - meanX) * (i - meanX);
+    }
+    return sxy / sxx / TEST_PERIOD_S;
+}
+
+void setUp() {
+    rngState = 12345;
+}
+
+void tearDown() {}
+
+// ----------------------------------------------------------------------------
+void test_empty_and_warmup() {
+    History h(TEST_PERIOD_S);
+    TEST_ASSERT_FALSE(h.ready());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, h.newest());
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, h.secondsToReach(50.0f));
+    for (int i = 0; i < TREND_MIN_SAMPLES - 1; i++) h.push(100.0f + i);
+    TEST_ASSERT_FALSE(h.ready());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, h.slope());
+    h.push(100.0f + TREND_MIN_SAMPLES - 1);
+    TEST_ASSERT_TRUE(h.ready());
+    TEST_ASSERT_FLOAT_WITHIN(1e-4f, 1.0f / TEST_PERIOD_S, h.slope());
+}
+
+void test_long_run_matches_brute_force() {
+    // Smoke-like signal: a background with noise, slow drift and fire-like
+    // ramps now and then, so the sums see large values come and go
+    History h(TEST_PERIOD_S);
+    float last[TEST_SAMPLES];
+    double maxError = 0.0;
+    for (long i = 0; i < TEST_LONG_PUSHES; i++) {
+        float ramp = ((i / 5000) % 7 == 3) ? (i % 5000) * 0.2f : 0.0f;
+        float y = 300.0f + 50.0f * sinf(i * 1e-5f) + ramp + 5.0f * noise();
+        h.push(y);
+        for (int k = 0; k + 1 < TEST_SAMPLES; k++) last[k] = last[k + 1];
+        last[TEST_SAMPLES - 1] = y;
+
+        if (i >= TEST_SAMPLES && i % 1000 == 0) {
+            // slope() is a float: compare in units of its rounding
+            double exact = bruteForceSlope(last, TEST_SAMPLES);
+            double error = fabs(h.slope() - exact) / (fabs(exact) * FLT_EPSILON + 1e-12);
+            if (error > maxError) maxError = error;
+        }
+    }
+    char summary[96];
+    snprintf(summary, sizeof(summary), "max slope error %.2f float ulps", maxError);
+    TEST_MESSAGE(summary);
+    // Nothing beyond the rounding of the float result
+    TEST_ASSERT_TRUE(maxError <= 1.0);
+}
+
+// ----------------------------------------------------------------------------
+void test_flat_noise_predicts_nothing() {
+    // Smoke background 300 +/- 5 PPM: no crossing of 400 PPM within the
+    // horizon on any of 100k windows
+    History h(TEST_PERIOD_S);
+    long predicted = 0, rising = 0;
+    for (long i = 0; i < 100000L; i++) {
+        h.push(300.0f + 5.0f * noise());
+        if (!h.ready()) continue;
+        float eta = h.secondsToReach(400.0f);
+        if (eta >= 0.0f && eta <= TEST_HORIZON_S) predicted++;
+        if (h.rising()) rising++;
+    }
+    char summary[80];
+    snprintf(summary, sizeof(summary), "rising() on %ld of 100000 windows", rising);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_EQUAL(0, predicted);
+    TEST_ASSERT_LESS_THAN(1000, rising);
+}
+
+void test_ramp_eta() {
+    // 0.2 C/s from 25 C, sampled at the DHT22 rate with 0.1 C resolution
+    History h(TEST_DHT_PERIOD_S);
+    float worst = 0.0f;
+    for (int i = 0; i < 40; i++) {
+        float t = i * TEST_DHT_PERIOD_S;
+        float y = 25.0f + 0.2f * t;
+        h.push(roundf(y * 10.0f) / 10.0f);
+        if (!h.ready() || y >= TEST_TEMP_LIMIT) continue;
+        float eta = h.secondsToReach(TEST_TEMP_LIMIT);
+        float expected = (TEST_TEMP_LIMIT - y) / 0.2f;
+        TEST_ASSERT_TRUE(eta > 0.0f);
+        if (fabsf(eta - expected) > worst) worst = fabsf(eta - expected);
+    }
+    char summary[64];
+    snprintf(summary, sizeof(summary), "worst ETA error %.3f s", worst);
+    TEST_MESSAGE(summary);
+    TEST_ASSERT_FLOAT_WITHIN(0.01f, 0.2f, h.slope());
+    TEST_ASSERT_TRUE(worst < 0.5f);
+}
+
+void test_noisy_ramp_eta() {
+    // Same ramp with +/- 0.3 C of sensor noise: still predicted, within a few seconds
+    History h(TEST_DHT_PERIOD_S);
+    for (int i = 0; i < 24; i++) h.push(25.0f + 0.2f * i * TEST_DHT_PERIOD_S + 0.3f * noise());
+    float now = 25.0f + 0.2f * 23 * TEST_DHT_PERIOD_S;
+    float eta = h.secondsToReach(TEST_TEMP_LIMIT);
+    TEST_ASSERT_TRUE(h.rising());
+    TEST_ASSERT_FLOAT_WITHIN(3.0f, (TEST_TEMP_LIMIT - now) / 0.2f, eta);
+}
+
+void test_already_past_threshold() {
+    History h(TEST_DHT_PERIOD_S);
+    for (int i = 0; i < 20; i++) h.push(40.0f);
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, h.secondsToReach(TEST_TEMP_LIMIT));
+
+    // Past it and cooling: still 0, not "no crossing"
+    h.reset();
+    for (int i = 0; i < 20; i++) h.push(50.0f - 0.5f * i);
+    TEST_ASSERT_FALSE(h.rising());
+    TEST_ASSERT_EQUAL_FLOAT(0.0f, h.secondsToReach(TEST_TEMP_LIMIT));
+
+    // Below it and cooling: no crossing
+    h.reset();
+    for (int i = 0; i < 20; i++) h.push(30.0f - 0.5f * i);
+    TEST_ASSERT_EQUAL_FLOAT(-1.0f, h.secondsToReach(TEST_TEMP_LIMIT));
+}
+
+int main() {
+    UNITY_BEGIN();
+    RUN_TEST(test_empty_and_warmup);
+    RUN_TEST(test_long_run_matches_brute_force);
+    RUN_TEST(test_flat_noise_predicts_nothing);
+    RUN_TEST(test_ramp_eta);
+    RUN_TEST(test_noisy_ramp_eta);
+    RUN_TEST(test_already_past_threshold);
+    return UNITY_END();
+}
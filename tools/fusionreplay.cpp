@@ -0,0 +1,151 @@
+// Host replay of recorded fusion traces: feeds the [FTRACE] lines of a
+// serial log (firmware built with FUSION_TRACE 1) through FireFusion and the
+// legacy rule (include/FusionScore.h), and prints time-to-alarm per episode.
+// Weights can be changed to try a tuning on the same recordings.
+//   g++ -O2 -Iinclude tools/fusionreplay.cpp src/FusionScore.cpp -o fusionreplay
+//   ./fusionreplay [-w flame=60 -w smoke=40 ...] log...
+// The legacy level is recomputed from the logged smoke threshold and
+// THRESHOLD_TEMP, so it matches loop() as long as those did not change.
+// Scoring and episode timing are covered by test/test_fire_fusion.
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "FusionScore.h"
+
+struct ReplayTotals {
+    uint32_t updates;
+    uint32_t levelMismatches;       // Replayed level != logged level
+    float maxScoreError;            // |replayed - logged score|
+    uint32_t episodes;
+    long leadMs[2];                 // Sum of (legacy - fusion) first Waspada / Bahaya
+    uint32_t leadCount[2];
+};
+
+static void printTimes(const FusionEpisode& e) {
+    static const char* const ruleNames[] = {"fusion", "legacy"};
+    for (int rule = 0; rule < 2; rule++) {
+        printf("    %-6s  Waspada ", ruleNames[rule]);
+        if (e.firstMs[rule][0] < 0) printf("   never"); else printf("%+6ld ms", e.firstMs[rule][0]);
+        printf("  Bahaya ");
+        if (e.firstMs[rule][1] < 0) printf("   never\n"); else printf("%+6ld ms\n", e.firstMs[rule][1]);
+    }
+}
+
+static void closeEpisode(const FusionEpisode& e, ReplayTotals& totals, bool atEnd) {
+    totals.episodes++;
+    printf("  episode at %lu ms, %lu ms long%s:\n", e.startMs, e.durationMs(), atEnd ? " (open at end of log)" : "");
+    printTimes(e);
+    for (int i = 0; i < 2; i++) {
+        if (e.firstMs[FUSION_RULE_SCORE][i] >= 0 && e.firstMs[FUSION_RULE_LEGACY][i] >= 0) {
+            totals.leadMs[i] += e.firstMs[FUSION_RULE_LEGACY][i] - e.firstMs[FUSION_RULE_SCORE][i];
+            totals.leadCount[i]++;
+        }
+    }
+}
+
+static bool replayFile(const char* path, const float* weights, ReplayTotals& totals) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "%s: cannot open\n", path);
+        return false;
+    }
+    printf("%s\n", path);
+
+    FireFusion fusion;
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) fusion.setWeight((FusionEvidence)i, weights[i]);
+    FusionEpisodeTracker episodes;
+    bool first = true;
+    unsigned long lastMs = 0;
+
+    char line[512];
+    while (fgets(line, sizeof(line), f)) {
+        const char* trace = strstr(line, "[FTRACE]");
+        if (!trace) continue;
+
+        unsigned long ms;
+        int flameState, confidence, nuisance, loggedFused, loggedLegacy;
+        float instant, loggedScore;
+        FusionInput input;
+        int fields = sscanf(trace + 8, " %lu,%d,%d,%f,%f,%f,%f,%f,%f,%f,%f,%d,%f,%f,%d,%d",
+                            &ms, &flameState, &confidence, &input.smokePPM, &input.smokeBackground,
+                            &input.smokeThreshold, &input.smokeSlope, &input.temperature,
+                            &input.temperatureSlope, &input.irShiftLevel, &input.smokeShiftLevel,
+                            &nuisance, &instant, &loggedScore, &loggedFused, &loggedLegacy);
+        if (fields != 16) continue;         // Older trace format or a garbled line
+        input.flameState = (FlameDetectionState)flameState;
+        input.flameConfidence = (uint8_t)confidence;
+        input.modelNuisance = (uint8_t)nuisance;
+
+        // Same dt as evaluateFireFusion(): 0 on the first update
+        float dt = first ? 0.0f : (ms - lastMs) / 1000.0f;
+        first = false;
+        lastMs = ms;
+
+        FireLevel fused = fusion.update(input, dt);
+        FireLevel legacy = legacyFireLevel(input.flameState == FLAME_DETECTED,
+                                           input.smokePPM > input.smokeThreshold,
+                                           input.temperature > THRESHOLD_TEMP);
+
+        totals.updates++;
+        if (fused != loggedFused) totals.levelMismatches++;
+        float error = fabsf(fusion.getScore() - loggedScore);
+        if (error > totals.maxScoreError) totals.maxScoreError = error;
+
+        if (episodes.update(fused, legacy, ms) == FUSION_EPISODE_CLOSED) {
+            closeEpisode(episodes.last(), totals, false);
+        }
+    }
+    fclose(f);
+
+    if (episodes.current().open) closeEpisode(episodes.current(), totals, true);
+    return true;
+}
+
+static int evidenceByName(const char* name) {
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) {
+        if (strcmp(name, FireFusion::evidenceName((FusionEvidence)i)) == 0) return i;
+    }
+    return -1;
+}
+
+int main(int argc, char** argv) {
+    FireFusion defaults;
+    float weights[FUSION_NUM_EVIDENCE];
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) weights[i] = defaults.getWeight((FusionEvidence)i);
+
+    ReplayTotals totals = {};
+    int files = 0;
+    for (int a = 1; a < argc; a++) {
+        if (strcmp(argv[a], "-w") == 0 && a + 1 < argc) {
+            char name[32];
+            float points;
+            int which = -1;
+            if (sscanf(argv[++a], "%31[^=]=%f", name, &points) == 2) which = evidenceByName(name);
+            if (which < 0) {
+                fprintf(stderr, "bad weight \"%s\" (name=points, names as in the \"fusion\" command)\n", argv[a]);
+                return 1;
+            }
+            weights[which] = points;
+            continue;
+        }
+        if (replayFile(argv[a], weights, totals)) files++;
+    }
+    if (files == 0) {
+        fprintf(stderr, "usage: %s [-w name=points ...] log...\n", argv[0]);
+        return 1;
+    }
+
+    printf("weights:");
+    for (int i = 0; i < FUSION_NUM_EVIDENCE; i++) printf(" %s=%.0f", FireFusion::evidenceName((FusionEvidence)i), weights[i]);
+    printf("\n%lu updates, %lu episodes\n", (unsigned long)totals.updates, (unsigned long)totals.episodes);
+    static const char* const levelNames[] = {"Waspada", "Bahaya"};
+    for (int i = 0; i < 2; i++) {
+        if (totals.leadCount[i] == 0) continue;
+        printf("fusion ahead of legacy to %s by %.0f ms on average (%lu episodes)\n", levelNames[i],
+               (double)totals.leadMs[i] / totals.leadCount[i], (unsigned long)totals.leadCount[i]);
+    }
+    printf("replay vs log: max score difference %.2f, %lu level mismatches%s\n", totals.maxScoreError,
+           (unsigned long)totals.levelMismatches, (totals.levelMismatches > 0) ? " (a few at thresholds come from the rounded log)" : "");
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Host benchmark of the integer baseline pipeline (include/IRFixedPoint.h)
+// against the float EMA in IRFlameSensor::updateBaselines().
+//   g++ -O2 -Iinclude tools/irfixedbench.cpp -o irfixedbench
+//   ./irfixedbench [updates]
+// Host timings only show the relative cost; on the ESP32 the float path runs
+// on the FPU of the calling task, the integer one can run from an ISR.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "IRFixedPoint.h"
+
+#define CHANNELS        5
+#define EMA_ALPHA       0.01f       // As in IRFlameSensor.h
+
+int main(int argc, char** argv) {
+    long updates = (argc > 1) ? atol(argv[1]) : 10000000L;
+
+    // Raw readings that change every update so nothing is hoisted
+    static uint16_t raw[1024][CHANNELS];
+    uint32_t seed = 1;
+    for (int t = 0; t < 1024; t++) {
+        for (int i = 0; i < CHANNELS; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            raw[t][i] = 1200 + (seed >> 24);
+        }
+    }
+
+    float baseline[CHANNELS] = {}, deviation[CHANNELS], margin[CHANNELS];
+    int32_t baselineQ16[CHANNELS] = {}, deviationQ16[CHANNELS], marginQ16[CHANNELS];
+    for (int i = 0; i < CHANNELS; i++) {
+        margin[i] = 300.0f;
+        marginQ16[i] = irMilliVoltsToQ16(300);
+    }
+    volatile uint32_t sink = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long t = 0; t < updates; t++) {
+        const uint16_t* r = raw[t & 1023];
+        float alpha = 1.0f / ((t < 100 ? t : 100) + 1);
+        if (alpha < EMA_ALPHA) alpha = EMA_ALPHA;
+        uint32_t mask = 0;
+        for (int i = 0; i < CHANNELS; i++) {
+            baseline[i] = (alpha * r[i]) + ((1.0f - alpha) * baseline[i]);
+            deviation[i] = r[i] - baseline[i];
+            if (deviation[i] > margin[i]) mask |= (1UL << i);
+        }
+        sink = sink + mask;
+    }
+    double floatNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / updates;
+
+    start = std::chrono::steady_clock::now();
+    for (long t = 0; t < updates; t++) {
+        int32_t alphaQ24 = irWarmupAlphaQ24(t < 100 ? t : 100, IR_ALPHA_Q24(EMA_ALPHA));
+        sink = sink + irFixedUpdateChannels(raw[t & 1023], baselineQ16, deviationQ16, CHANNELS, alphaQ24, marginQ16);
+    }
+    double fixedNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / updates;
+
+    printf("%d channels, %ld updates: float %.1f ns, fixed %.1f ns per update\n", CHANNELS, updates, floatNs, fixedNs);
+    printf("final baseline ch0: float %.3f mV, fixed %.3f mV\n", baseline[0], irQ16ToMilliVolts(baselineQ16[0]));
+    return 0;
+}
@@ -0,0 +1,88 @@
+// Host benchmark of the window filters in include/MedianFilter.h: mean,
+// sorting-network median and Hampel per window of uint16_t ADC codes, with
+// std::nth_element as the library reference for the median. Prints the
+// numbers quoted in MedianFilter.h.
+//   g++ -O2 -Iinclude tools/medianbench.cpp -o medianbench
+//   ./medianbench [windows]
+// Correctness of the networks is covered by test/test_median_filter.
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "MedianFilter.h"
+
+#define POOL            1024        // Distinct windows, cycled so nothing is hoisted
+
+static uint16_t pool[POOL][64];
+
+static double nsPerWindow(std::chrono::steady_clock::time_point start, long windows) {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / windows;
+}
+
+template <int N>
+static void bench(long windows) {
+    volatile uint32_t sink = 0;
+    uint16_t v[N];
+
+    auto start = std::chrono::steady_clock::now();
+    for (long w = 0; w < windows; w++) {
+        memcpy(v, pool[w & (POOL - 1)], sizeof(v));
+        sink = sink + meanOf<uint16_t, N>(v);
+    }
+    double meanNs = nsPerWindow(start, windows);
+
+    start = std::chrono::steady_clock::now();
+    for (long w = 0; w < windows; w++) {
+        memcpy(v, pool[w & (POOL - 1)], sizeof(v));
+        sink = sink + medianOf<uint16_t, N>(v);
+    }
+    double medianNs = nsPerWindow(start, windows);
+
+    start = std::chrono::steady_clock::now();
+    for (long w = 0; w < windows; w++) {
+        memcpy(v, pool[w & (POOL - 1)], sizeof(v));
+        std::nth_element(v, v + N / 2, v + N);
+        sink = sink + v[N / 2];
+    }
+    double nthNs = nsPerWindow(start, windows);
+
+    start = std::chrono::steady_clock::now();
+    for (long w = 0; w < windows; w++) {
+        memcpy(v, pool[w & (POOL - 1)], sizeof(v));
+        sink = sink + hampelMeanOf<uint16_t, N>(v);
+    }
+    double hampelNs = nsPerWindow(start, windows);
+
+    // One full-scale glitch in a window of ~2000 counts
+    for (int i = 0; i < N; i++) v[i] = 2000 + (i % 5);
+    v[N / 3] = 4095;
+    uint16_t copy[N];
+    memcpy(copy, v, sizeof(v));
+    int meanShift = meanOf<uint16_t, N>(copy) - 2002;
+    memcpy(copy, v, sizeof(v));
+    int medianShift = medianOf<uint16_t, N>(copy) - 2002;
+    memcpy(copy, v, sizeof(v));
+    int hampelShift = hampelMeanOf<uint16_t, N>(copy) - 2002;
+
+    printf("N=%2d (%3u comparators): mean %5.1f ns, median %5.1f ns, nth_element %5.1f ns, Hampel %5.1f ns\n",
+           N, (unsigned)SortingNetwork<uint16_t, N>::comparators, meanNs, medianNs, nthNs, hampelNs);
+    printf("      glitch 4095 moves: mean %+d, median %+d, Hampel %+d counts\n", meanShift, medianShift, hampelShift);
+}
+
+int main(int argc, char** argv) {
+    long windows = (argc > 1) ? atol(argv[1]) : 2000000L;
+
+    uint32_t seed = 1;
+    for (int w = 0; w < POOL; w++) {
+        for (int i = 0; i < 64; i++) {
+            seed = seed * 1664525u + 1013904223u;
+            pool[w][i] = 1900 + ((seed >> 16) % 200);
+        }
+    }
+
+    bench<5>(windows);
+    bench<9>(windows);
+    bench<31>(windows);
+    return 0;
+}
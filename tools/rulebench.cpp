@@ -0,0 +1,63 @@
+// Host benchmark of the alarm rule VM (include/RuleVM.h).
+//   g++ -O2 -Iinclude tools/rulebench.cpp -o rulebench
+//   ./rulebench data/alarm.rules [runs]
+// Compares the bytecode against the same rule compiled natively
+// (tools/rules/default.rules); on the ESP32 use the "rules bench" console
+// command instead.
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include "RuleVM.h"
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <image> [runs]\n", argv[0]);
+        return 2;
+    }
+    FILE* f = fopen(argv[1], "rb");
+    if (!f) {
+        perror(argv[1]);
+        return 1;
+    }
+    uint8_t image[RULE_MAX_IMAGE + 1];
+    size_t length = fread(image, 1, sizeof(image), f);
+    fclose(f);
+
+    static RuleProgram program;
+    const char* error = NULL;
+    if (!program.load(image, length, &error)) {
+        fprintf(stderr, "rejected: %s\n", error);
+        return 1;
+    }
+    long runs = (argc > 2) ? atol(argv[2]) : 10000000L;
+
+    // Inputs that change every run so nothing is hoisted out of the loop
+    float inputs[RULE_NUM_INPUTS] = {};
+    volatile float sink = 0.0f;
+
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < runs; i++) {
+        inputs[RULE_IN_SCORE] = (float)(i & 127);
+        inputs[RULE_IN_SMOKE_HIGH] = (float)(i & 1);
+        sink = sink + program.evaluate(RULE_OUT_BAHAYA, inputs) + program.evaluate(RULE_OUT_WASPADA, inputs);
+    }
+    double vm = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs;
+
+    start = std::chrono::steady_clock::now();
+    for (long i = 0; i < runs; i++) {
+        inputs[RULE_IN_SCORE] = (float)(i & 127);
+        inputs[RULE_IN_SMOKE_HIGH] = (float)(i & 1);
+        volatile const float* in = inputs;
+        bool danger = in[RULE_IN_SCORE_BAHAYA] != 0.0f;
+        bool warning = in[RULE_IN_SCORE_WASPADA] != 0.0f || in[RULE_IN_PREALARM] != 0.0f;
+        sink = sink + danger + warning;
+    }
+    double native = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / runs;
+
+    uint8_t bahaya, waspada;
+    program.code(RULE_OUT_BAHAYA, bahaya);
+    program.code(RULE_OUT_WASPADA, waspada);
+    printf("%s: %zu bytes (bahaya %d, waspada %d)\n", argv[1], length, bahaya, waspada);
+    printf("bytecode %.1f ns per tick (both rules), native default rule %.1f ns\n", vm, native);
+    return 0;
+}
@@ -0,0 +1,403 @@
+#!/usr/bin/env python3
+"""Compile alarm rules into the bytecode image run by include/RuleVM.h.
+
+Source format, one rule per output (a rule may span several lines):
+
+    # kitchen: cooking smoke alone is only Waspada
+    bahaya  = flame and smoke_high or score_bahaya
+    waspada = smoke_high or temp_high or prealarm
+
+Expressions: numbers, true/false, the inputs of RuleInput (lower-case
+suffix, e.g. smoke_slope), + - * /, < <= > >= == !=, and / or / not,
+min(a, b), max(a, b), abs(a) and if(c, a, b). Constant sub-expressions are
+folded with float32 semantics, like the VM.
+
+Opcodes, inputs and limits are read from RuleVM.h, so the compiler can not
+drift from the firmware. Only the standard library is used.
+
+    rulec.py kitchen.rules -o data/alarm.rules     binary for LittleFS
+    rulec.py kitchen.rules --console               "rules begin/add/commit" lines
+    rulec.py kitchen.rules --hex                   one line for Blynk V7
+    rulec.py kitchen.rules --disasm --eval flame=1 smoke_high=1
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+
+DEFAULT_HEADER = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "include", "RuleVM.h")
+OUTPUTS = ["bahaya", "waspada"]     # Order of RuleOutput
+FUNCTIONS = {"min": ("MIN", 2), "max": ("MAX", 2), "abs": ("ABS", 1), "if": ("SELECT", 3)}
+COMPARISONS = {"<": "LT", "<=": "LE", ">": "GT", ">=": "GE", "==": "EQ", "!=": "NE"}
+
+
+class RuleError(Exception):
+    pass
+
+
+# ----------------------------------------------------------------------------
+# RuleVM.h
+# ----------------------------------------------------------------------------
+class VmSpec:
+    def __init__(self, path):
+        with open(path) as f:
+            text = f.read()
+        self.ops = self._enum(text, "RuleOp", "RULE_OP_")
+        self.inputs = [name.lower() for name in self._enum(text, "RuleInput", "RULE_IN_")]
+        self.version = self._define(text, "RULE_IMAGE_VERSION")
+        self.max_image = self._define(text, "RULE_MAX_IMAGE")
+        self.stack_depth = self._define(text, "RULE_STACK_DEPTH")
+
+    @staticmethod
+    def _enum(text, name, prefix):
+        body = re.search(r"enum\s+%s\s*\{(.*?)\}" % name, text, re.S)
+        if not body:
+            raise RuleError("enum %s not found in RuleVM.h" % name)
+        names = re.findall(r"^\s*%s(\w+)\s*," % prefix, body.group(1), re.M)
+        return [n for n in names if not n.startswith("NUM_")]
+
+    @staticmethod
+    def _define(text, name):
+        match = re.search(r"#define\s+%s\s+(\d+)" % name, text)
+        if not match:
+            raise RuleError("%s not found in RuleVM.h" % name)
+        return int(match.group(1))
+
+    def opcode(self, name):
+        return self.ops.index(name)
+
+
+# ----------------------------------------------------------------------------
+# Parser
+# ----------------------------------------------------------------------------
+TOKEN = re.compile(r"\s*(?:(\d+\.?\d*(?:[eE][-+]?\d+)?|\.\d+(?:[eE][-+]?\d+)?)|([A-Za-z_]\w*)|(<=|>=|==|!=|[-+*/<>(),]))")
+
+
+def tokenize(text):
+    tokens, pos = [], 0
+    text = text.rstrip()
+    while pos < len(text):
+        match = TOKEN.match(text, pos)
+        if not match or match.end() == pos:
+            raise RuleError("unexpected %r" % text[pos:].strip()[:10])
+        number, word, symbol = match.groups()
+        if number is not None:
+            tokens.append(("num", float(number)))
+        elif word is not None:
+            tokens.append(("word", word))
+        else:
+            tokens.append(("sym", symbol))
+        pos = match.end()
+    return tokens
+
+
+class Parser:
+    """Precedence: or < and < not < comparison < + - < * / < unary minus."""
+
+    def __init__(self, tokens, spec):
+        self.tokens = tokens
+        self.pos = 0
+        self.spec = spec
+
+    def peek(self):
+        return self.tokens[self.pos] if self.pos < len(self.tokens) else (None, None)
+
+    def take(self, kind=None, value=None):
+        token = self.peek()
+        if token[0] is None:
+            raise RuleError("unexpected end of rule")
+        if (kind and token[0] != kind) or (value is not None and token[1] != value):
+            raise RuleError("expected %s, got %s" % (value or kind, token[1]))
+        self.pos += 1
+        return token
+
+    def accept(self, kind, value):
+        if self.peek() == (kind, value):
+            self.pos += 1
+            return True
+        return False
+
+    def parse(self):
+        node = self.expr_or()
+        if self.pos != len(self.tokens):
+            raise RuleError("unexpected %s" % self.peek()[1])
+        return node
+
+    def expr_or(self):
+        node = self.expr_and()
+        while self.accept("word", "or"):
+            node = ("OR", node, self.expr_and())
+        return node
+
+    def expr_and(self):
+        node = self.expr_not()
+        while self.accept("word", "and"):
+            node = ("AND", node, self.expr_not())
+        return node
+
+    def expr_not(self):
+        if self.accept("word", "not"):
+            return ("NOT", self.expr_not())
+        return self.expr_cmp()
+
+    def expr_cmp(self):
+        node = self.expr_add()
+        kind, value = self.peek()
+        if kind == "sym" and value in COMPARISONS:
+            self.pos += 1
+            node = (COMPARISONS[value], node, self.expr_add())
+        return node
+
+    def expr_add(self):
+        node = self.expr_mul()
+        while self.peek() in (("sym", "+"), ("sym", "-")):
+            op = "ADD" if self.take()[1] == "+" else "SUB"
+            node = (op, node, self.expr_mul())
+        return node
+
+    def expr_mul(self):
+        node = self.expr_unary()
+        while self.peek() in (("sym", "*"), ("sym", "/")):
+            op = "MUL" if self.take()[1] == "*" else "DIV"
+            node = (op, node, self.expr_unary())
+        return node
+
+    def expr_unary(self):
+        if self.accept("sym", "-"):
+            return ("NEG", self.expr_unary())
+        return self.primary()
+
+    def primary(self):
+        kind, value = self.take()
+        if kind == "num":
+            return ("CONST", value)
+        if kind == "sym" and value == "(":
+            node = self.expr_or()
+            self.take("sym", ")")
+            return node
+        if kind == "word":
+            if value in ("true", "false"):
+                return ("CONST", 1.0 if value == "true" else 0.0)
+            if value in FUNCTIONS:
+                op, arity = FUNCTIONS[value]
+                self.take("sym", "(")
+                args = [self.expr_or()]
+                while self.accept("sym", ","):
+                    args.append(self.expr_or())
+                self.take("sym", ")")
+                if len(args) != arity:
+                    raise RuleError("%s() takes %d arguments" % (value, arity))
+                return (op,) + tuple(args)
+            if value in self.spec.inputs:
+                return ("INPUT", self.spec.inputs.index(value))
+            raise RuleError("unknown input %r (known: %s)" % (value, ", ".join(self.spec.inputs)))
+        raise RuleError("unexpected %s" % value)
+
+
+# ----------------------------------------------------------------------------
+# Float32 semantics shared by folding and --eval
+# ----------------------------------------------------------------------------
+def f32(x):
+    return struct.unpack("<f", struct.pack("<f", x))[0]
+
+
+def apply(op, args):
+    a = args[0] if args else 0.0
+    b = args[1] if len(args) > 1 else 0.0
+    if op == "ADD": return f32(a + b)
+    if op == "SUB": return f32(a - b)
+    if op == "MUL": return f32(a * b)
+    if op == "DIV": return f32(a / b) if b != 0.0 else 0.0
+    if op == "NEG": return -a
+    if op == "LT": return float(a < b)
+    if op == "LE": return float(a <= b)
+    if op == "GT": return float(a > b)
+    if op == "GE": return float(a >= b)
+    if op == "EQ": return float(a == b)
+    if op == "NE": return float(a != b)
+    if op == "AND": return float(a != 0.0 and b != 0.0)
+    if op == "OR": return float(a != 0.0 or b != 0.0)
+    if op == "NOT": return float(a == 0.0)
+    if op == "MIN": return b if b < a else a
+    if op == "MAX": return b if b > a else a
+    if op == "ABS": return -a if a < 0.0 else a
+    if op == "SELECT": return args[1] if a != 0.0 else args[2]
+    raise RuleError("no semantics for %s" % op)
+
+
+def fold(node):
+    if node[0] in ("CONST", "INPUT"):
+        return node
+    children = [fold(child) for child in node[1:]]
+    if all(child[0] == "CONST" for child in children):
+        return ("CONST", apply(node[0], [f32(child[1]) for child in children]))
+    return (node[0],) + tuple(children)
+
+
+# ----------------------------------------------------------------------------
+# Code generation
+# ----------------------------------------------------------------------------
+def emit(node, spec, code):
+    """Append postfix code for node; returns the stack depth it needs."""
+    op = node[0]
+    if op == "CONST":
+        code += bytes([spec.opcode("CONST")]) + struct.pack("<f", node[1])
+        return 1
+    if op == "INPUT":
+        code += bytes([spec.opcode("INPUT"), node[1]])
+        return 1
+    depth = 0
+    for i, child in enumerate(node[1:]):
+        depth = max(depth, i + emit(child, spec, code))
+    code.append(spec.opcode(op))
+    return depth
+
+
+def compile_rules(source, spec):
+    statements, current = {}, None
+    for number, raw in enumerate(source.splitlines(), 1):
+        line = raw.split("#", 1)[0].strip()
+        if not line:
+            continue
+        match = re.match(r"(\w+)\s*=(?!=)\s*(.*)$", line)
+        if match and match.group(1) in OUTPUTS:
+            current = match.group(1)
+            if current in statements:
+                raise RuleError("line %d: %s defined twice" % (number, current))
+            statements[current] = [number, match.group(2)]
+        elif current:
+            statements[current][1] += " " + line
+        else:
+            raise RuleError("line %d: expected '<%s> = expression'" % (number, "|".join(OUTPUTS)))
+
+    sections = []
+    for name in OUTPUTS:
+        if name not in statements:
+            raise RuleError("no rule for %s" % name)
+        number, text = statements[name]
+        try:
+            tree = fold(Parser(tokenize(text), spec).parse())
+        except RuleError as e:
+            raise RuleError("line %d (%s): %s" % (number, name, e))
+        code = bytearray()
+        depth = emit(tree, spec, code)
+        if depth > spec.stack_depth:
+            raise RuleError("%s needs %d stack slots, the VM has %d" % (name, depth, spec.stack_depth))
+        if len(code) > 255:
+            raise RuleError("%s compiles to %d bytes, limit 255" % (name, len(code)))
+        sections.append(bytes(code))
+
+    image = bytearray(b"AR") + bytes([spec.version, len(OUTPUTS)]) + bytes(len(s) for s in sections)
+    for section in sections:
+        image += section
+    image += struct.pack("<H", fletcher16(image))
+    if len(image) > spec.max_image:
+        raise RuleError("image is %d bytes, RULE_MAX_IMAGE is %d" % (len(image), spec.max_image))
+    return bytes(image), sections
+
+
+def fletcher16(data):
+    a = b = 0
+    for byte in data:
+        a = (a + byte) % 255
+        b = (b + a) % 255
+    return (b << 8) | a
+
+
+# ----------------------------------------------------------------------------
+# Disassembly and reference evaluation (same walk as RuleProgram::evaluate)
+# ----------------------------------------------------------------------------
+def walk(code, spec):
+    pc = 0
+    while pc < len(code):
+        op = spec.ops[code[pc]]
+        if op == "CONST":
+            yield pc, op, struct.unpack("<f", code[pc + 1:pc + 5])[0]
+            pc += 5
+        elif op == "INPUT":
+            yield pc, op, code[pc + 1]
+            pc += 2
+        else:
+            yield pc, op, None
+            pc += 1
+
+
+def disassemble(name, code, spec):
+    print("%s (%d bytes):" % (name, len(code)))
+    for pc, op, arg in walk(code, spec):
+        if op == "CONST":
+            print("  %3d  CONST %g" % (pc, arg))
+        elif op == "INPUT":
+            print("  %3d  INPUT %s" % (pc, spec.inputs[arg]))
+        else:
+            print("  %3d  %s" % (pc, op))
+
+
+def evaluate(code, spec, inputs):
+    stack = []
+    arity = {"NEG": 1, "NOT": 1, "ABS": 1, "SELECT": 3}
+    for _, op, arg in walk(code, spec):
+        if op == "CONST":
+            stack.append(f32(arg))
+        elif op == "INPUT":
+            stack.append(f32(inputs[arg]))
+        else:
+            n = arity.get(op, 2)
+            args = stack[-n:]
+            del stack[-n:]
+            stack.append(apply(op, args))
+    return stack[0]
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compile alarm rules for the RuleVM bytecode engine")
+    parser.add_argument("source", help="rules file")
+    parser.add_argument("-o", "--output", help="write the binary image (e.g. data/alarm.rules)")
+    parser.add_argument("--hex", action="store_true", help="print the image as one hex line (Blynk V7)")
+    parser.add_argument("--console", action="store_true", help="print 'rules begin/add/commit' console lines")
+    parser.add_argument("--chunk", type=int, default=48, help="hex digits per console line (default 48)")
+    parser.add_argument("--disasm", action="store_true", help="print the bytecode")
+    parser.add_argument("--eval", nargs="*", metavar="INPUT=VALUE", help="evaluate both rules (unset inputs = 0)")
+    parser.add_argument("--header", default=DEFAULT_HEADER, help="path to RuleVM.h")
+    args = parser.parse_args()
+
+    try:
+        spec = VmSpec(args.header)
+        with open(args.source) as f:
+            image, sections = compile_rules(f.read(), spec)
+
+        inputs = [0.0] * len(spec.inputs)
+        for item in args.eval or []:
+            name, _, value = item.partition("=")
+            if name not in spec.inputs:
+                raise RuleError("unknown input %r" % name)
+            inputs[spec.inputs.index(name)] = float(value)
+    except (RuleError, OSError, ValueError) as e:
+        sys.exit("rulec: %s" % e)
+
+    if args.output:
+        with open(args.output, "wb") as f:
+            f.write(image)
+    sys.stderr.write("%s: %d bytes (%s)\n" % (args.source, len(image),
+                     ", ".join("%s %d" % (n, len(s)) for n, s in zip(OUTPUTS, sections))))
+
+    if args.disasm:
+        for name, code in zip(OUTPUTS, sections):
+            disassemble(name, code, spec)
+    if args.eval is not None:
+        for name, code in zip(OUTPUTS, sections):
+            print("%s = %g" % (name, evaluate(code, spec, inputs)))
+    if args.hex:
+        print(image.hex())
+    if args.console:
+        text = image.hex()
+        print("rules begin")
+        for i in range(0, len(text), max(2, args.chunk - args.chunk % 2)):
+            print("rules add %s" % text[i:i + args.chunk - args.chunk % 2])
+        print("rules commit")
+
+
+if __name__ == "__main__":
+    main()
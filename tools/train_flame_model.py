@@ -0,0 +1,367 @@
+#!/usr/bin/env python3
+"""Train the int8 flame / nuisance classifier and export its weights.
+
+The firmware prints one feature vector per IR update while "model trace on"
+is active on the Edgent console:
+
+    [MLTRACE] <ms>,<f0>,...,<f11>
+
+Record one log per situation (real flame, curtain in sunlight, halogen lamp,
+quiet room, ...) and name its class on the command line:
+
+    train_flame_model.py flame=fire1.log flame=candle.log \\
+        nuisance=curtain.log nuisance=halogen.log quiet=room.log \\
+        -o include/FlameModelWeights.h
+
+--synthetic N adds N generated vectors per class (see synthesize()), which
+is how the shipped placeholder weights were produced; retrain on recorded
+traces before letting the model veto anything.
+
+The header also gets --golden N validation vectors per class with the class
+and probabilities computed here; test/test_flame_model checks that
+FlameModel::infer() reproduces them.
+
+The network is FLAME_MODEL_INPUTS -> HIDDEN (ReLU) -> 3 classes, trained in
+float with Adam and softmax cross-entropy, then quantized to int8 weights,
+int32 biases and a fixed-point requantization of the hidden layer. The int8
+model is evaluated here with exactly the integer arithmetic of
+include/FlameModel.h, so the reported int8 accuracy is what the device
+gets. Pure Python, standard library only.
+"""
+
+import argparse
+import math
+import random
+import sys
+
+FEATURES = [
+    "dev_best", "dev_second", "dev_mean", "spike_fraction", "point", "wide",
+    "persistence", "flicker_ratio", "flicker_level", "swing", "smoke", "temp",
+]
+CLASSES = ["quiet", "flame", "nuisance"]      # Order of FlameClass
+INPUT_SHIFT = 5                               # Feature x 2^5 -> int8, range -4..+3.97
+
+
+# ----------------------------------------------------------------------------
+# Data
+# ----------------------------------------------------------------------------
+def load_trace(path):
+    vectors = []
+    with open(path, errors="replace") as f:
+        for line in f:
+            if "[MLTRACE]" not in line:
+                continue
+            fields = line.split("[MLTRACE]", 1)[1].strip().split(",")
+            if len(fields) != len(FEATURES) + 1:
+                continue
+            try:
+                vectors.append([float(v) for v in fields[1:]])
+            except ValueError:
+                continue
+    return vectors
+
+
+def synthesize(label, count, rng):
+    """Rough generative model of each class, for bootstrapping only."""
+    u = rng.uniform
+    out = []
+    for _ in range(count):
+        if label == "quiet":
+            best = abs(rng.gauss(0.2, 0.2))
+            v = [best, best * u(0.2, 1.0), rng.gauss(0.0, 0.1), 0.2 if best > 1 else 0.0, 0.0, 0.0,
+                 u(0.0, 0.1), u(0.0, 0.6), u(0.0, 0.6), u(0.0, 0.6), u(0.0, 0.8), u(-0.8, 0.6)]
+        elif label == "flame":
+            best = u(0.7, 4.0)
+            spikes = rng.choice([1, 1, 1, 2, 2, 3])
+            v = [best, best * u(0.1, 0.9), best * u(0.15, 0.45), spikes / 5.0, 1.0 if spikes < 3 else 0.0, 0.0,
+                 u(0.4, 1.0), u(0.3, 1.0), u(0.4, 4.0), u(0.5, 3.5), u(0.0, 3.0), u(-0.5, 2.5)]
+        elif rng.random() < 0.5:    # Sunlight through a moving curtain: broad, slow swings
+            best = u(0.7, 3.5)
+            spikes = rng.choice([2, 3, 3, 4, 5])
+            v = [best, best * u(0.6, 1.0), best * u(0.4, 0.9), spikes / 5.0, 1.0 if spikes == 2 else 0.0,
+                 1.0 if spikes >= 3 else 0.0, u(0.2, 0.9), u(0.0, 0.6), u(0.0, 1.5), u(0.8, 4.0),
+                 u(0.0, 0.8), u(-0.5, 1.0)]
+        else:                       # Halogen lamp: a steady point source
+            best = u(0.8, 4.0)
+            v = [best, best * u(0.05, 0.5), best * u(0.1, 0.35), rng.choice([1, 1, 2]) / 5.0, 1.0, 0.0,
+                 u(0.8, 1.0), u(0.0, 0.45), u(0.0, 0.9), u(0.0, 0.8), u(0.0, 0.8), u(-0.5, 1.2)]
+        out.append(v)
+    return out
+
+
+def quantize_input(x):
+    scaled = x * (1 << INPUT_SHIFT)                 # lroundf(): halves away from zero
+    return max(-128, min(127, int(math.copysign(math.floor(abs(scaled) + 0.5), scaled))))
+
+
+# ----------------------------------------------------------------------------
+# Float model
+# ----------------------------------------------------------------------------
+class Mlp:
+    def __init__(self, inputs, hidden, classes, rng):
+        def layer(n_out, n_in):
+            bound = math.sqrt(6.0 / (n_in + n_out))
+            return [[rng.uniform(-bound, bound) for _ in range(n_in)] for _ in range(n_out)]
+        self.w1, self.b1 = layer(hidden, inputs), [0.0] * hidden
+        self.w2, self.b2 = layer(classes, hidden), [0.0] * classes
+
+    def forward(self, x):
+        h = [max(0.0, sum(w * xi for w, xi in zip(row, x)) + b) for row, b in zip(self.w1, self.b1)]
+        z = [sum(w * hi for w, hi in zip(row, h)) + b for row, b in zip(self.w2, self.b2)]
+        return h, z
+
+    def params(self):
+        return [self.w1, self.b1, self.w2, self.b2]
+
+
+def softmax(z):
+    m = max(z)
+    e = [math.exp(v - m) for v in z]
+    s = sum(e)
+    return [v / s for v in e]
+
+
+def train(model, data, epochs, lr, rng):
+    # Adam state per parameter, flattened alongside the nested lists
+    shapes = model.params()
+    m = [[[0.0] * len(r) for r in p] if isinstance(p[0], list) else [0.0] * len(p) for p in shapes]
+    v = [[[0.0] * len(r) for r in p] if isinstance(p[0], list) else [0.0] * len(p) for p in shapes]
+    beta1, beta2, eps, step = 0.9, 0.999, 1e-8, 0
+
+    def adam(param, grad, mi, vi):
+        mi_ = beta1 * mi + (1 - beta1) * grad
+        vi_ = beta2 * vi + (1 - beta2) * grad * grad
+        mhat = mi_ / (1 - beta1 ** step)
+        vhat = vi_ / (1 - beta2 ** step)
+        return param - lr * mhat / (math.sqrt(vhat) + eps), mi_, vi_
+
+    for epoch in range(epochs):
+        rng.shuffle(data)
+        loss = 0.0
+        for x, label in data:
+            step += 1
+            h, z = model.forward(x)
+            p = softmax(z)
+            loss -= math.log(max(p[label], 1e-12))
+            dz = [pi - (1.0 if i == label else 0.0) for i, pi in enumerate(p)]
+            dh = [sum(dz[k] * model.w2[k][j] for k in range(len(dz))) if h[j] > 0 else 0.0 for j in range(len(h))]
+
+            for k in range(len(dz)):
+                for j in range(len(h)):
+                    model.w2[k][j], m[2][k][j], v[2][k][j] = adam(model.w2[k][j], dz[k] * h[j], m[2][k][j], v[2][k][j])
+                model.b2[k], m[3][k], v[3][k] = adam(model.b2[k], dz[k], m[3][k], v[3][k])
+            for j in range(len(h)):
+                if dh[j] == 0.0:
+                    continue
+                for i in range(len(x)):
+                    model.w1[j][i], m[0][j][i], v[0][j][i] = adam(model.w1[j][i], dh[j] * x[i], m[0][j][i], v[0][j][i])
+                model.b1[j], m[1][j], v[1][j] = adam(model.b1[j], dh[j], m[1][j], v[1][j])
+        sys.stderr.write("epoch %2d  loss %.4f\n" % (epoch + 1, loss / len(data)))
+
+
+# ----------------------------------------------------------------------------
+# Quantization (must match include/FlameModel.h)
+# ----------------------------------------------------------------------------
+def fixed_multiplier(real):
+    """real ~= multiplier * 2^-shift with multiplier in [2^30, 2^31)."""
+    shift = 0
+    while real * (1 << shift) < (1 << 30):
+        shift += 1
+    return int(round(real * (1 << shift))), shift
+
+
+def quantize(model, data):
+    s_x = 1.0 / (1 << INPUT_SHIFT)
+    s_w1 = max(abs(w) for row in model.w1 for w in row) / 127.0
+    s_w2 = max(abs(w) for row in model.w2 for w in row) / 127.0
+
+    # Hidden scale from the 99.9th percentile activation on the training data
+    acts = sorted(h for x, _ in data for h in model.forward([quantize_input(v) * s_x for v in x])[0])
+    s_h = max(acts[int(0.999 * (len(acts) - 1))], 1e-3) / 127.0
+
+    q = {}
+    q["w1"] = [[int(round(w / s_w1)) for w in row] for row in model.w1]
+    q["b1"] = [int(round(b / (s_w1 * s_x))) for b in model.b1]
+    q["m1"], q["shift1"] = fixed_multiplier(s_w1 * s_x / s_h)
+    q["w2"] = [[int(round(w / s_w2)) for w in row] for row in model.w2]
+    q["b2"] = [int(round(b / (s_w2 * s_h))) for b in model.b2]
+    q["out_scale"] = s_w2 * s_h
+    return q
+
+
+def infer_int8(q, features):
+    x = [quantize_input(v) for v in features]
+    hidden = []
+    for row, b in zip(q["w1"], q["b1"]):
+        acc = b + sum(w * xi for w, xi in zip(row, x))
+        h = (acc * q["m1"] + (1 << (q["shift1"] - 1))) >> q["shift1"]
+        hidden.append(max(0, min(127, h)))
+    return [(b + sum(w * h for w, h in zip(row, hidden))) * q["out_scale"] for row, b in zip(q["w2"], q["b2"])]
+
+
+def probabilities(logits):
+    return softmax(logits)
+
+
+def golden_set(q, data, per_class):
+    """The per_class least confident vectors of each true class (where a one
+    LSB slip in the integer path shows most), snapped to the int8 input grid
+    so the C++ side quantizes them to exactly the same values."""
+    def margin(logits):
+        top = sorted(logits, reverse=True)
+        return top[0] - top[1]
+
+    out = []
+    for label in range(len(CLASSES)):
+        snapped = [[quantize_input(v) / float(1 << INPUT_SHIFT) for v in x] for x, l in data if l == label]
+        snapped.sort(key=lambda x: margin(infer_int8(q, x)))
+        for x in snapped[:per_class]:
+            logits = infer_int8(q, x)
+            out.append((x, argmax(logits), probabilities(logits)))
+    return out
+
+
+def argmax(values):
+    return max(range(len(values)), key=lambda i: values[i])
+
+
+def confusion(predict, data):
+    table = [[0] * len(CLASSES) for _ in CLASSES]
+    for x, label in data:
+        table[label][argmax(predict(x))] += 1
+    correct = sum(table[i][i] for i in range(len(CLASSES)))
+    return table, correct / max(1, len(data))
+
+
+# ----------------------------------------------------------------------------
+# Export
+# ----------------------------------------------------------------------------
+def c_array(values):
+    return "{" + ", ".join(str(v) for v in values) + "}"
+
+
+def c_float(value):
+    text = "%.9g" % value
+    return text + ("f" if ("." in text or "e" in text) else ".0f")
+
+
+def c_floats(values):
+    return "{" + ", ".join(c_float(v) for v in values) + "}"
+
+
+def export(path, q, hidden, source, stats, traces, golden):
+    lines = [
+        "#ifndef FLAME_MODEL_WEIGHTS_H",
+        "#define FLAME_MODEL_WEIGHTS_H",
+        "",
+        "#include <stdint.h>",
+        "",
+        "// ============================================================================",
+        "// GENERATED by tools/train_flame_model.py - do not edit, retrain instead",
+        "// Source: %s" % source,
+    ]
+    lines += ["// %s" % s for s in stats]
+    lines += [
+        "// ============================================================================",
+        "",
+        "#define FLAME_MODEL_INPUTS          %d" % len(FEATURES),
+        "#define FLAME_MODEL_HIDDEN          %d" % hidden,
+        "#define FLAME_MODEL_CLASSES         %d" % len(CLASSES),
+        "#define FLAME_MODEL_INPUT_SHIFT     %d           // Feature x 2^shift -> int8" % INPUT_SHIFT,
+        "#define FLAME_MODEL_FROM_TRACES     %d           // 0 = synthetic data only, advisory" % (1 if traces else 0),
+        "",
+        "constexpr int8_t flameModelW1[FLAME_MODEL_HIDDEN][FLAME_MODEL_INPUTS] = {",
+    ]
+    lines += ["    %s," % c_array(row) for row in q["w1"]]
+    lines += [
+        "};",
+        "constexpr int32_t flameModelB1[FLAME_MODEL_HIDDEN] = %s;" % c_array(q["b1"]),
+        "constexpr int32_t flameModelMultiplier1 = %d;" % q["m1"],
+        "constexpr int flameModelShift1 = %d;" % q["shift1"],
+        "",
+        "constexpr int8_t flameModelW2[FLAME_MODEL_CLASSES][FLAME_MODEL_HIDDEN] = {",
+    ]
+    lines += ["    %s," % c_array(row) for row in q["w2"]]
+    lines += [
+        "};",
+        "constexpr int32_t flameModelB2[FLAME_MODEL_CLASSES] = %s;" % c_array(q["b2"]),
+        "constexpr float flameModelOutputScale = %.9gf;" % q["out_scale"],
+        "",
+        "// Golden vectors (features on the int8 grid) with the class and",
+        "// probabilities the trainer computes for them; see test/test_flame_model",
+        "#define FLAME_MODEL_GOLDEN          %d" % len(golden),
+        "",
+        "constexpr float flameModelGoldenFeatures[FLAME_MODEL_GOLDEN][FLAME_MODEL_INPUTS] = {",
+    ]
+    lines += ["    %s," % c_floats(x) for x, _, _ in golden]
+    lines += [
+        "};",
+        "constexpr uint8_t flameModelGoldenClass[FLAME_MODEL_GOLDEN] = %s;" % c_array([c for _, c, _ in golden]),
+        "constexpr float flameModelGoldenProbabilities[FLAME_MODEL_GOLDEN][FLAME_MODEL_CLASSES] = {",
+    ]
+    lines += ["    %s," % c_floats(p) for _, _, p in golden]
+    lines += [
+        "};",
+        "",
+        "#endif // FLAME_MODEL_WEIGHTS_H",
+        "",
+    ]
+    with open(path, "w", newline="\r\n") as f:
+        f.write("\n".join(lines))
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Train and export the int8 flame/nuisance classifier")
+    parser.add_argument("traces", nargs="*", metavar="CLASS=LOG", help="labelled [MLTRACE] logs (%s)" % "/".join(CLASSES))
+    parser.add_argument("--synthetic", type=int, default=0, metavar="N", help="add N generated vectors per class")
+    parser.add_argument("--hidden", type=int, default=16, help="hidden units (default 16)")
+    parser.add_argument("--epochs", type=int, default=25)
+    parser.add_argument("--lr", type=float, default=0.005)
+    parser.add_argument("--seed", type=int, default=1)
+    parser.add_argument("--holdout", type=float, default=0.2, help="share kept for validation")
+    parser.add_argument("--golden", type=int, default=2, metavar="N", help="golden vectors per class in the header (default 2)")
+    parser.add_argument("-o", "--output", help="write the weights header (include/FlameModelWeights.h)")
+    args = parser.parse_args()
+
+    rng = random.Random(args.seed)
+    data, sources = [], []
+    for item in args.traces:
+        name, _, path = item.partition("=")
+        if name not in CLASSES or not path:
+            sys.exit("train: expected CLASS=LOG with CLASS in %s, got %r" % (CLASSES, item))
+        vectors = load_trace(path)
+        data += [(v, CLASSES.index(name)) for v in vectors]
+        sources.append("%s=%s (%d)" % (name, path, len(vectors)))
+    if args.synthetic:
+        for label, name in enumerate(CLASSES):
+            data += [(v, label) for v in synthesize(name, args.synthetic, rng)]
+        sources.append("synthetic %d per class, seed %d" % (args.synthetic, args.seed))
+    if not data:
+        sys.exit("train: no data (give CLASS=LOG traces or --synthetic N)")
+
+    rng.shuffle(data)
+    split = int(len(data) * (1.0 - args.holdout))
+    training, validation = data[:split], data[split:] or data[:split]
+
+    model = Mlp(len(FEATURES), args.hidden, len(CLASSES), rng)
+    train(model, training, args.epochs, args.lr, rng)
+    q = quantize(model, training)
+
+    stats = ["%d training / %d validation vectors, %d-%d-%d MLP, %d epochs"
+             % (len(training), len(validation), len(FEATURES), args.hidden, len(CLASSES), args.epochs)]
+    _, float_acc = confusion(lambda x: model.forward(x)[1], validation)
+    table, int8_acc = confusion(lambda x: infer_int8(q, x), validation)
+    stats.append("Validation accuracy: float %.1f%%, int8 %.1f%%" % (100 * float_acc, 100 * int8_acc))
+    stats.append("int8 confusion (rows true %s):" % "/".join(CLASSES))
+    stats += ["  %-8s %s" % (CLASSES[i], " ".join("%5d" % n for n in row)) for i, row in enumerate(table)]
+    for s in stats:
+        print(s)
+
+    if args.output:
+        golden = golden_set(q, validation, args.golden)
+        export(args.output, q, args.hidden, "; ".join(sources), stats, bool(args.traces), golden)
+        print("wrote %s" % args.output)
+
+
+if __name__ == "__main__":
+    main()